@@ -0,0 +1,235 @@
+// ============================================================================
+// AnalysisJobEngine.cpp
+// ============================================================================
+#include "AnalysisJobEngine.h"
+#include "Telemetry.h"
+
+// ============================================================================
+// ExtractionJob
+// ============================================================================
+
+class AnalysisJobEngine::ExtractionJob : public juce::ThreadPoolJob {
+public:
+    ExtractionJob(AnalysisJobEngine& owner,
+        const juce::String& featureName,
+        FeatureExtractor& extractor,
+        const juce::AudioBuffer<float>* buffer,
+        StreamingAudioFile* stream,
+        double sampleRate,
+        int channel,
+        CompletionCallback onComplete,
+        CacheLookup lookup)
+        : juce::ThreadPoolJob("Extract " + featureName),
+        featureName(featureName), owner(owner), extractor(extractor),
+        buffer(buffer), stream(stream), sampleRate(sampleRate), channel(channel),
+        onComplete(std::move(onComplete)), lookup(std::move(lookup)) {
+    }
+
+    JobStatus runJob() override {
+        extractor.onProgress = [this](float fraction) {
+            progress = juce::jlimit(0.0f, 1.0f, fraction);
+            owner.updateProgress();
+            return !shouldExit();
+        };
+
+        std::vector<std::vector<std::pair<double, double>>> results;
+        const bool found = lookup && lookup(results);
+
+        if (!found && !shouldExit()) {
+            Telemetry::ScopedTimer timer(Telemetry::Category::Extraction, featureName);
+            timer.setItems(stream != nullptr ? stream->getLengthInSamples() : buffer->getNumSamples());
+
+            results = stream != nullptr
+                ? extractor.extractStreaming(*stream, channel)
+                : extractor.extract(*buffer, sampleRate, channel);
+        }
+        extractor.onProgress = nullptr;
+
+        if (!shouldExit()) {
+            if (onComplete) onComplete(featureName, std::move(results));
+            progress = 1.0f;
+        }
+
+        finished = true;
+        owner.updateProgress();
+        return jobHasFinished;
+    }
+
+    const juce::String featureName;
+    std::atomic<float> progress{ 0.0f };
+    std::atomic<bool> finished{ false };
+
+private:
+    AnalysisJobEngine& owner;
+    FeatureExtractor& extractor;
+    const juce::AudioBuffer<float>* buffer;   // Exactly one of buffer and stream is set
+    StreamingAudioFile* stream;
+    double sampleRate;
+    int channel;
+    CompletionCallback onComplete;
+    CacheLookup lookup;
+};
+
+// ============================================================================
+// AnalysisJobEngine
+// ============================================================================
+
+AnalysisJobEngine::AnalysisJobEngine(std::atomic<bool>& busyFlag, std::atomic<float>& progressValue)
+    : busy(busyFlag), progress(progressValue), pool(getSharedPool()) {
+}
+
+AnalysisJobEngine::~AnalysisJobEngine() {
+    // The jobs are freed with the engine, so a running one must be waited out
+    // however long it takes to see the interrupt
+    cancelAll(-1);
+    jassert(!isBusy());
+}
+
+bool AnalysisJobEngine::submit(const juce::String& featureName,
+    FeatureExtractor& extractor,
+    const juce::AudioBuffer<float>& buffer,
+    double sampleRate,
+    int channel,
+    CompletionCallback onComplete,
+    CacheLookup lookup) {
+
+    if (isRunning(featureName)) return false;
+
+    addJob(std::make_unique<ExtractionJob>(*this, featureName, extractor,
+        &buffer, nullptr, sampleRate, channel, std::move(onComplete), std::move(lookup)));
+    return true;
+}
+
+bool AnalysisJobEngine::submit(const juce::String& featureName,
+    FeatureExtractor& extractor,
+    StreamingAudioFile& stream,
+    int channel,
+    CompletionCallback onComplete,
+    CacheLookup lookup) {
+
+    if (isRunning(featureName)) return false;
+
+    addJob(std::make_unique<ExtractionJob>(*this, featureName, extractor,
+        nullptr, &stream, stream.getSampleRate(), channel, std::move(onComplete), std::move(lookup)));
+    return true;
+}
+
+void AnalysisJobEngine::addJob(std::unique_ptr<ExtractionJob> job) {
+    // Start a fresh batch so progress is averaged over the jobs that belong together
+    if (!isBusy())
+        pruneFinishedJobs();
+
+    auto* jobPtr = job.get();
+
+    {
+        const juce::ScopedLock sl(jobLock);
+        jobs.push_back(std::move(job));
+    }
+
+    busy = true;
+    updateProgress();
+    pool.addJob(jobPtr, false);
+}
+
+void AnalysisJobEngine::cancel(const juce::String& featureName, int timeoutMs) {
+    std::vector<ExtractionJob*> toCancel;
+    {
+        const juce::ScopedLock sl(jobLock);
+        for (auto& job : jobs) {
+            if (job->featureName == featureName && !job->finished)
+                toCancel.push_back(job.get());
+        }
+    }
+
+    // Never wait while holding jobLock - running jobs take it to report progress
+    for (auto* job : toCancel)
+        pool.removeJob(job, true, timeoutMs);
+
+    pruneFinishedJobs();
+    updateProgress();
+}
+
+void AnalysisJobEngine::cancelAll(int timeoutMs) {
+    std::vector<ExtractionJob*> toCancel;
+    {
+        const juce::ScopedLock sl(jobLock);
+        for (auto& job : jobs)
+            toCancel.push_back(job.get());
+    }
+
+    // Only this engine's jobs; other engines share the pool
+    for (auto* job : toCancel)
+        pool.removeJob(job, true, timeoutMs);
+
+    pruneFinishedJobs();
+    updateProgress();
+}
+
+bool AnalysisJobEngine::waitForAll(int timeoutMs) {
+    std::vector<ExtractionJob*> pending;
+    {
+        const juce::ScopedLock sl(jobLock);
+        for (auto& job : jobs)
+            pending.push_back(job.get());
+    }
+
+    for (auto* job : pending) {
+        if (!pool.waitForJobToFinish(job, timeoutMs))
+            return false;
+    }
+    return true;
+}
+
+bool AnalysisJobEngine::isBusy() const {
+    const juce::ScopedLock sl(jobLock);
+    for (const auto& job : jobs) {
+        if (pool.contains(job.get()))
+            return true;
+    }
+    return false;
+}
+
+bool AnalysisJobEngine::isRunning(const juce::String& featureName) const {
+    const juce::ScopedLock sl(jobLock);
+    for (const auto& job : jobs) {
+        if (job->featureName == featureName && pool.contains(job.get()))
+            return true;
+    }
+    return false;
+}
+
+void AnalysisJobEngine::updateProgress() {
+    const juce::ScopedLock sl(jobLock);
+
+    if (jobs.empty()) {
+        busy = false;
+        return;
+    }
+
+    float total = 0.0f;
+    bool anyRunning = false;
+
+    for (const auto& job : jobs) {
+        total += job->progress.load();
+        anyRunning = anyRunning || !job->finished;
+    }
+
+    progress = total / static_cast<float>(jobs.size());
+    busy = anyRunning;
+}
+
+juce::ThreadPool& AnalysisJobEngine::getSharedPool() {
+    static juce::ThreadPool sharedPool(juce::jmax(1, juce::SystemStats::getNumCpus()));
+    return sharedPool;
+}
+
+void AnalysisJobEngine::pruneFinishedJobs() {
+    const juce::ScopedLock sl(jobLock);
+
+    // A job is only released once the pool has let go of it
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+        [this](const std::unique_ptr<ExtractionJob>& job) {
+            return !pool.contains(job.get());
+        }),
+        jobs.end());
+}
@@ -0,0 +1,82 @@
+// ============================================================================
+// AnalysisJobEngine.h
+// Runs feature extractors on a thread pool, one extractor per worker
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "FeatureExtractors.h"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+
+class AnalysisJobEngine {
+public:
+    using Results = std::vector<std::vector<std::pair<double, double>>>;
+
+    // Called on the worker thread once a job has finished without being cancelled
+    using CompletionCallback = std::function<void(const juce::String& featureName, Results&& results)>;
+
+    // Called on the worker thread before extracting; filling results and returning
+    // true skips the extraction, so slow lookups stay off the submitting thread
+    using CacheLookup = std::function<bool(Results& results)>;
+
+    // The busy flag and progress value are written by the engine as jobs advance
+    AnalysisJobEngine(std::atomic<bool>& busyFlag, std::atomic<float>& progressValue);
+    ~AnalysisJobEngine();
+
+    // ========================================================================
+    // Job Control
+    // ========================================================================
+
+    // The extractor and buffer must stay alive until the job finishes or is cancelled
+    bool submit(const juce::String& featureName,
+        FeatureExtractor& extractor,
+        const juce::AudioBuffer<float>& buffer,
+        double sampleRate,
+        int channel,
+        CompletionCallback onComplete,
+        CacheLookup lookup = nullptr);
+
+    // Streams the file through the extractor instead; the file must likewise outlive the job
+    bool submit(const juce::String& featureName,
+        FeatureExtractor& extractor,
+        StreamingAudioFile& stream,
+        int channel,
+        CompletionCallback onComplete,
+        CacheLookup lookup = nullptr);
+
+    // A job still running after the timeout is kept until the pool lets go of it
+    // (-1 waits for it)
+    void cancel(const juce::String& featureName, int timeoutMs = 5000);
+    void cancelAll(int timeoutMs = 5000);
+    bool waitForAll(int timeoutMs = -1);
+
+    // ========================================================================
+    // Status
+    // ========================================================================
+
+    bool isBusy() const;
+    bool isRunning(const juce::String& featureName) const;
+    float getProgress() const { return progress.load(); }
+
+    // One worker per core, shared by every engine in the process so the
+    // workers and their scratch pools outlive any one processor
+    static juce::ThreadPool& getSharedPool();
+
+private:
+    class ExtractionJob;
+
+    std::atomic<bool>& busy;
+    std::atomic<float>& progress;
+
+    juce::ThreadPool& pool;
+    juce::CriticalSection jobLock;
+    std::vector<std::unique_ptr<ExtractionJob>> jobs;
+
+    void addJob(std::unique_ptr<ExtractionJob> job);
+    void updateProgress();
+    void pruneFinishedJobs();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisJobEngine)
+};
@@ -3,7 +3,14 @@
 // Implementation of universal time-grid system
 // ============================================================================
 #include "AudioTimeLattice.h"
+#include "SIMDKernels.h"
+#include "ParallelFor.h"
+#include "BreakpointSimplifier.h"
+#include "ScratchPool.h"
+#include "Telemetry.h"
 #include <cmath>
+#include <limits>
+#include <cstring>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
@@ -28,14 +35,218 @@ MusicalTime MusicalTime::fromString(const std::string& str) {
     return mt;
 }
 
+// ============================================================================
+// TempoMap Implementation
+// ============================================================================
+
+TempoMap::TempoMap() {
+    compile({}, 960);
+}
+
+double TempoMap::secondsPerQuarter(const TempoEvent& event) {
+    return 60.0 / juce::jmax(1.0e-6, event.bpm);
+}
+
+void TempoMap::compile(const std::vector<TempoEvent>& events, int ppqn) {
+    segments.clear();
+
+    std::vector<TempoEvent> source = events;
+    if (source.empty()) source.push_back({ 0.0, 120.0, 4, 4 });
+
+    segments.reserve(source.size());
+
+    for (const auto& event : source) {
+        Segment segment;
+        segment.event = event;
+        segment.startSeconds = event.timeInSeconds;
+        segment.secondsPerTick = secondsPerQuarter(event) / juce::jmax(1, ppqn);
+        segment.secondsPerBeat = secondsPerQuarter(event) * 4.0 / juce::jmax(1, event.lowerTimeSig);
+        segment.beatsPerBar = juce::jmax(1, event.upperTimeSig);
+
+        if (segments.empty()) {
+            // The first tempo also runs back to time zero and before
+            segment.startTicks = segment.startSeconds / segment.secondsPerTick;
+            segment.startBeats = segment.startSeconds / segment.secondsPerBeat;
+            segment.startBars = segment.startBeats / segment.beatsPerBar;
+        }
+        else {
+            const Segment& previous = segments.back();
+            double elapsed = segment.startSeconds - previous.startSeconds;
+            double elapsedBeats = elapsed / previous.secondsPerBeat;
+
+            segment.startTicks = previous.startTicks + elapsed / previous.secondsPerTick;
+            segment.startBeats = previous.startBeats + elapsedBeats;
+            segment.startBars = previous.startBars + elapsedBeats / previous.beatsPerBar;
+        }
+
+        segments.push_back(segment);
+    }
+}
+
+namespace {
+    // Last segment whose start is at or before value; the first segment extends backwards
+    size_t findSegmentBy(const std::vector<TempoMap::Segment>& segments, double value,
+        double TempoMap::Segment::* start) {
+
+        auto it = std::upper_bound(segments.begin() + 1, segments.end(), value,
+            [start](double v, const TempoMap::Segment& segment) { return v < segment.*start; });
+
+        return static_cast<size_t>(std::distance(segments.begin(), it)) - 1;
+    }
+}
+
+size_t TempoMap::findSegmentAtSeconds(double seconds) const {
+    return findSegmentBy(segments, seconds, &Segment::startSeconds);
+}
+
+size_t TempoMap::findSegmentAtTicks(double ticks) const {
+    return findSegmentBy(segments, ticks, &Segment::startTicks);
+}
+
+size_t TempoMap::findSegmentAtBeats(double beats) const {
+    return findSegmentBy(segments, beats, &Segment::startBeats);
+}
+
+size_t TempoMap::findSegmentAtBars(double bars) const {
+    return findSegmentBy(segments, bars, &Segment::startBars);
+}
+
+double TempoMap::secondsToTicks(double seconds) const {
+    const Segment& segment = segments[findSegmentAtSeconds(seconds)];
+    return segment.startTicks + (seconds - segment.startSeconds) / segment.secondsPerTick;
+}
+
+double TempoMap::ticksToSeconds(double ticks) const {
+    const Segment& segment = segments[findSegmentAtTicks(ticks)];
+    return segment.startSeconds + (ticks - segment.startTicks) * segment.secondsPerTick;
+}
+
+double TempoMap::secondsToBeats(double seconds) const {
+    const Segment& segment = segments[findSegmentAtSeconds(seconds)];
+    return segment.startBeats + (seconds - segment.startSeconds) / segment.secondsPerBeat;
+}
+
+double TempoMap::beatsToSeconds(double beats) const {
+    const Segment& segment = segments[findSegmentAtBeats(beats)];
+    return segment.startSeconds + (beats - segment.startBeats) * segment.secondsPerBeat;
+}
+
+double TempoMap::secondsToBars(double seconds) const {
+    const Segment& segment = segments[findSegmentAtSeconds(seconds)];
+    return segment.startBars + (seconds - segment.startSeconds) / (segment.secondsPerBeat * segment.beatsPerBar);
+}
+
+double TempoMap::barsToSeconds(double bars) const {
+    const Segment& segment = segments[findSegmentAtBars(bars)];
+    return segment.startSeconds + (bars - segment.startBars) * segment.secondsPerBeat * segment.beatsPerBar;
+}
+
+double TempoMap::Segment::* TempoMap::getPositionMember(GridUnit unit) {
+    switch (unit) {
+    case GridUnit::Beats: return &Segment::startBeats;
+    case GridUnit::Bars:  return &Segment::startBars;
+    default:              return &Segment::startTicks;
+    }
+}
+
+double TempoMap::getUnitSeconds(const Segment& segment, GridUnit unit) {
+    switch (unit) {
+    case GridUnit::Beats: return segment.secondsPerBeat;
+    case GridUnit::Bars:  return segment.secondsPerBeat * segment.beatsPerBar;
+    default:              return segment.secondsPerTick;
+    }
+}
+
+double TempoMap::secondsToPosition(double seconds, GridUnit unit) const {
+    const Segment& segment = segments[findSegmentAtSeconds(seconds)];
+    return segment.*getPositionMember(unit) + (seconds - segment.startSeconds) / getUnitSeconds(segment, unit);
+}
+
+double TempoMap::positionToSeconds(double position, GridUnit unit, size_t& segmentHint) const {
+    auto member = getPositionMember(unit);
+    segmentHint = advanceSegment(juce::jmin(segmentHint, segments.size() - 1), position, member);
+
+    const Segment& segment = segments[segmentHint];
+    return segment.startSeconds + (position - segment.*member) * getUnitSeconds(segment, unit);
+}
+
+size_t TempoMap::advanceSegment(size_t segment, double value, double Segment::* start) const {
+    if (segment > 0 && value < segments[segment].*start)
+        return findSegmentBy(segments, value, start);
+
+    while (segment + 1 < segments.size() && segments[segment + 1].*start <= value)
+        ++segment;
+
+    return segment;
+}
+
+void TempoMap::secondsToTicks(const double* seconds, double* ticks, int numValues) const {
+    Cursor cursor(*this);
+
+    for (int i = 0; i < numValues; ++i)
+        ticks[i] = cursor.secondsToTicks(seconds[i]);
+}
+
+void TempoMap::ticksToSeconds(const double* ticks, double* seconds, int numValues) const {
+    Cursor cursor(*this);
+
+    for (int i = 0; i < numValues; ++i)
+        seconds[i] = cursor.ticksToSeconds(ticks[i]);
+}
+
+double TempoMap::Cursor::secondsToTicks(double seconds) {
+    secondsSegment = map.advanceSegment(secondsSegment, seconds, &Segment::startSeconds);
+
+    const Segment& segment = map.segments[secondsSegment];
+    return segment.startTicks + (seconds - segment.startSeconds) / segment.secondsPerTick;
+}
+
+double TempoMap::Cursor::ticksToSeconds(double ticks) {
+    ticksSegment = map.advanceSegment(ticksSegment, ticks, &Segment::startTicks);
+
+    const Segment& segment = map.segments[ticksSegment];
+    return segment.startSeconds + (ticks - segment.startTicks) * segment.secondsPerTick;
+}
+
+// ============================================================================
+// GridRange Implementation
+// ============================================================================
+
+GridRange::GridRange(const TempoMap& map, GridUnit unit, double startSeconds, double endSeconds, int stride)
+    : map(map), unit(unit), stride(juce::jmax(1, stride)) {
+
+    if (endSeconds < startSeconds) return;
+
+    // Whole multiples of the stride inside the range, with a little slack for rounding
+    double first = std::ceil(map.secondsToPosition(startSeconds, unit) / this->stride - 1.0e-9);
+    double last = std::floor(map.secondsToPosition(endSeconds, unit) / this->stride + 1.0e-9);
+
+    firstPosition = first * this->stride;
+    endPosition = juce::jmax(first, last + 1.0) * this->stride;
+}
+
+GridRange::Iterator::Iterator(const GridRange& range, double position)
+    : range(&range), position(position) {
+    if (position < range.endPosition)
+        seconds = range.map.positionToSeconds(position, range.unit, segment);
+}
+
+GridRange::Iterator& GridRange::Iterator::operator++() {
+    position += range->stride;
+    if (position < range->endPosition)
+        seconds = range->map.positionToSeconds(position, range->unit, segment);
+    return *this;
+}
+
 // ============================================================================
 // AudioTimeLattice Constructor
 // ============================================================================
 
 AudioTimeLattice::AudioTimeLattice(int ppqn, double sampleRate)
-    : ppqn(ppqn), sampleRate(sampleRate) {
+    : ppqn(ppqn), sampleRate(sampleRate), stretcher(sampleRate) {
     // Add default tempo
     tempoMap.push_back({ 0.0, 120.0, 4, 4 });
+    compileTempoMap();
 }
 
 // ============================================================================
@@ -44,15 +255,18 @@ AudioTimeLattice::AudioTimeLattice(int ppqn, double sampleRate)
 
 void AudioTimeLattice::setPPQN(int newPPQN) {
     ppqn = juce::jmax(24, newPPQN); // Minimum 24 PPQN
+    compileTempoMap();
 }
 
 void AudioTimeLattice::setSampleRate(double rate) {
     sampleRate = juce::jmax(1.0, rate);
+    stretcher.setSampleRate(sampleRate);
 }
 
 void AudioTimeLattice::setTempo(double bpm, double timeInSeconds) {
     clearTempoMap();
     tempoMap.push_back({ timeInSeconds, bpm, 4, 4 });
+    compileTempoMap();
 }
 
 void AudioTimeLattice::addTempoChange(const TempoEvent& tempo) {
@@ -61,10 +275,16 @@ void AudioTimeLattice::addTempoChange(const TempoEvent& tempo) {
         [](const TempoEvent& a, const TempoEvent& b) {
             return a.timeInSeconds < b.timeInSeconds;
         });
+    compileTempoMap();
 }
 
 void AudioTimeLattice::clearTempoMap() {
     tempoMap.clear();
+    compileTempoMap();
+}
+
+void AudioTimeLattice::compileTempoMap() {
+    compiledTempo.compile(tempoMap, ppqn);
 }
 
 // ============================================================================
@@ -84,12 +304,8 @@ double AudioTimeLattice::toSeconds(double value, TimeDomain domain) {
     case TimeDomain::Seconds:
         return value;
 
-    case TimeDomain::MusicalTicks: {
-        TempoEvent tempo = getCurrentTempo(0);
-        double beatLength = 60.0 / tempo.bpm;
-        double tickLength = beatLength / ppqn;
-        return value * tickLength;
-    }
+    case TimeDomain::MusicalTicks:
+        return compiledTempo.ticksToSeconds(value);
 
     case TimeDomain::BarsBeatsTicks: {
         int encoded = static_cast<int>(value);
@@ -114,11 +330,8 @@ double AudioTimeLattice::fromSeconds(double seconds, TimeDomain domain) {
     case TimeDomain::Seconds:
         return seconds;
 
-    case TimeDomain::MusicalTicks: {
-        TempoEvent tempo = getCurrentTempo(seconds);
-        double beatLength = 60.0 / tempo.bpm;
-        return seconds / (beatLength / ppqn);
-    }
+    case TimeDomain::MusicalTicks:
+        return compiledTempo.secondsToTicks(seconds);
 
     case TimeDomain::BarsBeatsTicks: {
         MusicalTime mt = secondsToMusical(seconds);
@@ -131,41 +344,66 @@ double AudioTimeLattice::fromSeconds(double seconds, TimeDomain domain) {
     return 0.0;
 }
 
-MusicalTime AudioTimeLattice::secondsToMusical(double seconds) {
-    TempoEvent tempo = getCurrentTempo(seconds);
+void AudioTimeLattice::convert(const double* values, double* results, int numValues,
+    TimeDomain from, TimeDomain to) {
+
+    // Ticks go through the tempo map's forward walk; everything else is per value
+    if (from == TimeDomain::MusicalTicks)
+        compiledTempo.ticksToSeconds(values, results, numValues);
+    else if (results != values || from != TimeDomain::Seconds)
+        for (int i = 0; i < numValues; ++i)
+            results[i] = toSeconds(values[i], from);
+
+    if (to == TimeDomain::MusicalTicks)
+        compiledTempo.secondsToTicks(results, results, numValues);
+    else if (to != TimeDomain::Seconds)
+        for (int i = 0; i < numValues; ++i)
+            results[i] = fromSeconds(results[i], to);
+}
+
+void AudioTimeLattice::convertBreakpointTimes(std::vector<std::pair<double, double>>& breakpoints,
+    TimeDomain from, TimeDomain to) {
+
+    auto times = ScratchPool::borrow<double>(breakpoints.size());
+    for (size_t i = 0; i < breakpoints.size(); ++i)
+        times[i] = breakpoints[i].first;
 
-    double quarterLength = 60.0 / tempo.bpm;
-    double beatLength = quarterLength * 4.0 / tempo.lowerTimeSig;
-    double barLength = tempo.upperTimeSig * beatLength;
+    convert(times.data(), times.data(), static_cast<int>(times.size()), from, to);
+
+    for (size_t i = 0; i < breakpoints.size(); ++i)
+        breakpoints[i].first = times[i];
+}
+
+MusicalTime AudioTimeLattice::secondsToMusical(double seconds) {
+    const TempoMap::Segment& segment = compiledTempo.getSegmentAtSeconds(seconds);
 
     // Add epsilon for floating-point precision
-    const double eps = 1.0 + std::max(1.0, seconds) *
+    const double eps = 1.0 + std::max(1.0, std::abs(seconds)) *
         std::numeric_limits<double>::epsilon();
 
-    int bars = static_cast<int>(std::floor(seconds * eps / barLength));
-    seconds -= bars * barLength;
+    double beatsIntoSegment = (seconds - segment.startSeconds) / segment.secondsPerBeat;
+    double totalBars = segment.startBars + beatsIntoSegment / segment.beatsPerBar;
 
-    int beats = static_cast<int>(std::floor(seconds * eps / beatLength));
-    seconds -= beats * beatLength;
+    int bars = static_cast<int>(std::floor(totalBars * eps));
+    double beatsIntoBar = juce::jmax(0.0, (totalBars - bars) * segment.beatsPerBar);
 
-    double ticksFractional = seconds * (ppqn / beatLength);
-    int ticks = static_cast<int>(ticksFractional);
-    double remainder = ticksFractional - ticks;
+    int beats = static_cast<int>(std::floor(beatsIntoBar * eps));
+    double ticksFractional = juce::jmax(0.0, (beatsIntoBar - beats) * ppqn);
+    int ticks = juce::jmin(ppqn - 1, static_cast<int>(std::floor(ticksFractional + 1.0e-6)));
+    double remainder = juce::jmax(0.0, ticksFractional - ticks);
 
     return { bars + 1, beats + 1, ticks, remainder };
 }
 
 double AudioTimeLattice::musicalToSeconds(const MusicalTime& mt) {
-    TempoEvent tempo = getCurrentTempo(0);
-
-    double quarterLength = 60.0 / tempo.bpm;
-    double beatLength = quarterLength * 4.0 / tempo.lowerTimeSig;
+    const TempoMap& map = compiledTempo;
+    const TempoMap::Segment& segment = map.getSegment(map.findSegmentAtBars(mt.bars - 1));
 
-    double totalBeats = (mt.bars - 1) * tempo.upperTimeSig +
+    double beatsFromSegment = ((mt.bars - 1) - segment.startBars) * segment.beatsPerBar +
         (mt.beats - 1) +
         (mt.ticks + mt.remainder) / static_cast<double>(ppqn);
 
-    return totalBeats * beatLength;
+    return segment.startSeconds + beatsFromSegment * segment.secondsPerBeat;
 }
 
 int AudioTimeLattice::secondsToSamples(double seconds) {
@@ -176,35 +414,25 @@ double AudioTimeLattice::samplesToSeconds(int samples) {
     return samples / sampleRate;
 }
 
+juce::int64 AudioTimeLattice::secondsToTimelineSamples(double seconds) const {
+    return static_cast<juce::int64>(std::floor(seconds * sampleRate + 0.5));
+}
+
 // ============================================================================
 // Grid Generation
 // ============================================================================
 
 std::vector<double> AudioTimeLattice::generatePPQNGrid(double startSeconds, double endSeconds) {
-    std::vector<double> grid;
-
-    TempoEvent tempo = getCurrentTempo(startSeconds);
-    double beatLength = 60.0 / tempo.bpm;
-    double tickLength = beatLength / ppqn;
-
-    int startTick = static_cast<int>(startSeconds / tickLength);
-    int endTick = static_cast<int>(endSeconds / tickLength);
-
-    for (int tick = startTick; tick <= endTick; ++tick) {
-        double time = tick * tickLength;
-        if (time >= startSeconds && time <= endSeconds) {
-            grid.push_back(time);
-        }
-    }
-
-    return grid;
+    auto range = getGrid(GridUnit::Ticks, startSeconds, endSeconds);
+    return std::vector<double>(range.begin(), range.end());
 }
 
 std::vector<MusicalTime> AudioTimeLattice::generateMusicalGrid(double startSeconds, double endSeconds) {
     std::vector<MusicalTime> grid;
-    auto timeGrid = generatePPQNGrid(startSeconds, endSeconds);
+    auto range = getGrid(GridUnit::Ticks, startSeconds, endSeconds);
+    grid.reserve(range.size());
 
-    for (double time : timeGrid) {
+    for (double time : range) {
         grid.push_back(secondsToMusical(time));
     }
 
@@ -212,113 +440,88 @@ std::vector<MusicalTime> AudioTimeLattice::generateMusicalGrid(double startSecon
 }
 
 std::vector<double> AudioTimeLattice::generateBeatGrid(double startSeconds, double endSeconds) {
-    std::vector<double> grid;
-
-    TempoEvent tempo = getCurrentTempo(startSeconds);
-    double beatLength = 60.0 / tempo.bpm;
-
-    int startBeat = static_cast<int>(startSeconds / beatLength);
-    int endBeat = static_cast<int>(endSeconds / beatLength);
+    auto range = getGrid(GridUnit::Beats, startSeconds, endSeconds);
+    return std::vector<double>(range.begin(), range.end());
+}
 
-    for (int beat = startBeat; beat <= endBeat; ++beat) {
-        double time = beat * beatLength;
-        if (time >= startSeconds && time <= endSeconds) {
-            grid.push_back(time);
-        }
-    }
+std::vector<double> AudioTimeLattice::generateBarGrid(double startSeconds, double endSeconds) {
+    auto range = getGrid(GridUnit::Bars, startSeconds, endSeconds);
+    return std::vector<double>(range.begin(), range.end());
+}
 
-    return grid;
+GridRange AudioTimeLattice::getGrid(GridUnit unit, double startSeconds, double endSeconds, int stride) const {
+    return GridRange(compiledTempo, unit, startSeconds, endSeconds, stride);
 }
 
-std::vector<double> AudioTimeLattice::generateBarGrid(double startSeconds, double endSeconds) {
-    std::vector<double> grid;
+GridRange AudioTimeLattice::getGridForZoom(GridUnit unit, double startSeconds, double endSeconds,
+    double minSpacingSeconds) const {
 
-    TempoEvent tempo = getCurrentTempo(startSeconds);
-    double beatLength = 60.0 / tempo.bpm;
-    double barLength = tempo.upperTimeSig * beatLength;
+    // The fastest tempo in range sets the tightest spacing
+    double shortestUnit = std::numeric_limits<double>::max();
+    size_t first = compiledTempo.findSegmentAtSeconds(startSeconds);
+    size_t last = compiledTempo.findSegmentAtSeconds(endSeconds);
 
-    int startBar = static_cast<int>(startSeconds / barLength);
-    int endBar = static_cast<int>(endSeconds / barLength);
+    for (size_t i = first; i <= last; ++i)
+        shortestUnit = juce::jmin(shortestUnit, TempoMap::getUnitSeconds(compiledTempo.getSegment(i), unit));
 
-    for (int bar = startBar; bar <= endBar; ++bar) {
-        double time = bar * barLength;
-        if (time >= startSeconds && time <= endSeconds) {
-            grid.push_back(time);
-        }
-    }
+    int stride = 1;
+    while (stride < (1 << 24) && stride * shortestUnit < minSpacingSeconds)
+        stride *= 2;
 
-    return grid;
+    return GridRange(compiledTempo, unit, startSeconds, endSeconds, stride);
 }
 
 // ============================================================================
 // Quantization
 // ============================================================================
 
-double AudioTimeLattice::quantizeToGrid(double timeInSeconds, QuantizeMode mode) {
-    auto grid = generatePPQNGrid(timeInSeconds - 1.0, timeInSeconds + 1.0);
-    if (grid.empty()) return timeInSeconds;
-
-    // Find nearest grid point
-    double nearestTime = grid[0];
-    double minDist = std::abs(timeInSeconds - nearestTime);
-
-    for (double gridTime : grid) {
-        double dist = std::abs(timeInSeconds - gridTime);
-        if (dist < minDist) {
-            minDist = dist;
-            nearestTime = gridTime;
+namespace {
+    double roundForMode(double position, QuantizeMode mode) {
+        switch (mode) {
+        case QuantizeMode::Floor: return std::floor(position + 1.0e-9);
+        case QuantizeMode::Ceil:  return std::ceil(position - 1.0e-9);
+        default:                  return std::round(position);
         }
     }
-
-    switch (mode) {
-    case QuantizeMode::Nearest:
-        return nearestTime;
-    case QuantizeMode::Floor:
-        return (nearestTime <= timeInSeconds) ? nearestTime :
-            (grid.size() > 1 ? grid[grid.size() - 2] : nearestTime);
-    case QuantizeMode::Ceil:
-        return (nearestTime >= timeInSeconds) ? nearestTime :
-            (grid.size() > 1 ? grid[1] : nearestTime);
-    }
-
-    return nearestTime;
 }
 
-double AudioTimeLattice::quantizeToBeat(double timeInSeconds, QuantizeMode mode) {
-    TempoEvent tempo = getCurrentTempo(timeInSeconds);
-    double beatLength = 60.0 / tempo.bpm;
+namespace {
+    // Snaps to the ticks either side, comparing in seconds so a tempo change
+    // inside a tick still picks the nearer line
+    double quantizeWithCursor(TempoMap::Cursor& cursor, double timeInSeconds, QuantizeMode mode) {
+        double ticks = cursor.secondsToTicks(timeInSeconds);
 
-    int beatNum = static_cast<int>(std::round(timeInSeconds / beatLength));
+        if (mode != QuantizeMode::Nearest)
+            return cursor.ticksToSeconds(roundForMode(ticks, mode));
 
-    switch (mode) {
-    case QuantizeMode::Nearest:
-        return beatNum * beatLength;
-    case QuantizeMode::Floor:
-        return std::floor(timeInSeconds / beatLength) * beatLength;
-    case QuantizeMode::Ceil:
-        return std::ceil(timeInSeconds / beatLength) * beatLength;
+        double lower = cursor.ticksToSeconds(std::floor(ticks));
+        double upper = cursor.ticksToSeconds(std::ceil(ticks));
+        return (timeInSeconds - lower) <= (upper - timeInSeconds) ? lower : upper;
     }
+}
 
-    return beatNum * beatLength;
+double AudioTimeLattice::quantizeToGrid(double timeInSeconds, QuantizeMode mode) {
+    TempoMap::Cursor cursor(compiledTempo);
+    return quantizeWithCursor(cursor, timeInSeconds, mode);
 }
 
-double AudioTimeLattice::quantizeToBar(double timeInSeconds, QuantizeMode mode) {
-    TempoEvent tempo = getCurrentTempo(timeInSeconds);
-    double beatLength = 60.0 / tempo.bpm;
-    double barLength = tempo.upperTimeSig * beatLength;
+void AudioTimeLattice::quantizeToGrid(const double* times, double* results, int numValues,
+    QuantizeMode mode) {
 
-    int barNum = static_cast<int>(std::round(timeInSeconds / barLength));
+    TempoMap::Cursor cursor(compiledTempo);
 
-    switch (mode) {
-    case QuantizeMode::Nearest:
-        return barNum * barLength;
-    case QuantizeMode::Floor:
-        return std::floor(timeInSeconds / barLength) * barLength;
-    case QuantizeMode::Ceil:
-        return std::ceil(timeInSeconds / barLength) * barLength;
-    }
+    for (int i = 0; i < numValues; ++i)
+        results[i] = quantizeWithCursor(cursor, times[i], mode);
+}
 
-    return barNum * barLength;
+double AudioTimeLattice::quantizeToBeat(double timeInSeconds, QuantizeMode mode) {
+    double beat = roundForMode(compiledTempo.secondsToBeats(timeInSeconds), mode);
+    return compiledTempo.beatsToSeconds(beat);
+}
+
+double AudioTimeLattice::quantizeToBar(double timeInSeconds, QuantizeMode mode) {
+    double bar = roundForMode(compiledTempo.secondsToBars(timeInSeconds), mode);
+    return compiledTempo.barsToSeconds(bar);
 }
 
 double AudioTimeLattice::quantizeValue(double value, ValueResolution resolution) {
@@ -337,30 +540,28 @@ std::vector<std::pair<double, double>> AudioTimeLattice::quantizeBreakpoints(
     ValueResolution resolution,
     bool simplify) {
 
+    Telemetry::ScopedTimer timer(Telemetry::Category::Quantization, "Quantize breakpoints");
+    timer.setItems(static_cast<juce::int64>(input.size()));
+
     std::vector<std::pair<double, double>> result;
     if (input.empty()) return result;
 
-    double lastTime = -1.0;
-    double lastValue = 0.0;
-    double threshold = calculatePerceptualThreshold(resolution);
+    // Breakpoints are sorted, so one forward pass quantizes every time
+    auto times = ScratchPool::borrow<double>(input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        times[i] = input[i].first;
 
-    for (const auto& [time, value] : input) {
-        double qTime = quantizeToGrid(time);
-        double qValue = quantizeValue(value, resolution);
+    quantizeToGrid(times.data(), times.data(), static_cast<int>(times.size()));
+    result.reserve(input.size());
 
-        // Skip if too close to previous point
-        if (simplify && !result.empty()) {
-            double timeDiff = std::abs(qTime - lastTime);
-            double valueDiff = std::abs(qValue - lastValue);
+    for (size_t i = 0; i < input.size(); ++i)
+        result.push_back({ times[i], quantizeValue(input[i].second, resolution) });
 
-            if (timeDiff < getTickDuration() * 0.5 && valueDiff < threshold) {
-                continue;
-            }
-        }
-
-        result.push_back({ qTime, qValue });
-        lastTime = qTime;
-        lastValue = qValue;
+    // Anything within the resolution's threshold of the simplified curve is inaudible
+    if (simplify) {
+        double tolerance = BreakpointSimplifier::getTolerance(result,
+            calculatePerceptualThreshold(resolution));
+        result = BreakpointSimplifier::simplify(result, tolerance);
     }
 
     return result;
@@ -482,108 +683,232 @@ juce::AudioBuffer<float> AudioTimeLattice::nudge(const juce::AudioBuffer<float>&
     return output;
 }
 
+EditList AudioTimeLattice::trim(const EditList& input, double startTime, double endTime) {
+    EditList output = input;
+    output.trim(secondsToTimelineSamples(startTime), secondsToTimelineSamples(endTime));
+    return output;
+}
+
+EditList AudioTimeLattice::cut(const EditList& input, double startTime, double endTime) {
+    EditList output = input;
+    output.cut(secondsToTimelineSamples(startTime), secondsToTimelineSamples(endTime));
+    return output;
+}
+
+std::vector<EditList> AudioTimeLattice::split(const EditList& input,
+    const std::vector<double>& splitTimes) {
+
+    std::vector<juce::int64> splitPoints;
+    splitPoints.reserve(splitTimes.size());
+    for (double time : splitTimes)
+        splitPoints.push_back(secondsToTimelineSamples(time));
+
+    return input.split(splitPoints);
+}
+
+EditList AudioTimeLattice::merge(const std::vector<EditList>& clips,
+    const std::vector<double>& positions) {
+
+    std::vector<juce::int64> offsets;
+    offsets.reserve(positions.size());
+    for (double position : positions)
+        offsets.push_back(secondsToTimelineSamples(position));
+
+    EditList output;
+    EditList::merge(clips, offsets, output);
+    return output;
+}
+
+EditList AudioTimeLattice::nudge(const EditList& input, double nudgeAmount) {
+    EditList output = input;
+    output.nudge(secondsToTimelineSamples(nudgeAmount));
+    return output;
+}
+
 juce::AudioBuffer<float> AudioTimeLattice::timeStretch(const juce::AudioBuffer<float>& input,
     double stretchFactor) {
-    // Simple time stretching using linear interpolation
-    // For production use, consider juce::TimeStretcher or rubberband library
+    // WSOLA keeps the pitch, unlike resampling
+    juce::AudioBuffer<float> output;
+    stretcher.stretch(input, stretchFactor, output);
+    return output;
+}
 
-    int outputLength = static_cast<int>(input.getNumSamples() * stretchFactor);
-    juce::AudioBuffer<float> output(input.getNumChannels(), outputLength);
+namespace {
+    // Slices start on zero crossings near each transient and are crossfaded over
+    // a couple of milliseconds, short enough not to soften the attacks
+    constexpr double zeroCrossingSearchSeconds = 0.005;
+    constexpr double sliceFadeSeconds = 0.002;
 
-    for (int ch = 0; ch < input.getNumChannels(); ++ch) {
-        const float* inputData = input.getReadPointer(ch);
-        float* outputData = output.getWritePointer(ch);
+    // Onsets closer than this belong to the same hit
+    constexpr double minSliceSeconds = 0.03;
 
-        for (int i = 0; i < outputLength; ++i) {
-            double srcPos = i / stretchFactor;
-            int srcIndex = static_cast<int>(srcPos);
-            double frac = srcPos - srcIndex;
+    // Copies input[sourceStart, sourceStart + numSamples) to dest at destStart,
+    // with silence wherever the range falls outside [sliceStart, sliceEnd)
+    void copyShifted(juce::AudioBuffer<float>& dest, int destStart,
+        const juce::AudioBuffer<float>& input, int sliceStart, int sliceEnd,
+        juce::int64 sourceStart, int numSamples) {
 
-            if (srcIndex + 1 < input.getNumSamples()) {
-                outputData[i] = inputData[srcIndex] * (1.0f - frac) +
-                    inputData[srcIndex + 1] * frac;
-            }
-            else if (srcIndex < input.getNumSamples()) {
-                outputData[i] = inputData[srcIndex];
-            }
+        dest.clear(destStart, numSamples);
+
+        const juce::int64 first = juce::jmax<juce::int64>(0, sliceStart - sourceStart);
+        const juce::int64 last = juce::jmin<juce::int64>(numSamples, sliceEnd - sourceStart);
+        if (first >= last) return;
+
+        for (int ch = 0; ch < juce::jmin(dest.getNumChannels(), input.getNumChannels()); ++ch) {
+            dest.copyFrom(ch, destStart + static_cast<int>(first), input, ch,
+                static_cast<int>(sourceStart + first), static_cast<int>(last - first));
         }
     }
-
-    return output;
 }
 
 juce::AudioBuffer<float> AudioTimeLattice::quantizeAudio(const juce::AudioBuffer<float>& input,
     double audioStartTime,
     double quantizeStrength) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::Quantization, "Quantize audio");
+    timer.setItems(input.getNumSamples());
+
     auto transients = detectTransients(input, 0.5);
-    juce::AudioBuffer<float> output = input;
+    std::vector<double> shifts;
+    shifts.reserve(transients.size());
 
     for (double transientTime : transients) {
         double globalTime = audioStartTime + transientTime;
         double quantizedTime = quantizeToGrid(globalTime);
-        double shift = (quantizedTime - globalTime) * quantizeStrength;
-
-        // TODO: Implement actual time-shifting per transient
-        // This requires more complex audio manipulation
+        shifts.push_back((quantizedTime - globalTime) * quantizeStrength);
     }
 
-    return output;
+    return shiftSlices(input, transients, shifts);
 }
 
 juce::AudioBuffer<float> AudioTimeLattice::humanize(const juce::AudioBuffer<float>& input,
     double audioStartTime,
     double humanizeAmount) {
     auto transients = detectTransients(input, 0.5);
-    juce::AudioBuffer<float> output = input;
+    std::vector<double> shifts;
+    shifts.reserve(transients.size());
 
     juce::Random random;
-    for (double transientTime : transients) {
-        double randomShift = (random.nextFloat() - 0.5) * 2.0 * humanizeAmount * getTickDuration();
-        // TODO: Apply random time shift to this transient
+    for (size_t i = 0; i < transients.size(); ++i) {
+        shifts.push_back((random.nextFloat() - 0.5) * 2.0 * humanizeAmount * getTickDuration());
     }
 
-    return output;
+    return shiftSlices(input, transients, shifts);
 }
 
-std::vector<double> AudioTimeLattice::detectTransients(const juce::AudioBuffer<float>& input,
-    double threshold) {
-    std::vector<double> transients;
+juce::AudioBuffer<float> AudioTimeLattice::grooveQuantize(const juce::AudioBuffer<float>& input,
+    double audioStartTime,
+    const std::vector<double>& grooveTemplate) {
 
-    int windowSize = 1024;
-    int hopSize = 512;
-    float previousEnergy = 0.0f;
+    if (grooveTemplate.empty()) return input;
 
-    for (int start = 0; start < input.getNumSamples() - windowSize; start += hopSize) {
-        float energy = 0.0f;
+    Telemetry::ScopedTimer timer(Telemetry::Category::Quantization, "Groove quantize audio");
+    timer.setItems(input.getNumSamples());
 
-        for (int ch = 0; ch < input.getNumChannels(); ++ch) {
-            const float* data = input.getReadPointer(ch);
-            for (int i = 0; i < windowSize; ++i) {
-                float sample = data[start + i];
-                energy += sample * sample;
-            }
+    auto transients = detectTransients(input, 0.5);
+    std::vector<double> shifts;
+    shifts.reserve(transients.size());
+
+    for (double transientTime : transients) {
+        double globalTime = audioStartTime + transientTime;
+        double beats = compiledTempo.secondsToBeats(globalTime);
+        double beatStart = std::floor(beats);
+
+        // Nearest groove position in this beat, or the first one of the next
+        double target = beatStart + 1.0 + grooveTemplate.front();
+        for (double position : grooveTemplate) {
+            if (std::abs(beatStart + position - beats) < std::abs(target - beats))
+                target = beatStart + position;
         }
 
-        energy = std::sqrt(energy / (windowSize * input.getNumChannels()));
+        shifts.push_back(compiledTempo.beatsToSeconds(target) - globalTime);
+    }
 
-        float onsetStrength = std::max(0.0f, energy - previousEnergy);
+    return shiftSlices(input, transients, shifts);
+}
 
-        if (onsetStrength > threshold) {
-            transients.push_back(samplesToSeconds(start));
-        }
+juce::AudioBuffer<float> AudioTimeLattice::shiftSlices(const juce::AudioBuffer<float>& input,
+    const std::vector<double>& sliceTimes,
+    const std::vector<double>& shifts) {
+
+    const int numSamples = input.getNumSamples();
+    const int minSliceSamples = juce::jmax(1, secondsToSamples(minSliceSeconds));
+
+    // Slice 0 is everything before the first transient and stays put
+    std::vector<int> sliceStarts = { 0 };
+    std::vector<int> sliceShifts = { 0 };
+
+    for (size_t i = 0; i < sliceTimes.size() && i < shifts.size(); ++i) {
+        int start = findNearestZeroCrossing(input, secondsToSamples(sliceTimes[i]));
+        if (start >= numSamples || start < sliceStarts.back() + minSliceSamples) continue;
+
+        sliceStarts.push_back(start);
+        sliceShifts.push_back(static_cast<int>(std::floor(shifts[i] * sampleRate + 0.5)));
+    }
 
-        previousEnergy = energy * 0.9f; // Decay
+    // Each slice plays from its shifted start until the next one takes over, so the
+    // slices tile the output: overlaps are trimmed and gaps left silent. A slice
+    // shifted past its successor drops out.
+    const int numSlices = static_cast<int>(sliceStarts.size());
+    std::vector<int> bounds(static_cast<size_t>(numSlices + 1));
+    bounds[0] = 0;
+    bounds[static_cast<size_t>(numSlices)] = numSamples;
+
+    for (int i = 1; i < numSlices; ++i) {
+        int shifted = juce::jlimit(0, numSamples, sliceStarts[static_cast<size_t>(i)] + sliceShifts[static_cast<size_t>(i)]);
+        bounds[static_cast<size_t>(i)] = juce::jmax(bounds[static_cast<size_t>(i - 1)], shifted);
     }
 
-    return transients;
+    juce::AudioBuffer<float> output(input.getNumChannels(), numSamples);
+    const int fadeSamples = juce::jmax(1, secondsToSamples(sliceFadeSeconds));
+
+    // Every slice writes only its own stretch of the output, seam included
+    ParallelFor::forEachChunk(numSlices, ParallelFor::chooseChunkSize(numSlices, 8), [&](int begin, int end) {
+        ScratchPool::AudioBlock tail(input.getNumChannels(), fadeSamples);
+        auto& previousTail = tail.get();
+
+        for (int i = begin; i < end; ++i) {
+            const int start = bounds[static_cast<size_t>(i)];
+            const int length = bounds[static_cast<size_t>(i + 1)] - start;
+            if (length == 0) continue;
+
+            auto sliceEnd = [&](int slice) {
+                return slice + 1 < numSlices ? sliceStarts[static_cast<size_t>(slice + 1)] : numSamples;
+            };
+
+            copyShifted(output, start, input, sliceStarts[static_cast<size_t>(i)], sliceEnd(i),
+                static_cast<juce::int64>(start) - sliceShifts[static_cast<size_t>(i)], length);
+
+            if (i == 0) continue;
+
+            // The seam fades this slice in while the previous one carries on and fades out
+            const int fade = juce::jmin(fadeSamples, length);
+            copyShifted(previousTail, 0, input, sliceStarts[static_cast<size_t>(i - 1)], sliceEnd(i - 1),
+                static_cast<juce::int64>(start) - sliceShifts[static_cast<size_t>(i - 1)], fade);
+
+            applyFade(output, true, start, fade);
+            applyFade(previousTail, false, 0, fade);
+
+            for (int ch = 0; ch < output.getNumChannels(); ++ch)
+                output.addFrom(ch, start, previousTail, ch, 0, fade);
+        }
+    });
+
+    return output;
+}
+
+std::vector<double> AudioTimeLattice::detectTransients(const juce::AudioBuffer<float>& input,
+    double threshold, STFTFrameCache* frameCache) {
+    auto novelty = onsetDetector.computeNovelty(input, sampleRate, frameCache);
+    return onsetDetector.pickOnsets(novelty, threshold);
 }
 
-std::vector<AudioMarker> AudioTimeLattice::detectBeats(const juce::AudioBuffer<float>& input) {
+std::vector<AudioMarker> AudioTimeLattice::detectBeats(const juce::AudioBuffer<float>& input,
+    STFTFrameCache* frameCache) {
     std::vector<AudioMarker> beats;
-    auto transients = detectTransients(input, 0.4);
+    auto track = onsetDetector.trackBeats(onsetDetector.computeNovelty(input, sampleRate, frameCache));
 
     int id = 1;
-    for (double time : transients) {
+    for (double time : track.beats) {
         beats.push_back({ time, "Beat " + std::to_string(id), juce::Colours::cyan, id });
         id++;
     }
@@ -591,6 +916,298 @@ std::vector<AudioMarker> AudioTimeLattice::detectBeats(const juce::AudioBuffer<f
     return beats;
 }
 
+double AudioTimeLattice::applyDetectedTempo(const juce::AudioBuffer<float>& input,
+    double audioStartTime, STFTFrameCache* frameCache) {
+    auto track = onsetDetector.trackBeats(onsetDetector.computeNovelty(input, sampleRate, frameCache));
+    if (track.bpm <= 0.0) return 0.0;
+
+    // The tracked beat is taken as the signature's beat unit
+    const TempoEvent current = getTempoAt(0.0);
+    auto beatsToBpm = [&current](double beatSeconds) {
+        return 60.0 / beatSeconds * 4.0 / juce::jmax(1, current.lowerTimeSig);
+    };
+
+    // The first tempo runs back to zero, so its grid can't be shifted. A one-beat
+    // lead-in ends on the first fitted beat at least half a beat in, and the
+    // detected tempo carries on from there.
+    const double period = track.beatPeriod;
+    const double firstBeat = audioStartTime + track.firstBeat;
+    const double downbeat = firstBeat + std::ceil((period * 0.5 - firstBeat) / period) * period;
+
+    tempoMap.clear();
+    tempoMap.push_back({ 0.0, beatsToBpm(downbeat), current.upperTimeSig, current.lowerTimeSig });
+    tempoMap.push_back({ downbeat, beatsToBpm(period), current.upperTimeSig, current.lowerTimeSig });
+    compileTempoMap();
+
+    return track.bpm;
+}
+
+namespace {
+    // Loop points are looked for within this distance of the approximate ones,
+    // and judged on how well about 20ms either side of the seam lines up
+    constexpr double loopSearchSeconds = 0.05;
+    constexpr double loopSeamSeconds = 0.02;
+
+    // Each end candidate costs a transform, so only those nearest the
+    // approximate end are tried; start candidates all come out of one pass
+    constexpr int maxLoopEndCrossings = 24;
+    constexpr int maxLoopEndGridPoints = 8;
+
+    // Seam spectra kept for dragging, about 4MB at 48kHz
+    constexpr size_t maxCachedSeamSpectra = 64;
+
+    // Small enough not to smear the seam, long enough to hide what mismatch is left
+    constexpr double loopSeamFadeSeconds = 0.005;
+
+    // Identifies a seam by the samples it was transformed from, so a cached
+    // spectrum is only reused for the same audio, whichever buffer holds it
+    juce::uint64 hashSamples(const float* samples, size_t numSamples) {
+        juce::uint64 hash = 14695981039346656037ull;
+        for (size_t i = 0; i < numSamples; ++i) {
+            juce::uint32 bits;
+            std::memcpy(&bits, samples + i, sizeof(bits));
+            hash ^= bits;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+void AudioTimeLattice::prepareLoopSearch() {
+    auto& cache = loopCache;
+    const int seamSize = juce::nextPowerOfTwo(juce::jmax(16, secondsToSamples(loopSeamSeconds)));
+    const int searchRadius = juce::jmax(1, secondsToSamples(loopSearchSeconds));
+
+    if (cache.fft == nullptr || cache.seamSize != seamSize || cache.searchRadius != searchRadius) {
+        // Large enough that correlating the whole search area against one seam doesn't wrap
+        int order = 1;
+        while ((1 << order) < 2 * searchRadius + 2 * seamSize)
+            ++order;
+
+        cache.fft = std::make_unique<juce::dsp::FFT>(order);
+        cache.seamSize = seamSize;
+        cache.searchRadius = searchRadius;
+        cache.startSpectrumKey = 0;
+        cache.startSpectrum.clear();
+        cache.endSpectra.clear();
+    }
+}
+
+AudioTimeLattice::LoopWindow AudioTimeLattice::getLoopWindow(const juce::AudioBuffer<float>& input, int centre) const {
+    // Every candidate is within the radius, and its seam within half a seam of it
+    const int margin = loopCache.searchRadius + loopCache.seamSize;
+    const int numChannels = input.getNumChannels();
+
+    LoopWindow window;
+    window.origin = juce::jlimit(0, input.getNumSamples(), centre - margin);
+    const int length = juce::jlimit(0, input.getNumSamples(), centre + margin) - window.origin;
+
+    window.mix.assign(static_cast<size_t>(length), 0.0f);
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::addWithMultiply(window.mix.data(), input.getReadPointer(ch, window.origin),
+            1.0f / numChannels, length);
+
+    // Rising crossings only, so the waveform heads the same way on both sides of the seam
+    window.energyPrefix.assign(static_cast<size_t>(length) + 1, 0.0);
+
+    for (int i = 0; i < length; ++i) {
+        const float sample = window.mix[static_cast<size_t>(i)];
+        if (i > 0 && window.mix[static_cast<size_t>(i - 1)] < 0.0f && sample >= 0.0f)
+            window.risingCrossings.push_back(window.origin + i);
+
+        window.energyPrefix[static_cast<size_t>(i) + 1] = window.energyPrefix[static_cast<size_t>(i)]
+            + static_cast<double>(sample) * sample;
+    }
+
+    return window;
+}
+
+double AudioTimeLattice::LoopWindow::getEnergy(int from, int to) const {
+    const int size = static_cast<int>(mix.size());
+    from = juce::jlimit(0, size, from - origin);
+    to = juce::jlimit(0, size, to - origin);
+    return energyPrefix[static_cast<size_t>(to)] - energyPrefix[static_cast<size_t>(from)];
+}
+
+std::vector<int> AudioTimeLattice::getLoopCandidates(const LoopWindow& window, int centre,
+    int maxCrossings, int maxGridPoints) {
+
+    const int first = juce::jmax(window.origin, centre - loopCache.searchRadius);
+    const int last = juce::jmin(window.origin + static_cast<int>(window.mix.size()) - 1, centre + loopCache.searchRadius);
+
+    auto byDistance = [centre](int a, int b) { return std::abs(a - centre) < std::abs(b - centre); };
+
+    auto begin = std::lower_bound(window.risingCrossings.begin(), window.risingCrossings.end(), first);
+    auto end = std::upper_bound(begin, window.risingCrossings.end(), last);
+    std::vector<int> crossings(begin, end);
+
+    std::vector<int> gridPoints;
+    TempoMap::Cursor cursor(compiledTempo);
+    for (double tick = std::ceil(cursor.secondsToTicks(samplesToSeconds(first)));; tick += 1.0) {
+        const int sample = secondsToSamples(cursor.ticksToSeconds(tick));
+        if (sample > last) break;
+        if (sample >= first) gridPoints.push_back(sample);
+    }
+
+    auto keepNearest = [&byDistance](std::vector<int>& points, int count) {
+        if (points.size() <= static_cast<size_t>(count)) return;
+        std::nth_element(points.begin(), points.begin() + count, points.end(), byDistance);
+        points.resize(static_cast<size_t>(count));
+    };
+
+    keepNearest(crossings, maxCrossings);
+    keepNearest(gridPoints, maxGridPoints);
+
+    std::vector<int> candidates = std::move(crossings);
+    candidates.insert(candidates.end(), gridPoints.begin(), gridPoints.end());
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+juce::uint64 AudioTimeLattice::getSeamSamples(const LoopWindow& window, int origin, int length,
+    std::vector<float>& spectrum) const {
+
+    const int fftSize = loopCache.fft->getSize();
+    const int windowEnd = window.origin + static_cast<int>(window.mix.size());
+
+    // Zero outside the audio, as the transform would see it
+    spectrum.assign(static_cast<size_t>(fftSize) * 2, 0.0f);
+    for (int i = juce::jmax(0, window.origin - origin); i < length && origin + i < windowEnd; ++i)
+        spectrum[static_cast<size_t>(i)] = window.mix[static_cast<size_t>(origin + i - window.origin)];
+
+    return hashSamples(spectrum.data(), static_cast<size_t>(length));
+}
+
+std::pair<double, double> AudioTimeLattice::findBestLoopPoints(const juce::AudioBuffer<float>& input,
+    double approximateStart,
+    double approximateEnd) {
+
+    const std::pair<double, double> fallback{ approximateStart, approximateEnd };
+    if (input.getNumSamples() == 0 || input.getNumChannels() == 0) return fallback;
+
+    prepareLoopSearch();
+    auto& cache = loopCache;
+
+    const int numSamples = input.getNumSamples();
+    const int half = cache.seamSize / 2;
+    const int radius = cache.searchRadius;
+    const int fftSize = cache.fft->getSize();
+
+    const int approxStart = juce::jlimit(0, numSamples, secondsToSamples(approximateStart));
+    const int approxEnd = juce::jlimit(0, numSamples, secondsToSamples(approximateEnd));
+
+    // Only the audio around each approximate point is read, however long the input
+    const auto startWindow = getLoopWindow(input, approxStart);
+    const auto endWindow = getLoopWindow(input, approxEnd);
+
+    auto starts = getLoopCandidates(startWindow, approxStart, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+    auto ends = getLoopCandidates(endWindow, approxEnd, maxLoopEndCrossings, maxLoopEndGridPoints);
+    if (starts.empty() || ends.empty()) return fallback;
+
+    // One transform of the area around the start serves every end candidate;
+    // lag d in the correlation is the seam centred on start origin + half + d
+    const int startOrigin = approxStart - radius - half;
+    std::vector<float> seam;
+    const auto startKey = getSeamSamples(startWindow, startOrigin, 2 * radius + cache.seamSize, seam);
+
+    if (cache.startSpectrum.empty() || cache.startSpectrumKey != startKey) {
+        cache.fft->performRealOnlyForwardTransform(seam.data());
+        cache.startSpectrum = std::move(seam);
+        cache.startSpectrumKey = startKey;
+    }
+
+    auto correlation = ScratchPool::borrow<float>(static_cast<size_t>(fftSize) * 2);
+    double bestScore = -std::numeric_limits<double>::max();
+    std::pair<int, int> best{ approxStart, approxEnd };
+
+    for (int end : ends) {
+        const auto endKey = getSeamSamples(endWindow, end - half, cache.seamSize, seam);
+
+        auto cached = cache.endSpectra.find(endKey);
+        if (cached == cache.endSpectra.end()) {
+            if (cache.endSpectra.size() >= maxCachedSeamSpectra) cache.endSpectra.clear();
+
+            cache.fft->performRealOnlyForwardTransform(seam.data());
+            cached = cache.endSpectra.emplace(endKey, seam).first;
+        }
+
+        // Cross-correlation is the inverse transform of one spectrum times the
+        // conjugate of the other
+        const float* a = cache.startSpectrum.data();
+        const float* b = cached->second.data();
+        for (int bin = 0; bin < fftSize; ++bin) {
+            const float re = a[bin * 2] * b[bin * 2] + a[bin * 2 + 1] * b[bin * 2 + 1];
+            const float im = a[bin * 2 + 1] * b[bin * 2] - a[bin * 2] * b[bin * 2 + 1];
+            correlation[static_cast<size_t>(bin) * 2] = re;
+            correlation[static_cast<size_t>(bin) * 2 + 1] = im;
+        }
+
+        cache.fft->performRealOnlyInverseTransform(correlation.data());
+
+        const double endEnergy = endWindow.getEnergy(end - half, end + half);
+
+        for (int start : starts) {
+            if (end - start < cache.seamSize) continue;
+
+            const int lag = start - (startOrigin + half);
+            if (lag < 0 || lag > 2 * radius) continue;
+
+            // Normalised, so loud seams don't win just for being loud, with a slight pull
+            // towards the requested points so flat material stays where it was put
+            const double energy = std::sqrt(startWindow.getEnergy(start - half, start + half) * endEnergy);
+            const double similarity = energy > 0.0 ? correlation[static_cast<size_t>(lag)] / energy : 0.0;
+            const double distance = (std::abs(start - approxStart) + std::abs(end - approxEnd)) / (2.0 * radius);
+            const double score = similarity - 0.01 * distance;
+
+            if (score > bestScore) {
+                bestScore = score;
+                best = { start, end };
+            }
+        }
+    }
+
+    return { samplesToSeconds(best.first), samplesToSeconds(best.second) };
+}
+
+juce::AudioBuffer<float> AudioTimeLattice::createLoop(const juce::AudioBuffer<float>& input,
+    double startTime, double endTime,
+    int numRepeats) {
+
+    const int start = juce::jlimit(0, input.getNumSamples(), secondsToSamples(startTime));
+    const int end = juce::jlimit(start, input.getNumSamples(), secondsToSamples(endTime));
+    const int loopLength = end - start;
+
+    juce::AudioBuffer<float> output(input.getNumChannels(), loopLength * juce::jmax(0, numRepeats));
+    if (loopLength == 0 || numRepeats <= 0) return output;
+
+    for (int repeat = 0; repeat < numRepeats; ++repeat) {
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+            output.copyFrom(ch, repeat * loopLength, input, ch, start, loopLength);
+    }
+
+    // At each seam the audio after the loop end fades into the loop start. The two
+    // sides are alike by design, so a linear fade keeps the level steady where an
+    // equal-power one would bulge.
+    const int fadeSamples = juce::jmin(secondsToSamples(loopSeamFadeSeconds), loopLength,
+        input.getNumSamples() - end);
+
+    for (int repeat = 1; repeat < numRepeats && fadeSamples > 0; ++repeat) {
+        const int seam = repeat * loopLength;
+
+        for (int i = 0; i < fadeSamples; ++i) {
+            const float ratio = (i + 0.5f) / fadeSamples;
+
+            for (int ch = 0; ch < input.getNumChannels(); ++ch) {
+                float* data = output.getWritePointer(ch);
+                data[seam + i] = data[seam + i] * ratio + input.getSample(ch, end + i) * (1.0f - ratio);
+            }
+        }
+    }
+
+    return output;
+}
+
 juce::AudioBuffer<float> AudioTimeLattice::crossfade(const juce::AudioBuffer<float>& clip1,
     const juce::AudioBuffer<float>& clip2,
     double crossfadeDuration) {
@@ -629,6 +1246,94 @@ juce::AudioBuffer<float> AudioTimeLattice::crossfade(const juce::AudioBuffer<flo
     return output;
 }
 
+juce::AudioBuffer<float> AudioTimeLattice::warpToGrid(const juce::AudioBuffer<float>& input,
+    const std::vector<double>& detectedBeats) {
+
+    // Each beat is pinned to its nearest grid point and the audio between beats
+    // stretched to fit. Beats closer than a frame to the last kept one, on
+    // either side of the map, would need extreme local ratios and are skipped.
+    const double minSpacing = stretcher.getFrameSize();
+    std::vector<TimeStretcher::Anchor> anchors = { { 0.0, 0.0 } };
+
+    std::vector<double> beats = detectedBeats;
+    std::sort(beats.begin(), beats.end());
+
+    for (double beat : beats) {
+        double inputSample = beat * sampleRate;
+        double outputSample = quantizeToGrid(beat) * sampleRate;
+
+        if (inputSample >= input.getNumSamples()) break;
+
+        const auto& last = anchors.back();
+        if (inputSample - last.inputSample < minSpacing || outputSample - last.outputSample < minSpacing)
+            continue;
+
+        anchors.push_back({ inputSample, outputSample });
+    }
+
+    // The audio after the last beat keeps its length
+    const auto& last = anchors.back();
+    anchors.push_back({ static_cast<double>(input.getNumSamples()),
+        last.outputSample + (input.getNumSamples() - last.inputSample) });
+
+    juce::AudioBuffer<float> output;
+    if (!stretcher.warp(input, anchors, output)) return input;
+    return output;
+}
+
+void AudioTimeLattice::applyFade(juce::AudioBuffer<float>& buffer, bool fadeIn,
+    int startSample, int numSamples) {
+    // Equal-power, like crossfade, so uncorrelated seams keep their level
+    for (int i = 0; i < numSamples; ++i) {
+        float ratio = (i + 0.5f) / numSamples;
+        float gain = fadeIn ? std::sin(ratio * juce::MathConstants<float>::halfPi)
+            : std::cos(ratio * juce::MathConstants<float>::halfPi);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.getWritePointer(ch)[startSample + i] *= gain;
+    }
+}
+
+std::vector<int> AudioTimeLattice::findZeroCrossings(const juce::AudioBuffer<float>& buffer,
+    int startSample, int endSample) {
+    std::vector<int> crossings;
+
+    startSample = juce::jlimit(1, juce::jmax(1, buffer.getNumSamples()), startSample);
+    endSample = juce::jlimit(startSample, buffer.getNumSamples(), endSample);
+
+    // Crossings of the channel sum, so a cut lands quietly on every channel at once
+    auto mixAt = [&buffer](int sample) {
+        float sum = 0.0f;
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            sum += buffer.getSample(ch, sample);
+        return sum;
+    };
+
+    float previous = mixAt(startSample - 1);
+    for (int i = startSample; i < endSample; ++i) {
+        float current = mixAt(i);
+        if ((previous < 0.0f) != (current < 0.0f))
+            crossings.push_back(i);
+        previous = current;
+    }
+
+    return crossings;
+}
+
+int AudioTimeLattice::findNearestZeroCrossing(const juce::AudioBuffer<float>& buffer,
+    int targetSample) {
+    const int radius = secondsToSamples(zeroCrossingSearchSeconds);
+    auto crossings = findZeroCrossings(buffer, targetSample - radius, targetSample + radius + 1);
+
+    int nearest = targetSample;
+    for (int crossing : crossings) {
+        if (nearest == targetSample || std::abs(crossing - targetSample) < std::abs(nearest - targetSample))
+            nearest = crossing;
+    }
+
+    return nearest;
+}
+
 // ============================================================================
 // Marker Management
 // ============================================================================
@@ -668,31 +1373,20 @@ AudioMarker* AudioTimeLattice::findNearestMarker(double timeInSeconds, double to
 // ============================================================================
 
 TempoEvent AudioTimeLattice::getCurrentTempo(double timeInSeconds) const {
-    if (tempoMap.empty()) return { 0.0, 120.0, 4, 4 };
-
-    for (auto it = tempoMap.rbegin(); it != tempoMap.rend(); ++it) {
-        if (timeInSeconds >= it->timeInSeconds) {
-            return *it;
-        }
-    }
-
-    return tempoMap.front();
+    return compiledTempo.getSegmentAtSeconds(timeInSeconds).event;
 }
 
 double AudioTimeLattice::getTickDuration() const {
-    TempoEvent tempo = getCurrentTempo(0);
-    double beatLength = 60.0 / tempo.bpm;
-    return beatLength / ppqn;
+    return compiledTempo.getSegment(0).secondsPerTick;
 }
 
 double AudioTimeLattice::getBeatDuration(double atTime) const {
-    TempoEvent tempo = getCurrentTempo(atTime);
-    return 60.0 / tempo.bpm;
+    return compiledTempo.getSegmentAtSeconds(atTime).secondsPerBeat;
 }
 
 double AudioTimeLattice::getBarDuration(double atTime) const {
-    TempoEvent tempo = getCurrentTempo(atTime);
-    return (60.0 / tempo.bpm) * tempo.upperTimeSig;
+    const TempoMap::Segment& segment = compiledTempo.getSegmentAtSeconds(atTime);
+    return segment.secondsPerBeat * segment.beatsPerBar;
 }
 
 TempoEvent AudioTimeLattice::getTempoAt(double timeInSeconds) const {
@@ -720,9 +1414,12 @@ bool AudioTimeLattice::isOnGrid(double timeInSeconds, double tolerance) {
 }
 
 double AudioTimeLattice::getNextGridPoint(double timeInSeconds) {
-    return quantizeToGrid(timeInSeconds + getTickDuration(), QuantizeMode::Ceil);
+    // Strictly after, so stepping from a grid line moves on by one tick
+    double ticks = compiledTempo.secondsToTicks(timeInSeconds);
+    return compiledTempo.ticksToSeconds(std::floor(ticks + 1.0e-9) + 1.0);
 }
 
 double AudioTimeLattice::getPreviousGridPoint(double timeInSeconds) {
-    return quantizeToGrid(timeInSeconds - getTickDuration(), QuantizeMode::Floor);
+    double ticks = compiledTempo.secondsToTicks(timeInSeconds);
+    return compiledTempo.ticksToSeconds(std::ceil(ticks - 1.0e-9) - 1.0);
 }
\ No newline at end of file
@@ -5,9 +5,15 @@
 // ============================================================================
 #pragma once
 #include <JuceHeader.h>
+#include "EditList.h"
+#include "TimeStretcher.h"
+#include "OnsetDetector.h"
 #include <vector>
+#include <limits>
 #include <map>
+#include <memory>
 #include <string>
+#include <iterator>
 
 // ============================================================================
 // Time Domain Enumerations
@@ -27,6 +33,12 @@ enum class QuantizeMode {
     Ceil               // Round up
 };
 
+enum class GridUnit {
+    Ticks,             // PPQN ticks
+    Beats,             // Time signature beat unit
+    Bars
+};
+
 enum class ValueResolution {
     Bit7 = 7,          // MIDI CC (128 steps)
     Bit14 = 14,        // MIDI NRPN (16384 steps)
@@ -59,6 +71,137 @@ struct TempoEvent {
     int lowerTimeSig = 4;      // Denominator (beat unit)
 };
 
+// ============================================================================
+// Compiled Tempo Map
+// ============================================================================
+
+// Tempo events flattened into segments with the cumulative musical position at
+// each segment start, so any conversion is a binary search plus arithmetic.
+// Ticks are PPQN ticks per quarter note; beats are in the time signature's unit.
+class TempoMap {
+public:
+    struct Segment {
+        double startSeconds = 0.0;
+        double startTicks = 0.0;
+        double startBeats = 0.0;
+        double startBars = 0.0;      // 0-based, fractional if a change lands mid-bar
+
+        double secondsPerTick = 0.0;
+        double secondsPerBeat = 0.0;
+        int beatsPerBar = 4;
+
+        TempoEvent event;
+    };
+
+    TempoMap();
+
+    // Events must be sorted by time; an empty map means 120 BPM in 4/4
+    void compile(const std::vector<TempoEvent>& events, int ppqn);
+
+    size_t getNumSegments() const { return segments.size(); }
+    const Segment& getSegment(size_t index) const { return segments[index]; }
+    const Segment& getSegmentAtSeconds(double seconds) const { return segments[findSegmentAtSeconds(seconds)]; }
+
+    size_t findSegmentAtSeconds(double seconds) const;
+    size_t findSegmentAtTicks(double ticks) const;
+    size_t findSegmentAtBeats(double beats) const;
+    size_t findSegmentAtBars(double bars) const;
+
+    double secondsToTicks(double seconds) const;
+    double ticksToSeconds(double ticks) const;
+    double secondsToBeats(double seconds) const;
+    double beatsToSeconds(double beats) const;
+    double secondsToBars(double seconds) const;
+    double barsToSeconds(double bars) const;
+
+    // Generic forms over GridUnit. positionToSeconds walks forward from segmentHint.
+    double secondsToPosition(double seconds, GridUnit unit) const;
+    double positionToSeconds(double position, GridUnit unit, size_t& segmentHint) const;
+    static double getUnitSeconds(const Segment& segment, GridUnit unit);
+
+    // Batch conversions, safe in place. Sorted input walks the segments forward
+    // instead of searching for each value.
+    void secondsToTicks(const double* seconds, double* ticks, int numValues) const;
+    void ticksToSeconds(const double* ticks, double* seconds, int numValues) const;
+
+    // Remembers the last segment for each direction, so ascending queries are O(1)
+    class Cursor {
+    public:
+        explicit Cursor(const TempoMap& map) : map(map) {}
+
+        double secondsToTicks(double seconds);
+        double ticksToSeconds(double ticks);
+
+    private:
+        const TempoMap& map;
+        size_t secondsSegment = 0;
+        size_t ticksSegment = 0;
+    };
+
+private:
+    std::vector<Segment> segments;
+
+    static double secondsPerQuarter(const TempoEvent& event);
+    static double Segment::* getPositionMember(GridUnit unit);
+    size_t advanceSegment(size_t segment, double value, double Segment::* start) const;
+};
+
+// ============================================================================
+// Lazy Grid Ranges
+// ============================================================================
+
+// Grid lines in [startSeconds, endSeconds], every stride-th unit, generated while
+// iterating so a range over a whole session costs nothing until it is walked.
+// Positions are multiples of the stride, so lines stay put as the range scrolls.
+// The range refers to the tempo map, so it is only valid until the tempo changes.
+class GridRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = double;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const double*;
+        using reference = double;
+
+        double operator*() const { return seconds; }
+        double getPosition() const { return position; }   // Tick, beat or bar number
+
+        Iterator& operator++();
+        Iterator operator++(int) { Iterator previous = *this; ++(*this); return previous; }
+
+        bool operator==(const Iterator& other) const { return position == other.position; }
+        bool operator!=(const Iterator& other) const { return position != other.position; }
+
+    private:
+        friend class GridRange;
+        Iterator(const GridRange& range, double position);
+
+        const GridRange* range;
+        double position;
+        double seconds = 0.0;
+        size_t segment = 0;
+    };
+
+    GridRange(const TempoMap& map, GridUnit unit, double startSeconds, double endSeconds, int stride = 1);
+
+    Iterator begin() const { return Iterator(*this, firstPosition); }
+    Iterator end() const { return Iterator(*this, endPosition); }
+
+    size_t size() const { return static_cast<size_t>((endPosition - firstPosition) / stride); }
+    bool empty() const { return endPosition <= firstPosition; }
+
+    GridUnit getUnit() const { return unit; }
+    int getStride() const { return stride; }
+
+private:
+    const TempoMap& map;
+    GridUnit unit;
+    int stride;
+    double firstPosition = 0.0;
+    double endPosition = 0.0;
+};
+
 // ============================================================================
 // Audio Edit Marker (for editing operations)
 // ============================================================================
@@ -101,6 +244,11 @@ public:
     double toSeconds(double value, TimeDomain domain);
     double fromSeconds(double seconds, TimeDomain domain);
 
+    // Batch conversion, safe in place; sorted input is fastest
+    void convert(const double* values, double* results, int numValues, TimeDomain from, TimeDomain to);
+    void convertBreakpointTimes(std::vector<std::pair<double, double>>& breakpoints,
+        TimeDomain from, TimeDomain to);
+
     // Specific conversions
     MusicalTime secondsToMusical(double seconds);
     double musicalToSeconds(const MusicalTime& mt);
@@ -116,17 +264,32 @@ public:
     std::vector<double> generateBeatGrid(double startSeconds, double endSeconds);
     std::vector<double> generateBarGrid(double startSeconds, double endSeconds);
 
+    // Lazy equivalents; nothing is allocated however long the range
+    GridRange getGrid(GridUnit unit, double startSeconds, double endSeconds, int stride = 1) const;
+
+    // Power-of-two stride keeping neighbouring lines at least minSpacingSeconds apart,
+    // e.g. a pixel's worth of time so only lines that can be seen are visited
+    GridRange getGridForZoom(GridUnit unit, double startSeconds, double endSeconds,
+        double minSpacingSeconds) const;
+
     // ========================================================================
     // Quantization
     // ========================================================================
 
     double quantizeToGrid(double timeInSeconds, QuantizeMode mode = QuantizeMode::Nearest);
+
+    // Quantizes a whole array in one pass, safe in place; fastest when sorted
+    void quantizeToGrid(const double* times, double* results, int numValues,
+        QuantizeMode mode = QuantizeMode::Nearest);
     double quantizeToBeat(double timeInSeconds, QuantizeMode mode = QuantizeMode::Nearest);
     double quantizeToBar(double timeInSeconds, QuantizeMode mode = QuantizeMode::Nearest);
 
     // Value quantization
     double quantizeValue(double value, ValueResolution resolution);
 
+    // Smallest value change worth keeping, as a fraction of full scale
+    double calculatePerceptualThreshold(ValueResolution resolution);
+
     // Batch quantization
     std::vector<std::pair<double, double>> quantizeBreakpoints(
         const std::vector<std::pair<double, double>>& input,
@@ -153,10 +316,22 @@ public:
     juce::AudioBuffer<float> nudge(const juce::AudioBuffer<float>& input,
         double nudgeAmount, bool fillWithSilence = true);
 
-    // Advanced operations
+    // The same edits on an edit list: only slice metadata changes, and the
+    // audio is read from the shared sources when the result is rendered
+    EditList trim(const EditList& input, double startTime, double endTime);
+    EditList cut(const EditList& input, double startTime, double endTime);
+    std::vector<EditList> split(const EditList& input, const std::vector<double>& splitTimes);
+    EditList merge(const std::vector<EditList>& clips, const std::vector<double>& positions);
+    EditList nudge(const EditList& input, double nudgeAmount);
+
+    // Advanced operations. The stretch keeps pitch; channels share frame
+    // positions so stereo stays coherent.
     juce::AudioBuffer<float> timeStretch(const juce::AudioBuffer<float>& input,
         double stretchFactor);
 
+    // Quantize, humanize and groove cut the audio at its transients and move
+    // each slice, so the hits land on time without stretching anything. The
+    // groove template lists positions within a beat, as fractions of it.
     juce::AudioBuffer<float> quantizeAudio(const juce::AudioBuffer<float>& input,
         double audioStartTime,
         double quantizeStrength = 1.0);
@@ -169,13 +344,28 @@ public:
         double audioStartTime,
         const std::vector<double>& grooveTemplate);
 
-    // Transient/beat detection
+    // Transient/beat detection, on spectral-flux onsets. threshold scales how far
+    // an onset has to stand out from its surroundings. frameCache is optional and
+    // must only be given for buffers whose cache entries stay valid.
     std::vector<double> detectTransients(const juce::AudioBuffer<float>& input,
-        double threshold = 0.5);
+        double threshold = 0.5, STFTFrameCache* frameCache = nullptr);
+
+    // One marker per tracked beat, rather than per onset
+    std::vector<AudioMarker> detectBeats(const juce::AudioBuffer<float>& input,
+        STFTFrameCache* frameCache = nullptr);
 
-    std::vector<AudioMarker> detectBeats(const juce::AudioBuffer<float>& input);
+    // Replaces the tempo map with the tracked tempo, with a grid line on every
+    // beat of input placed at audioStartTime. Returns the tempo, or 0 with the
+    // map left alone if no steady pulse was found.
+    double applyDetectedTempo(const juce::AudioBuffer<float>& input,
+        double audioStartTime = 0.0, STFTFrameCache* frameCache = nullptr);
 
-    // Loop operations
+    OnsetDetector& getOnsetDetector() { return onsetDetector; }
+
+    // Loop operations. The search picks the start and end, among zero crossings
+    // and grid points near the approximate ones, whose surroundings match best.
+    // Only the audio around each point is read, and seam spectra are kept, so
+    // repeated searches, such as while dragging loop points, mostly correlate.
     std::pair<double, double> findBestLoopPoints(const juce::AudioBuffer<float>& input,
         double approximateStart,
         double approximateEnd);
@@ -189,7 +379,8 @@ public:
         const juce::AudioBuffer<float>& clip2,
         double crossfadeDuration);
 
-    // Warp (time-stretching with markers)
+    // Warp (time-stretching with markers): each detected beat, in seconds, is
+    // moved onto the grid by stretching the audio between beats
     juce::AudioBuffer<float> warpToGrid(const juce::AudioBuffer<float>& input,
         const std::vector<double>& detectedBeats);
 
@@ -231,20 +422,28 @@ public:
     double getBeatDuration(double atTime = 0.0) const;
     double getBarDuration(double atTime = 0.0) const;
     TempoEvent getTempoAt(double timeInSeconds) const;
+    const TempoMap& getTempoMap() const { return compiledTempo; }
 
 private:
     // Core settings
     int ppqn;
     double sampleRate;
     std::vector<TempoEvent> tempoMap;
+    TempoMap compiledTempo;            // Rebuilt whenever tempoMap or ppqn changes
     std::vector<AudioMarker> markers;
     int nextMarkerId = 1;
+    TimeStretcher stretcher;           // Keeps its window and scratch between stretches
+    OnsetDetector onsetDetector;
 
     // Helper methods
+    void compileTempoMap();
     TempoEvent getCurrentTempo(double timeInSeconds = 0.0) const;
     int musicalToTotalTicks(const MusicalTime& mt) const;
     MusicalTime totalTicksToMusical(int totalTicks) const;
 
+    // Edit lists address whole files, so they need more range than secondsToSamples
+    juce::int64 secondsToTimelineSamples(double seconds) const;
+
     // Audio processing helpers
     void applyFade(juce::AudioBuffer<float>& buffer, bool fadeIn,
         int startSample, int numSamples);
@@ -255,8 +454,42 @@ private:
     int findNearestZeroCrossing(const juce::AudioBuffer<float>& buffer,
         int targetSample);
 
-    // Quantization helpers
-    double calculatePerceptualThreshold(ValueResolution resolution);
+    // Moves each slice starting at sliceTimes[i] by shifts[i] seconds, crossfading
+    // the seams, into one output the length of the input
+    juce::AudioBuffer<float> shiftSlices(const juce::AudioBuffer<float>& input,
+        const std::vector<double>& sliceTimes,
+        const std::vector<double>& shifts);
+
+    // Loop search state kept between searches. Spectra are keyed on a hash of
+    // the samples they came from, so they stay right if a buffer is refilled.
+    struct LoopSearchCache {
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int seamSize = 0;
+        int searchRadius = 0;
+
+        std::vector<float> startSpectrum;        // Search area around the last approximate start
+        juce::uint64 startSpectrumKey = 0;
+        std::map<juce::uint64, std::vector<float>> endSpectra;   // Seam around each end tried
+    };
+    LoopSearchCache loopCache;
+
+    // Channel mix of the audio around one approximate loop point, rebuilt per search
+    struct LoopWindow {
+        int origin = 0;                          // Input sample of mix[0]
+        std::vector<float> mix;
+        std::vector<int> risingCrossings;        // In input samples
+        std::vector<double> energyPrefix;        // Running sum of mix squared
+
+        double getEnergy(int from, int to) const;
+    };
+
+    void prepareLoopSearch();
+    LoopWindow getLoopWindow(const juce::AudioBuffer<float>& input, int centre) const;
+    std::vector<int> getLoopCandidates(const LoopWindow& window, int centre, int maxCrossings, int maxGridPoints);
+
+    // Fills spectrum with the zero-padded seam, ready to transform, and returns its hash
+    juce::uint64 getSeamSamples(const LoopWindow& window, int origin, int length, std::vector<float>& spectrum) const;
 
+    // Quantization helpers
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioTimeLattice)
 };
\ No newline at end of file
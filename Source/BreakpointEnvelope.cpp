@@ -0,0 +1,76 @@
+// ============================================================================
+// BreakpointEnvelope.cpp
+// ============================================================================
+#include "BreakpointEnvelope.h"
+#include <algorithm>
+
+BreakpointEnvelope::BreakpointEnvelope(const Points& points)
+    : points(points) {
+}
+
+float BreakpointEnvelope::getValueAt(double time) const {
+    if (points.empty()) return 0.0f;
+    if (points.size() == 1) return static_cast<float>(points[0].second);
+
+    return interpolate(findSegment(time), time);
+}
+
+void BreakpointEnvelope::render(float* dest, int numSamples, double startTime, double sampleRate) const {
+    Cursor cursor(*this);
+
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = cursor.getValueAt(startTime + i / sampleRate);
+}
+
+size_t BreakpointEnvelope::findSegment(double time) const {
+    auto it = std::upper_bound(points.begin() + 1, points.end(), time,
+        [](double t, const std::pair<double, double>& point) { return t < point.first; });
+
+    size_t index = static_cast<size_t>(std::distance(points.begin(), it)) - 1;
+    return std::min(index, points.size() - 2);
+}
+
+float BreakpointEnvelope::interpolate(size_t segment, double time) const {
+    if (time <= points.front().first) return static_cast<float>(points.front().second);
+    if (time >= points.back().first) return static_cast<float>(points.back().second);
+
+    double t1 = points[segment].first;
+    double t2 = points[segment + 1].first;
+    double v1 = points[segment].second;
+    double v2 = points[segment + 1].second;
+
+    // Coincident points step straight to the later value
+    if (t2 <= t1) return static_cast<float>(v2);
+
+    double ratio = (time - t1) / (t2 - t1);
+    return static_cast<float>(v1 + ratio * (v2 - v1));
+}
+
+// ============================================================================
+// Cursor
+// ============================================================================
+
+BreakpointEnvelope::Cursor::Cursor(const BreakpointEnvelope& envelope)
+    : envelope(envelope) {
+}
+
+float BreakpointEnvelope::Cursor::getValueAt(double time) {
+    const auto& points = envelope.points;
+
+    if (points.empty()) return 0.0f;
+    if (points.size() == 1) return static_cast<float>(points[0].second);
+
+    if (segment > points.size() - 2 || (segment > 0 && time < points[segment].first)) {
+        segment = envelope.findSegment(time);
+    }
+    else {
+        while (segment + 2 < points.size() && points[segment + 1].first <= time)
+            ++segment;
+    }
+
+    return envelope.interpolate(segment, time);
+}
+
+void BreakpointEnvelope::Cursor::seek(double time) {
+    segment = envelope.points.size() >= 2 ? envelope.findSegment(time) : 0;
+}
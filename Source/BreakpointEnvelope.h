@@ -0,0 +1,50 @@
+// ============================================================================
+// BreakpointEnvelope.h
+// Linear interpolation over time-sorted breakpoints
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+class BreakpointEnvelope {
+public:
+    using Points = std::vector<std::pair<double, double>>;
+
+    // Points must be sorted by time and outlive the envelope. Values hold at
+    // the first/last point outside the breakpoint range.
+    explicit BreakpointEnvelope(const Points& points);
+
+    // Random access by binary search
+    float getValueAt(double time) const;
+
+    // Fills dest[i] with the value at startTime + i / sampleRate
+    void render(float* dest, int numSamples, double startTime, double sampleRate) const;
+
+    // ========================================================================
+    // Sequential evaluation
+    // Walks forward from the last segment, so a full render is O(samples + points).
+    // Seeking backwards falls back to a binary search.
+    // ========================================================================
+
+    class Cursor {
+    public:
+        explicit Cursor(const BreakpointEnvelope& envelope);
+
+        float getValueAt(double time);
+        void reset() { segment = 0; }
+
+        // Jumps straight to the segment holding time, e.g. at the start of a render block
+        void seek(double time);
+
+    private:
+        const BreakpointEnvelope& envelope;
+        size_t segment = 0;
+    };
+
+private:
+    const Points& points;
+
+    // Index i of the segment [points[i], points[i + 1]] holding time
+    size_t findSegment(double time) const;
+    float interpolate(size_t segment, double time) const;
+};
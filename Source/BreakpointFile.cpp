@@ -0,0 +1,316 @@
+// ============================================================================
+// BreakpointFile.cpp
+// ============================================================================
+#include "BreakpointFile.h"
+#include "Telemetry.h"
+#include <cstring>
+
+namespace {
+    bool writePadding(juce::OutputStream& stream, size_t bytes) {
+        static const char zeros[8] = {};
+        return bytes == 0 || stream.write(zeros, bytes);
+    }
+}
+
+size_t BreakpointFile::getTimeBytes(Encoding encoding, size_t numPoints) {
+    // A delta-encoded column starts with one exact double, then float steps
+    if (encoding == Encoding::DeltaTimes && numPoints > 0)
+        return align(sizeof(double) + (numPoints - 1) * sizeof(float));
+
+    return numPoints * sizeof(double);
+}
+
+bool BreakpointFile::isBinaryFile(const juce::File& file) {
+    juce::FileInputStream stream(file);
+    if (!stream.openedOk()) return false;
+
+    juce::uint32 fileMagic = 0;
+    return stream.read(&fileMagic, sizeof(fileMagic)) == sizeof(fileMagic)
+        && juce::ByteOrder::swapIfBigEndian(fileMagic) == magic;
+}
+
+bool BreakpointFile::write(const juce::File& file, const Contents& contents, Encoding encoding) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Write breakpoint file");
+
+   #if JUCE_BIG_ENDIAN
+    // Columns are written in native order for the mapped reader
+    juce::ignoreUnused(file, contents, encoding);
+    return false;
+   #else
+    // FileOutputStream appends, so start from an empty file
+    if (file.existsAsFile() && !file.deleteFile()) return false;
+
+    juce::FileOutputStream stream(file);
+    if (!stream.openedOk()) return false;
+
+    const auto featureName = contents.featureName.toStdString();
+    const auto sourceName = contents.sourceName.toStdString();
+
+    Header header{};
+    header.magic = magic;
+    header.version = currentVersion;
+    header.numOutputs = static_cast<juce::uint32>(contents.outputs.size());
+    header.featureNameBytes = static_cast<juce::uint32>(featureName.size());
+    header.sampleRate = contents.sampleRate;
+    header.sourceNameBytes = static_cast<juce::uint32>(sourceName.size());
+
+    // Names first, all in one block, then the directory and the columns
+    std::vector<std::string> outputNames;
+    size_t namesSize = featureName.size() + sourceName.size();
+
+    for (const auto& output : contents.outputs) {
+        outputNames.push_back(output.name.toStdString());
+        namesSize += outputNames.back().size();
+    }
+
+    const size_t namesStart = sizeof(Header);
+    const size_t directoryStart = align(namesStart + namesSize);
+    header.directoryOffset = static_cast<juce::uint32>(directoryStart);
+    size_t dataOffset = directoryStart + contents.outputs.size() * sizeof(OutputEntry);
+    size_t nameOffset = namesStart + featureName.size() + sourceName.size();
+
+    std::vector<OutputEntry> directory;
+    for (size_t i = 0; i < contents.outputs.size(); ++i) {
+        size_t numPoints = contents.outputs[i].points.size();
+
+        OutputEntry entry{};
+        entry.numPoints = numPoints;
+        entry.dataOffset = dataOffset;
+        entry.encoding = static_cast<juce::uint32>(encoding);
+        entry.nameBytes = static_cast<juce::uint32>(outputNames[i].size());
+        entry.nameOffset = nameOffset;
+        directory.push_back(entry);
+
+        nameOffset += outputNames[i].size();
+        dataOffset += getTimeBytes(encoding, numPoints) + numPoints * sizeof(double);
+    }
+
+    bool ok = stream.write(&header, sizeof(header))
+        && stream.write(featureName.data(), featureName.size())
+        && stream.write(sourceName.data(), sourceName.size());
+
+    for (const auto& name : outputNames)
+        ok = ok && stream.write(name.data(), name.size());
+
+    ok = ok && writePadding(stream, directoryStart - (namesStart + namesSize));
+
+    if (!directory.empty())
+        ok = ok && stream.write(directory.data(), directory.size() * sizeof(OutputEntry));
+
+    std::vector<double> column;
+    std::vector<float> steps;
+
+    for (const auto& output : contents.outputs) {
+        const auto& points = output.points;
+        if (points.empty() || !ok) continue;
+
+        column.resize(points.size());
+
+        if (encoding == Encoding::DeltaTimes) {
+            // Steps are taken from the decoded time, so each one absorbs the
+            // rounding of the steps before it
+            steps.resize(points.size() - 1);
+            double decoded = points[0].first;
+
+            for (size_t i = 1; i < points.size(); ++i) {
+                steps[i - 1] = static_cast<float>(points[i].first - decoded);
+                decoded += steps[i - 1];
+            }
+
+            size_t timeBytes = sizeof(double) + steps.size() * sizeof(float);
+            ok = ok && stream.write(&points[0].first, sizeof(double))
+                && (steps.empty() || stream.write(steps.data(), steps.size() * sizeof(float)))
+                && writePadding(stream, getTimeBytes(encoding, points.size()) - timeBytes);
+        }
+        else {
+            for (size_t i = 0; i < points.size(); ++i)
+                column[i] = points[i].first;
+
+            ok = ok && stream.write(column.data(), column.size() * sizeof(double));
+        }
+
+        for (size_t i = 0; i < points.size(); ++i)
+            column[i] = points[i].second;
+
+        ok = ok && stream.write(column.data(), column.size() * sizeof(double));
+    }
+
+    stream.flush();
+
+    juce::int64 numPoints = 0;
+    for (const auto& output : contents.outputs)
+        numPoints += static_cast<juce::int64>(output.points.size());
+    timer.setItems(numPoints);
+
+    if (!ok) {
+        file.deleteFile();
+        return false;
+    }
+
+    return true;
+   #endif
+}
+
+bool BreakpointFile::read(const juce::File& file, Contents& contents) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Read breakpoint file");
+
+    auto mapped = MappedFile::open(file);
+    if (mapped == nullptr) return false;
+
+    contents.featureName = mapped->getFeatureName();
+    contents.sourceName = mapped->getSourceName();
+    contents.sampleRate = mapped->getSampleRate();
+    contents.outputs.clear();
+
+    juce::int64 numPoints = 0;
+    for (int i = 0; i < mapped->getNumOutputs(); ++i) {
+        contents.outputs.push_back({ mapped->getOutputName(i), mapped->getPoints(i) });
+        numPoints += static_cast<juce::int64>(contents.outputs.back().points.size());
+    }
+
+    timer.setItems(numPoints);
+    return true;
+}
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+
+std::unique_ptr<BreakpointFile::MappedFile> BreakpointFile::MappedFile::open(const juce::File& file) {
+   #if JUCE_BIG_ENDIAN
+    juce::ignoreUnused(file);
+    return nullptr;
+   #else
+    std::unique_ptr<MappedFile> mapped(new MappedFile());
+    mapped->map = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    if (mapped->map->getData() == nullptr || !mapped->parse())
+        return nullptr;
+
+    return mapped;
+   #endif
+}
+
+bool BreakpointFile::MappedFile::parse() {
+    const char* data = static_cast<const char*>(map->getData());
+    const size_t size = map->getSize();
+
+    if (size < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != magic || header.version != currentVersion) return false;
+
+    // Every offset is checked against the mapping before it is used
+    auto inFile = [size](juce::uint64 offset, juce::uint64 bytes) {
+        return offset <= size && bytes <= size - offset;
+    };
+
+    size_t offset = sizeof(Header);
+    if (!inFile(offset, static_cast<juce::uint64>(header.featureNameBytes) + header.sourceNameBytes))
+        return false;
+
+    featureName = juce::String::fromUTF8(data + offset, static_cast<int>(header.featureNameBytes));
+    offset += header.featureNameBytes;
+    sourceName = juce::String::fromUTF8(data + offset, static_cast<int>(header.sourceNameBytes));
+    offset += header.sourceNameBytes;
+    sampleRate = header.sampleRate;
+
+    if (!inFile(header.directoryOffset, static_cast<juce::uint64>(header.numOutputs) * sizeof(OutputEntry)))
+        return false;
+
+    std::vector<OutputEntry> directory(header.numOutputs);
+
+    if (!directory.empty())
+        std::memcpy(directory.data(), data + header.directoryOffset, directory.size() * sizeof(OutputEntry));
+
+    for (const auto& entry : directory) {
+        auto encoding = static_cast<Encoding>(entry.encoding);
+        if (encoding != Encoding::Plain && encoding != Encoding::DeltaTimes) return false;
+
+        size_t timeBytes = getTimeBytes(encoding, static_cast<size_t>(entry.numPoints));
+        if (entry.numPoints > size / sizeof(double)
+            || !inFile(entry.nameOffset, entry.nameBytes)
+            || !inFile(entry.dataOffset, timeBytes + entry.numPoints * sizeof(double))
+            || entry.dataOffset % 8 != 0)
+            return false;
+
+        MappedOutput output;
+        output.name = juce::String::fromUTF8(data + entry.nameOffset, static_cast<int>(entry.nameBytes));
+        output.numPoints = static_cast<size_t>(entry.numPoints);
+        output.encoding = encoding;
+        output.times = data + entry.dataOffset;
+        output.values = reinterpret_cast<const double*>(data + entry.dataOffset + timeBytes);
+        outputs.push_back(output);
+    }
+
+    return true;
+}
+
+juce::String BreakpointFile::MappedFile::getOutputName(int output) const {
+    return juce::isPositiveAndBelow(output, getNumOutputs()) ? outputs[output].name : juce::String();
+}
+
+size_t BreakpointFile::MappedFile::getNumPoints(int output) const {
+    return juce::isPositiveAndBelow(output, getNumOutputs()) ? outputs[output].numPoints : 0;
+}
+
+BreakpointFile::Encoding BreakpointFile::MappedFile::getEncoding(int output) const {
+    return juce::isPositiveAndBelow(output, getNumOutputs()) ? outputs[output].encoding : Encoding::Plain;
+}
+
+const double* BreakpointFile::MappedFile::getTimes(int output) const {
+    if (!juce::isPositiveAndBelow(output, getNumOutputs())) return nullptr;
+    if (outputs[output].encoding != Encoding::Plain) return nullptr;
+
+    return reinterpret_cast<const double*>(outputs[output].times);
+}
+
+const double* BreakpointFile::MappedFile::getValues(int output) const {
+    return juce::isPositiveAndBelow(output, getNumOutputs()) ? outputs[output].values : nullptr;
+}
+
+BreakpointFile::Points BreakpointFile::MappedFile::getPoints(int output) const {
+    const auto times = getTimeColumn(output);
+    const double* values = getValues(output);
+
+    Points points(times.size());
+    for (size_t i = 0; i < points.size(); ++i)
+        points[i] = { times[i], values[i] };
+
+    return points;
+}
+
+std::vector<double> BreakpointFile::MappedFile::getTimeColumn(int output) const {
+    if (!juce::isPositiveAndBelow(output, getNumOutputs())) return {};
+
+    const auto& mapped = outputs[output];
+    if (mapped.encoding == Encoding::Plain) {
+        const double* times = reinterpret_cast<const double*>(mapped.times);
+        return std::vector<double>(times, times + mapped.numPoints);
+    }
+
+    std::vector<double> times(mapped.numPoints);
+    if (mapped.numPoints == 0) return times;
+
+    double time;
+    std::memcpy(&time, mapped.times, sizeof(double));
+    const char* steps = mapped.times + sizeof(double);
+
+    times[0] = time;
+    for (size_t i = 1; i < mapped.numPoints; ++i) {
+        float step;
+        std::memcpy(&step, steps + (i - 1) * sizeof(float), sizeof(float));
+        time += step;
+        times[i] = time;
+    }
+
+    return times;
+}
+
+std::vector<double> BreakpointFile::MappedFile::getValueColumn(int output) const {
+    if (!juce::isPositiveAndBelow(output, getNumOutputs())) return {};
+
+    const auto& mapped = outputs[output];
+    return std::vector<double>(mapped.values, mapped.values + mapped.numPoints);
+}
@@ -0,0 +1,128 @@
+// ============================================================================
+// BreakpointFile.h
+// Binary columnar breakpoint files, loaded through a memory map
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+// Layout, little-endian and 8-byte aligned throughout:
+//
+//   Header        magic, version, output count, sample rate, name lengths,
+//                 directory offset
+//   Names         feature and source names, UTF-8
+//   Directory     one OutputEntry per output
+//   Output data   per output: times, then values, as contiguous columns
+//
+// Plain outputs store both columns as doubles, so a mapped file can be read
+// in place. Delta-encoded outputs store time steps as floats, each measured
+// from the previous decoded time, so rounding never accumulates along the curve.
+class BreakpointFile {
+public:
+    using Points = std::vector<std::pair<double, double>>;
+
+    enum class Encoding : juce::uint32 {
+        Plain = 0,
+        DeltaTimes = 1
+    };
+
+    struct Output {
+        juce::String name;
+        Points points;
+    };
+
+    struct Contents {
+        juce::String featureName;
+        juce::String sourceName;
+        double sampleRate = 44100.0;
+        std::vector<Output> outputs;
+    };
+
+    static constexpr const char* fileExtension = ".abp";
+
+    // Checks the magic number, not the extension
+    static bool isBinaryFile(const juce::File& file);
+
+    static bool write(const juce::File& file, const Contents& contents,
+        Encoding encoding = Encoding::Plain);
+    static bool read(const juce::File& file, Contents& contents);
+
+    // ========================================================================
+    // Mapped access
+    // Columns of plain outputs point straight into the mapped file.
+    // ========================================================================
+
+    class MappedFile {
+    public:
+        // Returns nullptr if the file isn't a valid breakpoint file
+        static std::unique_ptr<MappedFile> open(const juce::File& file);
+
+        const juce::String& getFeatureName() const { return featureName; }
+        const juce::String& getSourceName() const { return sourceName; }
+        double getSampleRate() const { return sampleRate; }
+
+        int getNumOutputs() const { return static_cast<int>(outputs.size()); }
+        juce::String getOutputName(int output) const;
+        size_t getNumPoints(int output) const;
+        Encoding getEncoding(int output) const;
+
+        // nullptr for delta-encoded outputs, which have to be decoded
+        const double* getTimes(int output) const;
+        const double* getValues(int output) const;
+
+        // Work for either encoding. The columns are copied out whole, ready to
+        // hand to BreakpointStore without going through points.
+        Points getPoints(int output) const;
+        std::vector<double> getTimeColumn(int output) const;
+        std::vector<double> getValueColumn(int output) const;
+
+    private:
+        struct MappedOutput {
+            juce::String name;
+            size_t numPoints = 0;
+            Encoding encoding = Encoding::Plain;
+            const char* times = nullptr;
+            const double* values = nullptr;
+        };
+
+        MappedFile() = default;
+        bool parse();
+
+        std::unique_ptr<juce::MemoryMappedFile> map;
+        juce::String featureName;
+        juce::String sourceName;
+        double sampleRate = 44100.0;
+        std::vector<MappedOutput> outputs;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedFile)
+    };
+
+private:
+    static constexpr juce::uint32 magic = 0x54504241;   // "ABPT"
+    static constexpr juce::uint32 currentVersion = 1;
+
+    struct Header {
+        juce::uint32 magic;
+        juce::uint32 version;
+        juce::uint32 numOutputs;
+        juce::uint32 featureNameBytes;
+        double sampleRate;
+        juce::uint32 sourceNameBytes;
+        juce::uint32 directoryOffset;
+    };
+
+    struct OutputEntry {
+        juce::uint64 numPoints;
+        juce::uint64 dataOffset;       // From the start of the file
+        juce::uint32 encoding;
+        juce::uint32 nameBytes;
+        juce::uint64 nameOffset;
+    };
+
+    static_assert(sizeof(Header) == 32, "Header layout is part of the file format");
+    static_assert(sizeof(OutputEntry) == 32, "OutputEntry layout is part of the file format");
+
+    static size_t align(size_t offset) { return (offset + 7) & ~static_cast<size_t>(7); }
+    static size_t getTimeBytes(Encoding encoding, size_t numPoints);
+};
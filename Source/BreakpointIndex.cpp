@@ -0,0 +1,107 @@
+// ============================================================================
+// BreakpointIndex.cpp
+// ============================================================================
+#include "BreakpointIndex.h"
+#include <algorithm>
+#include <limits>
+
+void BreakpointIndex::build(const BreakpointStore::View& newView) {
+    view = newView;
+    numPoints = view.size();
+    levels.clear();
+
+    size_t count = view.size();
+    while (count > 1) {
+        count = (count + 1) / 2;
+
+        Level level;
+        level.mins.resize(count);
+        level.maxs.resize(count);
+        levels.push_back(std::move(level));
+
+        for (size_t i = 0; i < count; ++i)
+            computeEntry(levels.size() - 1, i);
+    }
+}
+
+void BreakpointIndex::clear() {
+    view = {};
+    numPoints = 0;
+    levels.clear();
+}
+
+void BreakpointIndex::computeEntry(size_t level, size_t index) {
+    size_t first = index * 2;
+    size_t second = first + 1;
+    auto& entry = levels[level];
+
+    if (level == 0) {
+        const double* values = view.getValues();
+        bool hasSecond = second < view.size();
+
+        entry.mins[index] = hasSecond ? juce::jmin(values[first], values[second]) : values[first];
+        entry.maxs[index] = hasSecond ? juce::jmax(values[first], values[second]) : values[first];
+    }
+    else {
+        const auto& below = levels[level - 1];
+        bool hasSecond = second < below.mins.size();
+
+        entry.mins[index] = hasSecond ? juce::jmin(below.mins[first], below.mins[second]) : below.mins[first];
+        entry.maxs[index] = hasSecond ? juce::jmax(below.maxs[first], below.maxs[second]) : below.maxs[first];
+    }
+}
+
+void BreakpointIndex::update(const BreakpointStore::View& newView, size_t first, size_t last) {
+    if (newView.size() != numPoints || numPoints == 0) {
+        build(newView);
+        return;
+    }
+
+    view = newView;
+    last = juce::jmin(last, numPoints - 1);
+
+    for (size_t level = 0; level < levels.size() && first <= last; ++level) {
+        first /= 2;
+        last /= 2;
+
+        for (size_t i = first; i <= last; ++i)
+            computeEntry(level, i);
+    }
+}
+
+juce::Range<size_t> BreakpointIndex::getIndexRange(double startTime, double endTime) const {
+    size_t begin = view.lowerBound(startTime);
+    size_t end = juce::jmax(begin, view.lowerBound(endTime));
+    return { begin, end };
+}
+
+bool BreakpointIndex::getValueRange(size_t begin, size_t end, double& minValue, double& maxValue) const {
+    end = juce::jmin(end, view.size());
+    if (begin >= end) return false;
+
+    const double* values = view.getValues();
+    minValue = std::numeric_limits<double>::max();
+    maxValue = std::numeric_limits<double>::lowest();
+
+    // Bottom-up: peel off unpaired ends at each level, then step up a level
+    auto take = [&](double low, double high) {
+        minValue = juce::jmin(minValue, low);
+        maxValue = juce::jmax(maxValue, high);
+    };
+
+    if (begin & 1) { take(values[begin], values[begin]); ++begin; }
+    if (end & 1 && begin < end) { --end; take(values[end], values[end]); }
+    begin /= 2;
+    end /= 2;
+
+    for (size_t level = 0; begin < end; ++level) {
+        const auto& entry = levels[level];
+
+        if (begin & 1) { take(entry.mins[begin], entry.maxs[begin]); ++begin; }
+        if (end & 1 && begin < end) { --end; take(entry.mins[end], entry.maxs[end]); }
+        begin /= 2;
+        end /= 2;
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+// ============================================================================
+// BreakpointIndex.h
+// Range min/max over a breakpoint view, for drawing and hit-testing
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "BreakpointStore.h"
+#include <vector>
+
+// Points are already sorted by time, so a time range maps to an index range by
+// binary search. Above them sits a pyramid of value minima and maxima over
+// blocks of 2, 4, 8... points, which answers the value span of any index range
+// in O(log n). A pixel column holding thousands of points costs the same as one
+// holding two.
+class BreakpointIndex {
+public:
+    void build(const BreakpointStore::View& view);
+    void clear();
+
+    // Lets go of the shared columns so they can be edited in place, keeping the
+    // pyramid for update(). Nothing may be queried until update() or build().
+    void releaseView() { view = {}; }
+
+    // Refreshes the pyramid after the points in [first, last] changed value or
+    // order without the count changing, e.g. a dragged point passing its neighbours
+    void update(const BreakpointStore::View& view, size_t first, size_t last);
+
+    size_t size() const { return numPoints; }
+
+    // Indices of the points with startTime <= time < endTime
+    juce::Range<size_t> getIndexRange(double startTime, double endTime) const;
+
+    // Lowest and highest value among points [begin, end). False if the range is empty.
+    bool getValueRange(size_t begin, size_t end, double& minValue, double& maxValue) const;
+
+private:
+    BreakpointStore::View view;
+    size_t numPoints = 0;
+
+    // levels[k] covers blocks of 2^(k + 1) points; level "-1" is the values themselves
+    struct Level {
+        std::vector<double> mins;
+        std::vector<double> maxs;
+    };
+    std::vector<Level> levels;
+
+    void computeEntry(size_t level, size_t index);
+};
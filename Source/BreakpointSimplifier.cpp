@@ -0,0 +1,245 @@
+// ============================================================================
+// BreakpointSimplifier.cpp
+// ============================================================================
+#include "BreakpointSimplifier.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace {
+    using Points = BreakpointSimplifier::Points;
+
+    struct Span {
+        size_t first;
+        size_t last;
+        size_t worst;      // Interior point furthest from the chord
+        double error;
+
+        bool operator<(const Span& other) const { return error < other.error; }
+    };
+
+    // Against a chord of slope s through (t1, v1), point i is off by
+    // (v_i - s t_i) - (v1 - s t1), so the worst interior point is whichever
+    // maximises or minimises v - s t. Those are vertices of the span's upper
+    // and lower convex hulls, so a tree of hulls over ranges of points finds
+    // them in O(log^2 n) for any span.
+    class HullTree {
+    public:
+        explicit HullTree(const Points& source) : points(source) {
+            jassert(points.size() <= std::numeric_limits<std::uint32_t>::max());
+            nodes.reserve(2 * (points.size() / leafPoints + 1));
+            build(0, points.size());
+        }
+
+        Span measure(size_t first, size_t last) const {
+            Span span{ first, last, first, 0.0 };
+            if (last - first < 2) return span;
+
+            const double t1 = points[first].first;
+            const double v1 = points[first].second;
+            const double dt = points[last].first - t1;
+            const double slope = dt > 0.0 ? (points[last].second - v1) / dt : 0.0;
+
+            Extreme highest{ -std::numeric_limits<double>::infinity(), first };
+            Extreme lowest{ std::numeric_limits<double>::infinity(), first };
+            search(0, first + 1, last, slope, highest, lowest);
+
+            // Measured as the curve is rendered, so the error matches a plain scan
+            for (size_t i : { highest.index, lowest.index }) {
+                double error = std::abs(points[i].second - (v1 + (points[i].first - t1) * slope));
+                if (error > span.error) {
+                    span.error = error;
+                    span.worst = i;
+                }
+            }
+
+            return span;
+        }
+
+    private:
+        // Ranges this small are scanned rather than given hulls
+        static constexpr size_t leafPoints = 32;
+
+        struct Node {
+            size_t begin;
+            size_t end;
+            int left = -1;
+            int right = -1;
+            size_t upperBegin = 0, upperEnd = 0;   // Ranges of upperHulls and lowerHulls
+            size_t lowerBegin = 0, lowerEnd = 0;
+
+            bool isLeaf() const { return left < 0; }
+        };
+
+        struct Extreme {
+            double value;
+            size_t index;
+        };
+
+        const Points& points;
+        std::vector<Node> nodes;
+        std::vector<std::uint32_t> upperHulls;   // 32-bit to halve the hull storage
+        std::vector<std::uint32_t> lowerHulls;
+        std::vector<std::uint32_t> candidates;
+
+        double project(size_t i, double slope) const { return points[i].second - slope * points[i].first; }
+
+        double cross(size_t o, size_t a, size_t b) const {
+            return (points[a].first - points[o].first) * (points[b].second - points[o].second)
+                - (points[a].second - points[o].second) * (points[b].first - points[o].first);
+        }
+
+        int build(size_t begin, size_t end) {
+            const int id = static_cast<int>(nodes.size());
+            nodes.push_back({ begin, end });
+            if (end - begin <= leafPoints) return id;
+
+            const size_t mid = begin + (end - begin) / 2;
+            const int left = build(begin, mid);
+            const int right = build(mid, end);
+            nodes[static_cast<size_t>(id)].left = left;
+            nodes[static_cast<size_t>(id)].right = right;
+
+            // A node's hull vertices are among its children's, already in time order
+            auto& node = nodes[static_cast<size_t>(id)];
+            std::tie(node.upperBegin, node.upperEnd) = buildHull(upperHulls, left, right, true);
+            std::tie(node.lowerBegin, node.lowerEnd) = buildHull(lowerHulls, left, right, false);
+            return id;
+        }
+
+        std::pair<size_t, size_t> buildHull(std::vector<std::uint32_t>& hulls, int left, int right, bool upper) {
+            candidates.clear();
+            for (int child : { left, right }) {
+                const auto& node = nodes[static_cast<size_t>(child)];
+                if (node.isLeaf()) {
+                    for (size_t i = node.begin; i < node.end; ++i)
+                        candidates.push_back(static_cast<std::uint32_t>(i));
+                }
+                else {
+                    const size_t from = upper ? node.upperBegin : node.lowerBegin;
+                    const size_t to = upper ? node.upperEnd : node.lowerEnd;
+                    candidates.insert(candidates.end(), hulls.begin() + static_cast<std::ptrdiff_t>(from),
+                        hulls.begin() + static_cast<std::ptrdiff_t>(to));
+                }
+            }
+
+            // Monotone chain: the upper hull only turns clockwise, the lower only anticlockwise.
+            // Of points sharing a time only the highest (lowest) can be an extreme.
+            const size_t start = hulls.size();
+            for (auto c : candidates) {
+                if (hulls.size() > start && points[hulls.back()].first == points[c].first) {
+                    const bool beyond = upper ? points[c].second > points[hulls.back()].second
+                        : points[c].second < points[hulls.back()].second;
+                    if (!beyond) continue;
+                    hulls.pop_back();
+                }
+
+                while (hulls.size() - start >= 2) {
+                    double turn = cross(hulls[hulls.size() - 2], hulls.back(), c);
+                    if (upper ? turn < 0.0 : turn > 0.0) break;
+                    hulls.pop_back();
+                }
+                hulls.push_back(c);
+            }
+
+            return { start, hulls.size() };
+        }
+
+        // v - s t is unimodal along a hull, so its extreme is found by bisection
+        template <typename Better>
+        size_t findExtreme(const std::vector<std::uint32_t>& hulls, size_t from, size_t to,
+            double slope, Better better) const {
+            size_t lo = from, hi = to - 1;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (better(project(hulls[mid + 1], slope), project(hulls[mid], slope))) lo = mid + 1;
+                else hi = mid;
+            }
+            return hulls[lo];
+        }
+
+        void consider(size_t i, double slope, Extreme& highest, Extreme& lowest) const {
+            const double value = project(i, slope);
+            if (value > highest.value) highest = { value, i };
+            if (value < lowest.value) lowest = { value, i };
+        }
+
+        void search(int id, size_t begin, size_t end, double slope, Extreme& highest, Extreme& lowest) const {
+            const auto& node = nodes[static_cast<size_t>(id)];
+            if (node.end <= begin || end <= node.begin) return;
+
+            if (node.isLeaf()) {
+                for (size_t i = std::max(begin, node.begin); i < std::min(end, node.end); ++i)
+                    consider(i, slope, highest, lowest);
+                return;
+            }
+
+            if (begin <= node.begin && node.end <= end) {
+                consider(findExtreme(upperHulls, node.upperBegin, node.upperEnd, slope, std::greater<double>()),
+                    slope, highest, lowest);
+                consider(findExtreme(lowerHulls, node.lowerBegin, node.lowerEnd, slope, std::less<double>()),
+                    slope, highest, lowest);
+                return;
+            }
+
+            search(node.left, begin, end, slope, highest, lowest);
+            search(node.right, begin, end, slope, highest, lowest);
+        }
+    };
+}
+
+BreakpointSimplifier::Points BreakpointSimplifier::simplify(const Points& points, double tolerance) {
+    return refine(points, juce::jmax(0.0, tolerance), points.size());
+}
+
+BreakpointSimplifier::Points BreakpointSimplifier::simplifyToCount(const Points& points, size_t maxPoints) {
+    return refine(points, 0.0, juce::jmax<size_t>(2, maxPoints));
+}
+
+double BreakpointSimplifier::getTolerance(const Points& points, double relativeTolerance) {
+    if (points.empty()) return 0.0;
+
+    auto [lowest, highest] = std::minmax_element(points.begin(), points.end(),
+        [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    return (highest->second - lowest->second) * relativeTolerance;
+}
+
+BreakpointSimplifier::Points BreakpointSimplifier::refine(const Points& points, double tolerance,
+    size_t maxPoints) {
+    if (points.size() <= 2) return points;
+
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = keep.back() = true;
+    size_t kept = 2;
+
+    const HullTree tree(points);
+
+    std::priority_queue<Span> spans;
+    spans.push(tree.measure(0, points.size() - 1));
+
+    while (!spans.empty() && kept < maxPoints) {
+        Span span = spans.top();
+        spans.pop();
+
+        if (span.error <= tolerance) break;
+
+        keep[span.worst] = true;
+        ++kept;
+
+        if (span.worst - span.first > 1) spans.push(tree.measure(span.first, span.worst));
+        if (span.last - span.worst > 1) spans.push(tree.measure(span.worst, span.last));
+    }
+
+    Points result;
+    result.reserve(kept);
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keep[i]) result.push_back(points[i]);
+    }
+
+    return result;
+}
@@ -0,0 +1,35 @@
+// ============================================================================
+// BreakpointSimplifier.h
+// Error-bounded point reduction for breakpoint curves
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+// Ramer-Douglas-Peucker over time-sorted breakpoints, measuring error as the
+// vertical distance from the linear interpolation, which is how the curve is
+// actually rendered. The worst-fitting span is always split first, so peaks and
+// transients survive while flat or straight runs collapse to their end points.
+//
+// Spans are measured against a tree of convex hulls over the points rather
+// than scanned, so a curve that only gives up one point per split, such as a
+// monotone convex one, costs O(n log^2 n) instead of O(n^2). Building the tree
+// is O(n log n); its hulls take O(n log n) indices at worst, and far fewer for
+// noisy curves, whose hulls are small.
+class BreakpointSimplifier {
+public:
+    using Points = std::vector<std::pair<double, double>>;
+
+    // Drops every point the remaining curve reproduces to within tolerance
+    static Points simplify(const Points& points, double tolerance);
+
+    // Keeps at most maxPoints, spending them where the curve deviates most
+    static Points simplifyToCount(const Points& points, size_t maxPoints);
+
+    // relativeTolerance is a fraction of the curve's own value span, so one
+    // setting suits amplitudes, frequencies and pan positions alike
+    static double getTolerance(const Points& points, double relativeTolerance);
+
+private:
+    static Points refine(const Points& points, double tolerance, size_t maxPoints);
+};
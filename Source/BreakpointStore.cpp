@@ -0,0 +1,228 @@
+// ============================================================================
+// BreakpointStore.cpp
+// ============================================================================
+#include "BreakpointStore.h"
+#include <algorithm>
+
+// ============================================================================
+// View
+// ============================================================================
+
+size_t BreakpointStore::View::lowerBound(double time) const {
+    if (columns == nullptr) return 0;
+
+    const auto& times = columns->times;
+    return static_cast<size_t>(std::distance(times.begin(),
+        std::lower_bound(times.begin(), times.end(), time)));
+}
+
+BreakpointStore::Points BreakpointStore::View::toPoints() const {
+    Points points(size());
+
+    for (size_t i = 0; i < points.size(); ++i)
+        points[i] = { columns->times[i], columns->values[i] };
+
+    return points;
+}
+
+// ============================================================================
+// Features
+// ============================================================================
+
+BreakpointStore::FeatureId BreakpointStore::findFeature(const juce::String& name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : invalidId;
+}
+
+BreakpointStore::FeatureId BreakpointStore::addFeature(const juce::String& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    FeatureId id = static_cast<FeatureId>(features.size());
+    features.push_back({ name, {} });
+    ids[name] = id;
+    return id;
+}
+
+juce::String BreakpointStore::getFeatureName(FeatureId id) const {
+    auto* feature = getFeature(id);
+    return feature != nullptr ? feature->name : juce::String();
+}
+
+juce::StringArray BreakpointStore::getFeatureNames() const {
+    juce::StringArray names;
+    for (const auto& [name, _] : ids) {
+        names.add(name);
+    }
+    return names;
+}
+
+void BreakpointStore::clear() {
+    features.clear();
+    ids.clear();
+}
+
+const BreakpointStore::Feature* BreakpointStore::getFeature(FeatureId id) const {
+    return juce::isPositiveAndBelow(id, static_cast<int>(features.size())) ? &features[id] : nullptr;
+}
+
+// ============================================================================
+// Outputs
+// ============================================================================
+
+int BreakpointStore::getNumOutputs(FeatureId id) const {
+    auto* feature = getFeature(id);
+    return feature != nullptr ? static_cast<int>(feature->outputs.size()) : 0;
+}
+
+size_t BreakpointStore::getNumPoints(FeatureId id, int output) const {
+    auto* columns = getColumns(id, output);
+    return columns != nullptr ? columns->times.size() : 0;
+}
+
+std::shared_ptr<BreakpointStore::Columns> BreakpointStore::makeColumns(const Points& points) {
+    auto columns = std::make_shared<Columns>();
+    columns->times.resize(points.size());
+    columns->values.resize(points.size());
+
+    auto write = [&](const Points& source) {
+        for (size_t i = 0; i < source.size(); ++i) {
+            columns->times[i] = source[i].first;
+            columns->values[i] = source[i].second;
+        }
+    };
+
+    auto byTime = [](const auto& a, const auto& b) { return a.first < b.first; };
+
+    if (std::is_sorted(points.begin(), points.end(), byTime)) {
+        write(points);
+    }
+    else {
+        Points sorted(points);
+        std::stable_sort(sorted.begin(), sorted.end(), byTime);
+        write(sorted);
+    }
+
+    return columns;
+}
+
+void BreakpointStore::setOutputs(FeatureId id, std::vector<Points>&& outputs) {
+    if (getFeature(id) == nullptr) return;
+
+    auto& feature = features[id];
+    feature.outputs.clear();
+
+    for (const auto& points : outputs)
+        feature.outputs.push_back(makeColumns(points));
+
+    outputs.clear();
+}
+
+void BreakpointStore::setOutputColumns(FeatureId id, std::vector<Columns>&& outputs) {
+    if (getFeature(id) == nullptr) return;
+
+    auto& feature = features[id];
+    feature.outputs.clear();
+
+    for (auto& columns : outputs) {
+        jassert(columns.times.size() == columns.values.size());
+        columns.values.resize(columns.times.size());
+
+        if (!std::is_sorted(columns.times.begin(), columns.times.end())) {
+            Points points(columns.times.size());
+            for (size_t i = 0; i < points.size(); ++i)
+                points[i] = { columns.times[i], columns.values[i] };
+
+            feature.outputs.push_back(makeColumns(points));
+            continue;
+        }
+
+        feature.outputs.push_back(std::make_shared<Columns>(std::move(columns)));
+    }
+
+    outputs.clear();
+}
+
+void BreakpointStore::setOutput(FeatureId id, int output, const Points& points) {
+    if (getFeature(id) == nullptr || output < 0) return;
+
+    auto& outputs = features[id].outputs;
+    while (static_cast<int>(outputs.size()) <= output)
+        outputs.push_back(std::make_shared<Columns>());
+
+    outputs[output] = makeColumns(points);
+}
+
+const BreakpointStore::Columns* BreakpointStore::getColumns(FeatureId id, int output) const {
+    auto* feature = getFeature(id);
+    if (feature == nullptr || !juce::isPositiveAndBelow(output, static_cast<int>(feature->outputs.size())))
+        return nullptr;
+
+    return feature->outputs[output].get();
+}
+
+BreakpointStore::Columns* BreakpointStore::getWritableColumns(FeatureId id, int output) {
+    if (getColumns(id, output) == nullptr) return nullptr;
+
+    auto& columns = features[id].outputs[output];
+    if (columns.use_count() > 1)
+        columns = std::make_shared<Columns>(*columns);
+
+    return columns.get();
+}
+
+BreakpointStore::View BreakpointStore::getView(FeatureId id, int output) const {
+    if (getColumns(id, output) == nullptr) return {};
+    return View(features[id].outputs[output]);
+}
+
+BreakpointStore::Points BreakpointStore::getPoints(FeatureId id, int output) const {
+    return getView(id, output).toPoints();
+}
+
+int BreakpointStore::insertPoint(FeatureId id, int output, double time, double value) {
+    auto* columns = getWritableColumns(id, output);
+    if (columns == nullptr) return -1;
+
+    // After any points already at this time
+    auto position = std::upper_bound(columns->times.begin(), columns->times.end(), time);
+    auto index = std::distance(columns->times.begin(), position);
+
+    columns->times.insert(position, time);
+    columns->values.insert(columns->values.begin() + index, value);
+    return static_cast<int>(index);
+}
+
+int BreakpointStore::movePoint(FeatureId id, int output, size_t index, double time, double value) {
+    auto* columns = getWritableColumns(id, output);
+    if (columns == nullptr || index >= columns->times.size()) return -1;
+
+    auto& times = columns->times;
+    auto& values = columns->values;
+    times[index] = time;
+    values[index] = value;
+
+    // A drag only moves past its neighbours, so walking is cheaper than searching
+    while (index > 0 && times[index - 1] > time) {
+        std::swap(times[index - 1], times[index]);
+        std::swap(values[index - 1], values[index]);
+        --index;
+    }
+
+    while (index + 1 < times.size() && times[index + 1] < time) {
+        std::swap(times[index + 1], times[index]);
+        std::swap(values[index + 1], values[index]);
+        ++index;
+    }
+
+    return static_cast<int>(index);
+}
+
+bool BreakpointStore::removePoint(FeatureId id, int output, size_t index) {
+    auto* columns = getWritableColumns(id, output);
+    if (columns == nullptr || index >= columns->times.size()) return false;
+
+    columns->times.erase(columns->times.begin() + static_cast<std::ptrdiff_t>(index));
+    columns->values.erase(columns->values.begin() + static_cast<std::ptrdiff_t>(index));
+    return true;
+}
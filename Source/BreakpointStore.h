@@ -0,0 +1,139 @@
+// ============================================================================
+// BreakpointStore.h
+// Column storage for extracted breakpoint curves
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Features are looked up by name once and then addressed by id. Each output keeps
+// its times and values in separate sorted columns, shared with any views taken of
+// it: an edit copies the columns only while a view is still holding them, so
+// release views before editing to edit in place.
+class BreakpointStore {
+public:
+    using Points = std::vector<std::pair<double, double>>;
+    using FeatureId = int;
+
+    static constexpr FeatureId invalidId = -1;
+
+    struct Point {
+        double time;
+        double value;
+    };
+
+    struct Columns {
+        std::vector<double> times;
+        std::vector<double> values;
+    };
+
+    // ========================================================================
+    // Read-only view of one output
+    // Keeps its columns alive, so it stays valid however the store changes.
+    // ========================================================================
+
+    class View {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Point;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Point*;
+            using reference = Point;
+
+            Point operator*() const { return { columns->times[index], columns->values[index] }; }
+            Iterator& operator++() { ++index; return *this; }
+            bool operator==(const Iterator& other) const { return index == other.index; }
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        private:
+            friend class View;
+            Iterator(const Columns* columns, size_t index) : columns(columns), index(index) {}
+
+            const Columns* columns;
+            size_t index;
+        };
+
+        View() = default;
+
+        size_t size() const { return columns != nullptr ? columns->times.size() : 0; }
+        bool empty() const { return size() == 0; }
+
+        const double* getTimes() const { return columns != nullptr ? columns->times.data() : nullptr; }
+        const double* getValues() const { return columns != nullptr ? columns->values.data() : nullptr; }
+
+        Point operator[](size_t index) const { return { columns->times[index], columns->values[index] }; }
+
+        Iterator begin() const { return Iterator(columns.get(), 0); }
+        Iterator end() const { return Iterator(columns.get(), size()); }
+
+        // Index of the first point at or after time
+        size_t lowerBound(double time) const;
+
+        Points toPoints() const;
+
+    private:
+        friend class BreakpointStore;
+        explicit View(std::shared_ptr<const Columns> columns) : columns(std::move(columns)) {}
+
+        std::shared_ptr<const Columns> columns;
+    };
+
+    // ========================================================================
+    // Features
+    // ========================================================================
+
+    FeatureId findFeature(const juce::String& name) const;
+    FeatureId addFeature(const juce::String& name);   // Existing id if already present
+    juce::String getFeatureName(FeatureId id) const;
+
+    // In name order, like the map this replaced
+    juce::StringArray getFeatureNames() const;
+
+    bool isEmpty() const { return ids.empty(); }
+    void clear();
+
+    // ========================================================================
+    // Outputs
+    // ========================================================================
+
+    int getNumOutputs(FeatureId id) const;
+    size_t getNumPoints(FeatureId id, int output) const;
+
+    // Replaces every output of the feature. Unsorted input is sorted once here.
+    void setOutputs(FeatureId id, std::vector<Points>&& outputs);
+    void setOutput(FeatureId id, int output, const Points& points);
+
+    // The same, taking the columns as they are, such as from a mapped file
+    void setOutputColumns(FeatureId id, std::vector<Columns>&& outputs);
+
+    View getView(FeatureId id, int output) const;
+    Points getPoints(FeatureId id, int output) const;
+
+    // Point edits keep the columns sorted without re-sorting them. Each returns
+    // the point's index afterwards, or -1 if the output doesn't exist.
+    int insertPoint(FeatureId id, int output, double time, double value);
+    int movePoint(FeatureId id, int output, size_t index, double time, double value);
+    bool removePoint(FeatureId id, int output, size_t index);
+
+private:
+    struct Feature {
+        juce::String name;
+        std::vector<std::shared_ptr<Columns>> outputs;
+    };
+
+    std::vector<Feature> features;
+    std::map<juce::String, FeatureId> ids;
+
+    const Feature* getFeature(FeatureId id) const;
+    const Columns* getColumns(FeatureId id, int output) const;
+
+    // Copies the columns first if a view still shares them
+    Columns* getWritableColumns(FeatureId id, int output);
+
+    static std::shared_ptr<Columns> makeColumns(const Points& points);
+};
@@ -0,0 +1,127 @@
+// ============================================================================
+// EditHistory.cpp
+// ============================================================================
+#include "EditHistory.h"
+#include <algorithm>
+#include <set>
+
+EditHistory::EditHistory(Replayer replay)
+    : replay(std::move(replay)) {
+    reset(EditList());
+}
+
+void EditHistory::reset(const EditList& initial) {
+    entries.clear();
+    entries.push_back({ {}, std::make_shared<const EditList>(initial), true });
+    position = 0;
+    updateMemoryUsage();
+}
+
+void EditHistory::push(const Step& step, const EditList& result, bool replayable) {
+    // A new step replaces whatever could have been redone
+    entries.resize(position + 1);
+
+    Entry entry{ step, nullptr, replayable };
+    const size_t stepsSinceCheckpoint = position + 1 - findCheckpointAtOrBefore(position);
+
+    if (!replayable || stepsSinceCheckpoint >= static_cast<size_t>(checkpointInterval))
+        entry.checkpoint = std::make_shared<const EditList>(result);
+
+    entries.push_back(std::move(entry));
+    ++position;
+
+    updateMemoryUsage();
+    enforceMemoryLimit();
+}
+
+bool EditHistory::undo(EditList& state) {
+    if (!canUndo()) return false;
+
+    EditList previous;
+    if (!getStateAt(position - 1, previous)) return false;
+
+    state = std::move(previous);
+    --position;
+    return true;
+}
+
+bool EditHistory::redo(EditList& state) {
+    if (!canRedo()) return false;
+
+    const auto& next = entries[position + 1];
+
+    // Without a snapshot, the step is replayed on top of the current arrangement
+    EditList redone = next.checkpoint != nullptr ? *next.checkpoint : state;
+    if (next.checkpoint == nullptr && !replay(redone, next.step)) return false;
+
+    state = std::move(redone);
+    ++position;
+    return true;
+}
+
+void EditHistory::setMemoryLimit(size_t bytes) {
+    memoryLimit = bytes;
+    enforceMemoryLimit();
+}
+
+bool EditHistory::getStateAt(size_t index, EditList& state) const {
+    const size_t checkpoint = findCheckpointAtOrBefore(index);
+    EditList rebuilt = *entries[checkpoint].checkpoint;
+
+    for (size_t i = checkpoint + 1; i <= index; ++i) {
+        if (!replay(rebuilt, entries[i].step)) return false;
+    }
+
+    state = std::move(rebuilt);
+    return true;
+}
+
+size_t EditHistory::findCheckpointAtOrBefore(size_t index) const {
+    while (index > 0 && entries[index].checkpoint == nullptr)
+        --index;
+    return index;
+}
+
+void EditHistory::updateMemoryUsage() {
+    // Audio a snapshot owns is counted once however many snapshots share it
+    std::set<const EditList::Source*> counted;
+    memoryUsage = 0;
+
+    for (const auto& entry : entries) {
+        memoryUsage += sizeof(Entry) + entry.step.params.capacity() * sizeof(double);
+        if (entry.checkpoint == nullptr) continue;
+
+        memoryUsage += entry.checkpoint->getMetadataBytes();
+        for (const auto& slice : entry.checkpoint->getSlices()) {
+            if (counted.insert(slice.source.get()).second)
+                memoryUsage += slice.source->getOwnedBytes();
+        }
+    }
+}
+
+void EditHistory::enforceMemoryLimit() {
+    while (memoryUsage > memoryLimit) {
+        // Cheapest first: drop the oldest snapshot that can be rebuilt, which
+        // only makes undoing past it replay more steps
+        auto snapshot = std::find_if(entries.begin() + 1, entries.end(),
+            [](const Entry& entry) { return entry.checkpoint != nullptr && entry.replayable; });
+
+        if (snapshot != entries.end()) {
+            snapshot->checkpoint.reset();
+        }
+        else {
+            // Only snapshots that have to stay are left, so forget the oldest
+            // step. The arrangement after it becomes the new starting point.
+            if (position == 0) break;
+
+            EditList rebased;
+            if (!getStateAt(1, rebased)) break;
+
+            entries[1].checkpoint = std::make_shared<const EditList>(std::move(rebased));
+            entries.erase(entries.begin());
+            --position;
+        }
+
+        updateMemoryUsage();
+    }
+}
@@ -0,0 +1,105 @@
+// ============================================================================
+// EditHistory.h
+// Undo/redo of edit operations within a fixed memory budget
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "EditList.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+enum class EditOperation {
+    None,
+    Trim,
+    Cut,
+    Split,
+    Nudge,
+    TimeStretch,
+    Quantize,
+    Humanize,
+    DetectBeats,
+    SnapToGrid,
+    Crossfade,
+    RemoveSilence,     // NEW: Use amplitude analysis
+    IsolateTransients, // NEW: Use transient detection
+    SplitByBeats      // NEW: Use beat detection
+};
+
+class EditHistory {
+public:
+    struct Step {
+        EditOperation operation = EditOperation::None;
+        std::vector<double> params;
+    };
+
+    // Re-applies a step to edits. Replay has to give the same result the step
+    // gave when it was first performed; returns false if it couldn't.
+    using Replayer = std::function<bool(EditList& edits, const Step& step)>;
+
+    explicit EditHistory(Replayer replay);
+
+    // Forgets every step and starts again from initial
+    void reset(const EditList& initial);
+
+    // Records a step that turned the current arrangement into result, dropping
+    // anything that could have been redone. Steps that can't be replayed
+    // exactly, such as ones that analyse audio with settings that may change
+    // later, keep a snapshot for as long as they stay in the history.
+    void push(const Step& step, const EditList& result, bool replayable = true);
+
+    bool canUndo() const { return position > 0; }
+    bool canRedo() const { return position + 1 < entries.size(); }
+
+    // state is the current arrangement on the way in and the undone or redone
+    // one on the way out. Both return false, leaving state alone, if there was
+    // nothing to do or replay failed.
+    bool undo(EditList& state);
+    bool redo(EditList& state);
+
+    // Steps that can currently be undone
+    int getNumUndoSteps() const { return static_cast<int>(position); }
+
+    // ========================================================================
+    // Memory
+    // ========================================================================
+    // Only some steps keep a snapshot of the arrangement they produced; the
+    // rest are rebuilt by replaying from the nearest earlier snapshot. Once
+    // the snapshots pass the limit the oldest replayable ones are dropped,
+    // then the oldest steps, so deep histories stay within the budget and
+    // only get slower to walk back through.
+
+    void setMemoryLimit(size_t bytes);
+    size_t getMemoryLimit() const { return memoryLimit; }
+    size_t getMemoryUsage() const { return memoryUsage; }
+
+    // A snapshot is taken at least every this many steps
+    void setCheckpointInterval(int steps) { checkpointInterval = juce::jmax(1, steps); }
+
+private:
+    struct Entry {
+        Step step;                                     // Unused for the first entry
+        std::shared_ptr<const EditList> checkpoint;    // Always set for the first entry
+        bool replayable = true;
+    };
+
+    static constexpr size_t defaultMemoryLimit = size_t(64) << 20;
+    static constexpr int defaultCheckpointInterval = 16;
+
+    Replayer replay;
+    std::vector<Entry> entries;
+    size_t position = 0;   // Entry whose arrangement is current
+
+    size_t memoryLimit = defaultMemoryLimit;
+    size_t memoryUsage = 0;
+    int checkpointInterval = defaultCheckpointInterval;
+
+    // Rebuilds the arrangement after entries[index]
+    bool getStateAt(size_t index, EditList& state) const;
+    size_t findCheckpointAtOrBefore(size_t index) const;
+
+    void updateMemoryUsage();
+    void enforceMemoryLimit();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditHistory)
+};
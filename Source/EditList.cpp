@@ -0,0 +1,277 @@
+// ============================================================================
+// EditList.cpp
+// ============================================================================
+#include "EditList.h"
+#include <algorithm>
+#include <limits>
+
+// ============================================================================
+// Source
+// ============================================================================
+
+EditList::Source::Source(const juce::AudioBuffer<float>& buffer)
+    : buffer(&buffer) {
+}
+
+EditList::Source::Source(juce::AudioBuffer<float>&& buffer)
+    : ownedBuffer(std::move(buffer)) {
+    this->buffer = &ownedBuffer;
+}
+
+EditList::Source::Source(StreamingAudioFile& stream)
+    : stream(&stream) {
+}
+
+int EditList::Source::getNumChannels() const {
+    return stream != nullptr ? stream->getNumChannels() : buffer->getNumChannels();
+}
+
+juce::int64 EditList::Source::getLengthInSamples() const {
+    return stream != nullptr ? stream->getLengthInSamples() : buffer->getNumSamples();
+}
+
+size_t EditList::Source::getOwnedBytes() const {
+    return static_cast<size_t>(ownedBuffer.getNumChannels()) * static_cast<size_t>(ownedBuffer.getNumSamples())
+        * sizeof(float);
+}
+
+bool EditList::Source::addTo(juce::AudioBuffer<float>& dest, int destStart,
+    juce::int64 sourceStart, int numSamples, float gain) const {
+
+    const int channels = juce::jmin(dest.getNumChannels(), getNumChannels());
+
+    if (stream != nullptr) {
+        juce::AudioBuffer<float> block;
+        if (!stream->read(block, sourceStart, numSamples)) return false;
+
+        for (int ch = 0; ch < channels; ++ch)
+            dest.addFrom(ch, destStart, block, ch, 0, numSamples, gain);
+        return true;
+    }
+
+    for (int ch = 0; ch < channels; ++ch)
+        dest.addFrom(ch, destStart, *buffer, ch, static_cast<int>(sourceStart), numSamples, gain);
+    return true;
+}
+
+// ============================================================================
+// EditList
+// ============================================================================
+
+EditList::EditList(std::shared_ptr<const Source> source) {
+    if (source == nullptr) return;
+
+    numChannels = source->getNumChannels();
+    const juce::int64 sourceLength = source->getLengthInSamples();
+
+    std::vector<Slice> whole;
+    if (sourceLength > 0)
+        whole.push_back({ std::move(source), 0, sourceLength, 0, 1.0f });
+
+    setSlices(std::move(whole), sourceLength);
+}
+
+const juce::AudioBuffer<float>* EditList::getContiguousBuffer() const {
+    return isUnedited() ? slices.front().source->getBuffer() : nullptr;
+}
+
+bool EditList::isUnedited() const {
+    if (slices.size() != 1) return false;
+
+    const auto& slice = slices.front();
+    return slice.position == 0 && slice.sourceStart == 0 && slice.gain == 1.0f
+        && slice.length == length && length == slice.source->getLengthInSamples();
+}
+
+void EditList::trim(juce::int64 start, juce::int64 end) {
+    start = juce::jlimit<juce::int64>(0, length, start);
+    end = juce::jlimit<juce::int64>(start, length, end);
+
+    setSlices(getRange(start, end), end - start);
+}
+
+void EditList::cut(juce::int64 start, juce::int64 end) {
+    start = juce::jlimit<juce::int64>(0, length, start);
+    end = juce::jlimit<juce::int64>(start, length, end);
+
+    auto kept = getRange(0, start);
+    for (auto slice : getRange(end, length)) {
+        slice.position += start;
+        kept.push_back(std::move(slice));
+    }
+
+    // Overlapping slices can leave the two halves out of order
+    std::stable_sort(kept.begin(), kept.end(),
+        [](const Slice& a, const Slice& b) { return a.position < b.position; });
+
+    setSlices(std::move(kept), length - (end - start));
+}
+
+void EditList::silence(juce::int64 start, juce::int64 end) {
+    start = juce::jlimit<juce::int64>(0, length, start);
+    end = juce::jlimit<juce::int64>(start, length, end);
+    if (start == end) return;
+
+    auto kept = getRange(0, start);
+    for (auto slice : getRange(end, length)) {
+        slice.position += end;
+        kept.push_back(std::move(slice));
+    }
+
+    std::stable_sort(kept.begin(), kept.end(),
+        [](const Slice& a, const Slice& b) { return a.position < b.position; });
+
+    setSlices(std::move(kept), length);
+}
+
+void EditList::nudge(juce::int64 offset) {
+    if (offset == 0) return;
+
+    // Shifting the window the other way is the same as shifting the audio
+    auto moved = getRange(-offset, length - offset);
+    setSlices(std::move(moved), length);
+}
+
+void EditList::splitSlicesAt(juce::int64 position) {
+    if (position <= 0 || position >= length) return;
+
+    std::vector<Slice> divided;
+    divided.reserve(slices.size() + 1);
+
+    for (const auto& slice : slices) {
+        if (slice.position < position && slice.getEnd() > position) {
+            Slice head = slice;
+            Slice tail = slice;
+
+            head.length = position - slice.position;
+            tail.position = position;
+            tail.sourceStart += head.length;
+            tail.length -= head.length;
+
+            divided.push_back(std::move(head));
+            divided.push_back(std::move(tail));
+        }
+        else {
+            divided.push_back(slice);
+        }
+    }
+
+    std::stable_sort(divided.begin(), divided.end(),
+        [](const Slice& a, const Slice& b) { return a.position < b.position; });
+
+    setSlices(std::move(divided), length);
+}
+
+std::vector<EditList> EditList::split(const std::vector<juce::int64>& splitPoints) const {
+    std::vector<juce::int64> bounds = { 0 };
+    for (auto point : splitPoints) {
+        if (point > 0 && point < length) bounds.push_back(point);
+    }
+    bounds.push_back(length);
+
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    std::vector<EditList> pieces;
+    pieces.reserve(bounds.size());
+
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        EditList piece;
+        piece.numChannels = numChannels;
+        piece.setSlices(getRange(bounds[i], bounds[i + 1]), bounds[i + 1] - bounds[i]);
+        pieces.push_back(std::move(piece));
+    }
+
+    return pieces;
+}
+
+bool EditList::merge(const std::vector<EditList>& clips,
+    const std::vector<juce::int64>& positions, EditList& merged) {
+
+    if (positions.size() != clips.size()) return false;
+
+    std::vector<Slice> mixed;
+    juce::int64 mergedLength = 0;
+    int channels = 0;
+
+    for (size_t i = 0; i < clips.size(); ++i) {
+        const juce::int64 offset = juce::jmax<juce::int64>(0, positions[i]);
+
+        for (auto slice : clips[i].slices) {
+            slice.position += offset;
+            mixed.push_back(std::move(slice));
+        }
+
+        mergedLength = juce::jmax(mergedLength, offset + clips[i].length);
+        channels = juce::jmax(channels, clips[i].numChannels);
+    }
+
+    std::stable_sort(mixed.begin(), mixed.end(),
+        [](const Slice& a, const Slice& b) { return a.position < b.position; });
+
+    merged = EditList();
+    merged.numChannels = channels;
+    merged.setSlices(std::move(mixed), mergedLength);
+    return true;
+}
+
+bool EditList::read(juce::AudioBuffer<float>& dest, juce::int64 start, int numSamples) const {
+    dest.setSize(numChannels, juce::jmax(0, numSamples), false, false, true);
+    dest.clear();
+
+    if (numSamples <= 0) return true;
+
+    const juce::int64 end = start + numSamples;
+
+    // Nothing starting before start - maxSliceLength can still be playing at start
+    auto first = std::lower_bound(slices.begin(), slices.end(), start - maxSliceLength,
+        [](const Slice& slice, juce::int64 position) { return slice.position < position; });
+
+    for (auto it = first; it != slices.end() && it->position < end; ++it) {
+        const juce::int64 from = juce::jmax(start, it->position);
+        const juce::int64 to = juce::jmin(end, it->getEnd());
+        if (from >= to) continue;
+
+        if (!it->source->addTo(dest, static_cast<int>(from - start),
+                it->sourceStart + (from - it->position), static_cast<int>(to - from), it->gain))
+            return false;
+    }
+
+    return true;
+}
+
+bool EditList::materialize(juce::AudioBuffer<float>& dest) const {
+    if (length > std::numeric_limits<int>::max()) return false;
+
+    return read(dest, 0, static_cast<int>(length));
+}
+
+std::vector<EditList::Slice> EditList::getRange(juce::int64 start, juce::int64 end) const {
+    std::vector<Slice> clipped;
+
+    auto first = std::lower_bound(slices.begin(), slices.end(), start - maxSliceLength,
+        [](const Slice& slice, juce::int64 position) { return slice.position < position; });
+
+    for (auto it = first; it != slices.end() && it->position < end; ++it) {
+        const juce::int64 from = juce::jmax(start, it->position);
+        const juce::int64 to = juce::jmin(end, it->getEnd());
+        if (from >= to) continue;
+
+        Slice slice = *it;
+        slice.sourceStart += from - it->position;
+        slice.length = to - from;
+        slice.position = from - start;
+        clipped.push_back(std::move(slice));
+    }
+
+    return clipped;
+}
+
+void EditList::setSlices(std::vector<Slice>&& newSlices, juce::int64 newLength) {
+    slices = std::move(newSlices);
+    length = newLength;
+
+    maxSliceLength = 0;
+    for (const auto& slice : slices)
+        maxSliceLength = juce::jmax(maxSliceLength, slice.length);
+}
@@ -0,0 +1,140 @@
+// ============================================================================
+// EditList.h
+// Non-destructive arrangement of slices over shared source audio
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "StreamingAudioFile.h"
+#include <memory>
+#include <vector>
+
+class EditList {
+public:
+    // Audio the slices read from. A source either refers to a buffer or stream owned
+    // elsewhere, which must outlive every list using it, or owns its buffer outright.
+    class Source {
+    public:
+        explicit Source(const juce::AudioBuffer<float>& buffer);
+        explicit Source(juce::AudioBuffer<float>&& buffer);
+        explicit Source(StreamingAudioFile& stream);
+
+        int getNumChannels() const;
+        juce::int64 getLengthInSamples() const;
+        const juce::AudioBuffer<float>* getBuffer() const { return buffer; }   // nullptr for streams
+        StreamingAudioFile* getStream() const { return stream; }               // nullptr for buffers
+
+        // Sample memory held by this source itself rather than referenced
+        size_t getOwnedBytes() const;
+
+        // Adds [sourceStart, sourceStart + numSamples) scaled by gain into dest at destStart
+        bool addTo(juce::AudioBuffer<float>& dest, int destStart,
+            juce::int64 sourceStart, int numSamples, float gain) const;
+
+    private:
+        juce::AudioBuffer<float> ownedBuffer;
+        const juce::AudioBuffer<float>* buffer = nullptr;
+        StreamingAudioFile* stream = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE(Source)
+    };
+
+    // A run of source samples placed on the timeline
+    struct Slice {
+        std::shared_ptr<const Source> source;
+        juce::int64 sourceStart = 0;
+        juce::int64 length = 0;
+        juce::int64 position = 0;
+        float gain = 1.0f;
+
+        juce::int64 getEnd() const { return position + length; }
+
+        bool operator==(const Slice& other) const {
+            return source == other.source && sourceStart == other.sourceStart
+                && length == other.length && position == other.position && gain == other.gain;
+        }
+        bool operator!=(const Slice& other) const { return !(*this == other); }
+    };
+
+    EditList() = default;
+
+    // The whole source, unedited, starting at zero
+    explicit EditList(std::shared_ptr<const Source> source);
+
+    juce::int64 getLengthInSamples() const { return length; }
+    int getNumChannels() const { return numChannels; }
+    bool isEmpty() const { return length == 0; }
+
+    // Slices are ordered by position; only merged lists overlap
+    const std::vector<Slice>& getSlices() const { return slices; }
+    size_t getNumSlices() const { return slices.size(); }
+
+    // The source buffer itself if the list still plays it back unchanged, so
+    // callers that need contiguous samples can skip materialising
+    const juce::AudioBuffer<float>* getContiguousBuffer() const;
+
+    // True while the list plays a single source back whole and unchanged
+    bool isUnedited() const;
+
+    // What the list itself takes up, not counting its sources
+    size_t getMetadataBytes() const { return sizeof(EditList) + slices.capacity() * sizeof(Slice); }
+
+    // Same slices of the same sources, so the lists play back identically
+    bool operator==(const EditList& other) const {
+        return length == other.length && numChannels == other.numChannels && slices == other.slices;
+    }
+    bool operator!=(const EditList& other) const { return !(*this == other); }
+
+    // ========================================================================
+    // Editing
+    // ========================================================================
+    // Timeline positions are in samples. Edits only rewrite slice metadata, so
+    // they cost O(slices) whatever the audio length; copy the list first to
+    // keep the original arrangement.
+
+    // Keeps [start, end), moved to the start of the timeline
+    void trim(juce::int64 start, juce::int64 end);
+
+    // Removes [start, end) and closes the gap
+    void cut(juce::int64 start, juce::int64 end);
+
+    // Drops the audio in [start, end) but keeps the timeline, leaving a silent gap
+    void silence(juce::int64 start, juce::int64 end);
+
+    // Moves everything by offset samples; the length stays the same, so audio
+    // pushed past either end is dropped and the gap it leaves is silent
+    void nudge(juce::int64 offset);
+
+    // Divides the slices crossing position so later edits can move the parts
+    // independently. Playback doesn't change.
+    void splitSlicesAt(juce::int64 position);
+
+    // Pieces between consecutive split points, each starting at zero
+    std::vector<EditList> split(const std::vector<juce::int64>& splitPoints) const;
+
+    // Mixes the clips, each starting at its position; false if the counts differ
+    static bool merge(const std::vector<EditList>& clips,
+        const std::vector<juce::int64>& positions, EditList& merged);
+
+    // ========================================================================
+    // Rendering
+    // ========================================================================
+
+    // Reads [start, start + numSamples) of the timeline into dest, resized to the
+    // list's channel count. Gaps and anything past the end are zero.
+    bool read(juce::AudioBuffer<float>& dest, juce::int64 start, int numSamples) const;
+
+    // Renders the whole timeline, provided it fits an int-indexed buffer
+    bool materialize(juce::AudioBuffer<float>& dest) const;
+
+private:
+    std::vector<Slice> slices;
+    juce::int64 length = 0;
+    int numChannels = 0;
+
+    // Longest slice, which bounds how far back a read has to look for overlaps
+    juce::int64 maxSliceLength = 0;
+
+    // Slices clipped to [start, end), with positions relative to start
+    std::vector<Slice> getRange(juce::int64 start, juce::int64 end) const;
+    void setSlices(std::vector<Slice>&& newSlices, juce::int64 newLength);
+};
@@ -0,0 +1,30 @@
+// ============================================================================
+// EditorLayer.cpp
+// ============================================================================
+#include "EditorLayer.h"
+#include "Telemetry.h"
+
+EditorLayer::EditorLayer(PaintFunction paintFunction, bool isOpaque)
+    : paintFunction(std::move(paintFunction)) {
+    setOpaque(isOpaque);
+    setBufferedToImage(true);
+    setInterceptsMouseClicks(false, false);
+}
+
+void EditorLayer::invalidate() {
+    repaint();
+}
+
+void EditorLayer::invalidate(juce::Rectangle<int> parentArea) {
+    auto area = parentArea.translated(-getX(), -getY()).getIntersection(getLocalBounds());
+    if (!area.isEmpty())
+        repaint(area);
+}
+
+void EditorLayer::paint(juce::Graphics& g) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::Paint, "Paint layer");
+    timer.setItems(static_cast<juce::int64>(g.getClipBounds().getWidth()) * g.getClipBounds().getHeight());
+
+    g.setOrigin(-getX(), -getY());
+    paintFunction(g);
+}
@@ -0,0 +1,29 @@
+// ============================================================================
+// EditorLayer.h
+// A cached drawing layer over part of the editor
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+
+// Keeps what it last drew in an image and redraws only the areas invalidated on
+// it; repaints of the editor or of other layers just composite the image again.
+// Mouse clicks pass through to the editor underneath.
+class EditorLayer : public juce::Component {
+public:
+    // Draws in the parent's coordinates, so the editor's drawing methods are used as is
+    using PaintFunction = std::function<void(juce::Graphics&)>;
+
+    explicit EditorLayer(PaintFunction paintFunction, bool isOpaque = false);
+
+    // Marks the whole layer, or an area given in the parent's coordinates, for redrawing
+    void invalidate();
+    void invalidate(juce::Rectangle<int> parentArea);
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    PaintFunction paintFunction;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EditorLayer)
+};
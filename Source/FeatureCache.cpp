@@ -0,0 +1,233 @@
+// ============================================================================
+// FeatureCache.cpp
+// ============================================================================
+#include "FeatureCache.h"
+#include "BreakpointFile.h"
+#include <cstring>
+
+namespace {
+    // Two independent 64-bit hashes over the sample bits, one word at a time
+    class ContentHasher {
+    public:
+        void add(juce::uint64 value) {
+            first = (first ^ value) * 0x100000001b3ull;
+            second = (second ^ (value + 0x9e3779b97f4a7c15ull)) * 0xff51afd7ed558ccdull;
+            second ^= second >> 33;
+        }
+
+        void add(const float* samples, int numSamples) {
+            for (int i = 0; i < numSamples; ++i) {
+                juce::uint32 bits;
+                std::memcpy(&bits, samples + i, sizeof(bits));
+                add(bits);
+            }
+        }
+
+        juce::String getResult() const {
+            return juce::String::toHexString(static_cast<juce::int64>(first)).paddedLeft('0', 16)
+                + juce::String::toHexString(static_cast<juce::int64>(second)).paddedLeft('0', 16);
+        }
+
+    private:
+        juce::uint64 first = 0xcbf29ce484222325ull;
+        juce::uint64 second = 0x84222325cbf29ce4ull;
+    };
+
+    void addShape(ContentHasher& hasher, juce::int64 numSamples, int numChannels, double sampleRate) {
+        hasher.add(static_cast<juce::uint64>(numSamples));
+        hasher.add(static_cast<juce::uint64>(numChannels));
+
+        juce::uint64 rateBits;
+        std::memcpy(&rateBits, &sampleRate, sizeof(rateBits));
+        hasher.add(rateBits);
+    }
+
+    constexpr int hashChunkSamples = 1 << 16;
+}
+
+FeatureCache::FeatureCache(const juce::File& directory, juce::int64 maxBytes)
+    : directory(directory), maxBytes(maxBytes) {
+    directory.createDirectory();
+    scanDirectory();
+}
+
+void FeatureCache::setMaxBytes(juce::int64 bytes) {
+    const juce::ScopedLock sl(lock);
+    maxBytes = bytes;
+    evictToFit();
+}
+
+juce::int64 FeatureCache::getTotalBytes() const {
+    const juce::ScopedLock sl(lock);
+    return totalBytes;
+}
+
+int FeatureCache::getNumEntries() const {
+    const juce::ScopedLock sl(lock);
+    return static_cast<int>(entries.size());
+}
+
+juce::String FeatureCache::hashAudio(const juce::AudioBuffer<float>& buffer, double sampleRate) {
+    ContentHasher hasher;
+    addShape(hasher, buffer.getNumSamples(), buffer.getNumChannels(), sampleRate);
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+        ContentHasher channel;
+        channel.add(buffer.getReadPointer(ch), buffer.getNumSamples());
+        hasher.add(static_cast<juce::uint64>(channel.getResult().hashCode64()));
+    }
+
+    return hasher.getResult();
+}
+
+juce::String FeatureCache::hashAudio(StreamingAudioFile& stream) {
+    ContentHasher hasher;
+    addShape(hasher, stream.getLengthInSamples(), stream.getNumChannels(), stream.getSampleRate());
+
+    // Each channel is hashed on its own, as for a buffer, so a file gives the
+    // same hash streamed or loaded
+    std::vector<ContentHasher> channels(static_cast<size_t>(stream.getNumChannels()));
+    juce::AudioBuffer<float> chunk;
+
+    for (juce::int64 start = 0; start < stream.getLengthInSamples(); start += hashChunkSamples) {
+        const int numSamples = static_cast<int>(juce::jmin<juce::int64>(hashChunkSamples,
+            stream.getLengthInSamples() - start));
+        if (!stream.read(chunk, start, numSamples)) return {};
+
+        for (int ch = 0; ch < stream.getNumChannels(); ++ch)
+            channels[static_cast<size_t>(ch)].add(chunk.getReadPointer(ch), numSamples);
+    }
+
+    for (const auto& channel : channels)
+        hasher.add(static_cast<juce::uint64>(channel.getResult().hashCode64()));
+
+    return hasher.getResult();
+}
+
+juce::String FeatureCache::makeKey(const juce::String& audioHash, const FeatureExtractor& extractor,
+    const juce::String& featureName, int channel) {
+
+    // parallelExtraction only changes how the work is split, not the results
+    const auto& settings = extractor.settings;
+    juce::StringArray parts;
+    parts.add("v" + juce::String(keyVersion));
+    parts.add(audioHash);
+    parts.add(featureName);
+    parts.add(juce::String(channel));
+    parts.add(juce::String(settings.windowSizeMs, 6));
+    parts.add(juce::String(settings.hopSizePct, 6));
+    parts.add(settings.normalizeOutput ? "norm" : "raw");
+    parts.add(juce::String(settings.minValue, 6));
+    parts.add(juce::String(settings.maxValue, 6));
+    parts.add(settings.smoothOutput ? "smooth" : "sharp");
+    parts.add(juce::String(settings.smoothTimeMs, 6));
+    parts.add(extractor.getSettingsKey());
+
+    return parts.joinIntoString("|");
+}
+
+bool FeatureCache::lookup(const juce::String& key, Results& results) {
+    const auto file = getFileForKey(key);
+
+    BreakpointFile::Contents contents;
+    if (!file.existsAsFile() || !BreakpointFile::read(file, contents) || contents.sourceName != key)
+        return false;
+
+    results.clear();
+    results.reserve(contents.outputs.size());
+    for (auto& output : contents.outputs)
+        results.push_back(std::move(output.points));
+
+    const auto now = juce::Time::getCurrentTime();
+    file.setLastModificationTime(now);
+
+    // Another process may have written the entry since the directory was scanned
+    const juce::ScopedLock sl(lock);
+    auto& entry = entries[file.getFileName()];
+    if (entry.bytes == 0) {
+        entry.bytes = file.getSize();
+        totalBytes += entry.bytes;
+    }
+    entry.lastUsed = now.toMilliseconds();
+
+    return true;
+}
+
+bool FeatureCache::store(const juce::String& key, const FeatureExtractor& extractor, const Results& results) {
+    if (results.empty()) return false;
+
+    BreakpointFile::Contents contents;
+    contents.featureName = extractor.getName();
+    contents.sourceName = key;
+
+    for (size_t i = 0; i < results.size(); ++i)
+        contents.outputs.push_back({ extractor.getOutputName(static_cast<int>(i)), results[i] });
+
+    const auto file = getFileForKey(key);
+    const auto temporary = directory.getNonexistentChildFile(file.getFileNameWithoutExtension(), ".tmp", false);
+
+    if (!BreakpointFile::write(temporary, contents)) {
+        temporary.deleteFile();
+        return false;
+    }
+
+    if (!temporary.moveFileTo(file)) {
+        temporary.deleteFile();
+        return false;
+    }
+
+    const juce::ScopedLock sl(lock);
+    auto& entry = entries[file.getFileName()];
+    totalBytes -= entry.bytes;
+    entry.bytes = file.getSize();
+    entry.lastUsed = juce::Time::getCurrentTime().toMilliseconds();
+    totalBytes += entry.bytes;
+
+    evictToFit();
+    return true;
+}
+
+void FeatureCache::clear() {
+    const juce::ScopedLock sl(lock);
+    for (const auto& [name, entry] : entries)
+        directory.getChildFile(name).deleteFile();
+
+    entries.clear();
+    totalBytes = 0;
+}
+
+juce::File FeatureCache::getFileForKey(const juce::String& key) const {
+    return directory.getChildFile(juce::String::toHexString(key.hashCode64()).paddedLeft('0', 16)
+        + BreakpointFile::fileExtension);
+}
+
+void FeatureCache::scanDirectory() {
+    const juce::ScopedLock sl(lock);
+    entries.clear();
+    totalBytes = 0;
+
+    for (const auto& file : directory.findChildFiles(juce::File::findFiles, false,
+        juce::String("*") + BreakpointFile::fileExtension)) {
+
+        Entry entry{ file.getSize(), file.getLastModificationTime().toMilliseconds() };
+        entries[file.getFileName()] = entry;
+        totalBytes += entry.bytes;
+    }
+
+    evictToFit();
+}
+
+void FeatureCache::evictToFit() {
+    // Least recently used first. Entries are few, so a scan per eviction is fine.
+    while (totalBytes > maxBytes && !entries.empty()) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed)
+                oldest = it;
+        }
+
+        directory.getChildFile(oldest->first).deleteFile();
+        totalBytes -= oldest->second.bytes;
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,69 @@
+// ============================================================================
+// FeatureCache.h
+// Extraction results kept on disk, keyed on the audio content and settings
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "FeatureExtractors.h"
+#include "StreamingAudioFile.h"
+#include <map>
+#include <vector>
+
+// Each entry is a binary breakpoint file named after the hash of its key, with
+// the full key kept inside it to catch collisions. Files are written under a
+// temporary name and moved into place, so processes can share a directory.
+// Hits refresh the file's modification time, which orders eviction.
+class FeatureCache {
+public:
+    using Results = std::vector<std::vector<std::pair<double, double>>>;
+
+    explicit FeatureCache(const juce::File& directory,
+        juce::int64 maxBytes = defaultMaxBytes);
+
+    const juce::File& getDirectory() const { return directory; }
+
+    void setMaxBytes(juce::int64 bytes);
+    juce::int64 getMaxBytes() const { return maxBytes; }
+    juce::int64 getTotalBytes() const;
+    int getNumEntries() const;
+
+    // Identifies audio by its samples, sample rate and channel count, so the
+    // same audio hits the cache wherever it's loaded from
+    static juce::String hashAudio(const juce::AudioBuffer<float>& buffer, double sampleRate);
+    static juce::String hashAudio(StreamingAudioFile& stream);
+
+    // Everything the results depend on. Bump the version whenever an
+    // extractor's output changes, so older entries stop matching.
+    static juce::String makeKey(const juce::String& audioHash, const FeatureExtractor& extractor,
+        const juce::String& featureName, int channel);
+
+    bool lookup(const juce::String& key, Results& results);
+    bool store(const juce::String& key, const FeatureExtractor& extractor, const Results& results);
+
+    void clear();
+
+    static constexpr juce::int64 defaultMaxBytes = juce::int64(512) << 20;
+    // 2: Transients moved onto the shared 2048/1024 spectral frames
+    // 3: Transient energy back on 1024/512; only the flux is at the shared hop
+    static constexpr int keyVersion = 3;
+
+private:
+    struct Entry {
+        juce::int64 bytes = 0;
+        juce::int64 lastUsed = 0;   // Milliseconds since the epoch
+    };
+
+    const juce::File directory;
+    juce::int64 maxBytes;
+
+    // Index of the directory by file name, rebuilt from disk on construction
+    mutable juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries;
+    juce::int64 totalBytes = 0;
+
+    juce::File getFileForKey(const juce::String& key) const;
+    void scanDirectory();
+    void evictToFit();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FeatureCache)
+};
@@ -1,51 +1,268 @@
 #include "FeatureExtractors.h"
+#include "ParallelFor.h"
+#include "SIMDKernels.h"
 
 // ============================================================================
-// AmplitudeExtractor implementation
+// FeatureExtractor implementation
+// ============================================================================
+
+STFTFrameCache::FramesPtr FeatureExtractor::getSTFTFrames(const juce::AudioBuffer<float>& buffer, int channel,
+    const STFTFrameCache::Config& config, bool shared) {
+
+    auto buildProgress = [this](float fraction) {
+        return !onProgress || onProgress(mapProgress(fraction));
+    };
+
+    if (frameCache != nullptr && shared)
+        return frameCache->getFrames(buffer, channel, config, settings.parallelExtraction, buildProgress);
+
+    STFTFrameCache localCache;
+    return localCache.getFrames(buffer, channel, config, settings.parallelExtraction, buildProgress);
+}
+
+std::vector<std::vector<std::pair<double, double>>> FeatureExtractor::extractStreaming(StreamingAudioFile& file,
+    int channel) {
+
+    const double sampleRate = file.getSampleRate();
+    const juce::int64 numSamples = file.getLengthInSamples();
+    const StreamingLayout layout = getStreamingLayout(sampleRate);
+
+    std::vector<std::vector<std::pair<double, double>>> results(static_cast<size_t>(getNumOutputs()));
+
+    if (layout.hopSamples <= 0) {
+        juce::AudioBuffer<float> wholeFile;
+        return file.readAll(wholeFile) ? extract(wholeFile, sampleRate, channel) : results;
+    }
+
+    // Each chunk re-reads one frame ahead of its first, so anything comparing
+    // against the previous frame (spectral flux) is seamless across chunks
+    const int framesPerChunk = std::max(1, streamChunkSamples / layout.hopSamples);
+    constexpr int contextFrames = 1;
+
+    auto sharedCache = std::move(frameCache);
+
+    for (auto& output : results)
+        output.reserve(static_cast<size_t>(numSamples / layout.hopSamples + 1));
+
+    juce::AudioBuffer<float> chunk;
+    bool cancelled = false;
+
+    for (juce::int64 firstFrame = 0;; firstFrame += framesPerChunk) {
+        juce::int64 readFrame = std::max<juce::int64>(0, firstFrame - contextFrames);
+        juce::int64 readStart = readFrame * layout.hopSamples;
+        if (readStart >= numSamples) break;
+
+        juce::int64 readEnd = std::min(numSamples, (firstFrame + framesPerChunk) * layout.hopSamples + layout.windowSamples);
+
+        setChunkProgressRange(static_cast<float>(readStart) / numSamples, static_cast<float>(readEnd) / numSamples);
+
+        if (!file.read(chunk, readStart, static_cast<int>(readEnd - readStart))) break;
+
+        auto chunkResults = extract(chunk, sampleRate, channel);
+
+        if (onProgress && !onProgress(static_cast<float>(readEnd) / numSamples)) {
+            cancelled = true;
+            break;
+        }
+
+        const size_t skip = static_cast<size_t>(firstFrame - readFrame);
+        const double offset = readStart / sampleRate;
+        size_t taken = 0;
+
+        for (size_t output = 0; output < results.size() && output < chunkResults.size(); ++output) {
+            const auto& frames = chunkResults[output];
+            size_t end = std::min(frames.size(), skip + static_cast<size_t>(framesPerChunk));
+
+            for (size_t frame = skip; frame < end; ++frame)
+                results[output].push_back({ frames[frame].first + offset, frames[frame].second });
+
+            taken = std::max(taken, end > skip ? end - skip : 0);
+        }
+
+        if (taken == 0) break;
+    }
+
+    setChunkProgressRange(0.0f, 1.0f);
+    frameCache = std::move(sharedCache);
+
+    if (cancelled)
+        return std::vector<std::vector<std::pair<double, double>>>(static_cast<size_t>(getNumOutputs()));
+
+    return results;
+}
+
+// ============================================================================
+// HopBasedExtractor implementation
 // ============================================================================
 
-std::vector<std::vector<std::pair<double, double>>> AmplitudeExtractor::extract(const juce::AudioBuffer<float>& buffer,
+std::vector<std::vector<std::pair<double, double>>> HopBasedExtractor::extract(const juce::AudioBuffer<float>& buffer,
     double sampleRate,
     int channel) {
 
-    std::vector<std::vector<std::pair<double, double>>> results(2);
+    const FrameLayout layout = getFrameLayout(buffer.getNumSamples(), sampleRate);
+
+    FrameValues values;
+    borrowFrameValues(values, layout.numFrames);
+
+    bool completed = prepareBuffer(buffer, channel, layout)
+        && computeFrameRange(buffer, channel, layout, 0, layout.numFrames, values);
+    releaseBuffer();
+
+    if (!completed)
+        return std::vector<std::vector<std::pair<double, double>>>(static_cast<size_t>(getNumOutputs()));
+
+    return finaliseFrames(layout, sampleRate, values);
+}
+
+std::vector<std::vector<std::pair<double, double>>> HopBasedExtractor::extractStreaming(StreamingAudioFile& file,
+    int channel) {
+
+    return extractChunks(file.getLengthInSamples(), file.getSampleRate(), channel,
+        [&file](juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples) {
+            return file.read(chunk, start, numSamples);
+        });
+}
+
+std::vector<std::vector<std::pair<double, double>>> HopBasedExtractor::extractStreaming(const EditList& edits,
+    double sampleRate, int channel) {
+
+    return extractChunks(edits.getLengthInSamples(), sampleRate, channel,
+        [&edits](juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples) {
+            return edits.read(chunk, start, numSamples);
+        });
+}
+
+std::vector<std::vector<std::pair<double, double>>> HopBasedExtractor::extractChunks(juce::int64 numSamples,
+    double sampleRate, int channel, const ChunkReader& readChunk) {
+
+    const FrameLayout layout = getFrameLayout(numSamples, sampleRate);
+
+    FrameValues values;
+    borrowFrameValues(values, layout.numFrames);
+
+    const int framesPerChunk = std::max(256, streamChunkSamples / layout.hopSamples);
+    const int contextFrames = getContextFrames();
+
+    // Chunk buffers are reused, so they must not land in the shared cache keyed on their pointer
+    auto sharedCache = std::move(frameCache);
+
+    juce::AudioBuffer<float> chunk;
+    bool completed = true;
+
+    for (int firstFrame = 0; firstFrame < layout.numFrames && completed; firstFrame += framesPerChunk) {
+        int endFrame = std::min(layout.numFrames, firstFrame + framesPerChunk);
+
+        // Only the audio this chunk's windows touch, plus the look-back context
+        FrameLayout chunkLayout = layout;
+        chunkLayout.bufferStartSample = std::max(0, firstFrame - contextFrames) * static_cast<juce::int64>(layout.hopSamples);
+        juce::int64 chunkEnd = std::min(numSamples,
+            (endFrame - 1 + getLookAheadFrames()) * static_cast<juce::int64>(layout.hopSamples) + layout.windowSamples);
+
+        setChunkProgressRange(static_cast<float>(firstFrame) / layout.numFrames,
+            static_cast<float>(endFrame) / layout.numFrames);
+
+        completed = readChunk(chunk, chunkLayout.bufferStartSample, static_cast<int>(chunkEnd - chunkLayout.bufferStartSample))
+            && prepareBuffer(chunk, channel, chunkLayout)
+            && computeFrameRange(chunk, channel, chunkLayout, firstFrame, endFrame, values);
+        releaseBuffer();
+    }
+
+    setChunkProgressRange(0.0f, 1.0f);
+    frameCache = std::move(sharedCache);
+
+    if (!completed)
+        return std::vector<std::vector<std::pair<double, double>>>(static_cast<size_t>(getNumOutputs()));
+
+    return finaliseFrames(layout, sampleRate, values);
+}
+
+void HopBasedExtractor::borrowFrameValues(FrameValues& values, int numFrames) const {
+    jassert(getNumFrameValues() <= maxFrameValues);
+
+    for (int value = 0; value < getNumFrameValues(); ++value)
+        values[static_cast<size_t>(value)] = ScratchPool::borrow<float>(static_cast<size_t>(juce::jmax(0, numFrames)));
+}
+
+bool HopBasedExtractor::computeFrameRange(const juce::AudioBuffer<float>& buffer, int channel,
+    const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) {
+
+    const int numFrames = endFrame - firstFrame;
+
+    // Frames are computed in small blocks so progress and cancellation stay responsive
+    constexpr int framesPerBlock = 256;
+    std::atomic<int> framesDone{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    auto processRange = [&](int begin, int end) {
+        for (int block = begin; block < end && !cancelled; block += framesPerBlock) {
+            int blockEnd = std::min(end, block + framesPerBlock);
+            {
+                const ScratchPool::FrameLoopScope frameLoop;
+                computeFrames(buffer, channel, layout, firstFrame + block, firstFrame + blockEnd, values);
+            }
+
+            int done = framesDone.fetch_add(blockEnd - block) + (blockEnd - block);
+            if (!reportProgress(done, numFrames, 0))
+                cancelled = true;
+        }
+    };
+
+    if (settings.parallelExtraction)
+        ParallelFor::forEachChunk(numFrames, ParallelFor::chooseChunkSize(numFrames), processRange);
+    else
+        processRange(0, numFrames);
+
+    return !cancelled;
+}
+
+HopBasedExtractor::FrameLayout HopBasedExtractor::getSettingsLayout(juce::int64 numSamples, double sampleRate) const {
+    FrameLayout layout;
 
     int windowSamples = static_cast<int>(settings.windowSizeMs * sampleRate / 1000.0f);
-    int hopSamples = std::max(1, static_cast<int>(windowSamples * settings.hopSizePct / 100.0f));
+    layout.hopSamples = std::max(1, static_cast<int>(windowSamples * settings.hopSizePct / 100.0f));
+    layout.windowSamples = std::max(1, windowSamples);
+    layout.numFrames = static_cast<int>((numSamples + layout.hopSamples - 1) / layout.hopSamples);
+
+    return layout;
+}
+
+// ============================================================================
+// AmplitudeExtractor implementation
+// ============================================================================
+
+HopBasedExtractor::FrameLayout AmplitudeExtractor::getFrameLayout(juce::int64 numSamples, double sampleRate) const {
+    return getSettingsLayout(numSamples, sampleRate);
+}
 
-    if (windowSamples == 0) windowSamples = 1;
+void AmplitudeExtractor::computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+    const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) {
 
     const float* data = buffer.getReadPointer(channel);
     int numSamples = buffer.getNumSamples();
 
-    std::vector<float> rmsValues;
-    std::vector<float> peakValues;
-    std::vector<double> times;
-
-    for (int start = 0; start < numSamples; start += hopSamples) {
-        int end = std::min(start + windowSamples, numSamples);
+    for (int frame = firstFrame; frame < endFrame; ++frame) {
+        int start = layout.getBufferOffset(frame);
+        int end = std::min(start + layout.windowSamples, numSamples);
         int length = end - start;
 
-        if (length == 0) continue;
-
         float sumSquares = 0.0f;
         float peak = 0.0f;
+        SIMDKernels::sumOfSquaresAndPeak(data + start, length, sumSquares, peak);
 
-        for (int i = start; i < end; ++i) {
-            float sample = data[i];
-            sumSquares += sample * sample;
-            float absSample = std::abs(sample);
-            if (absSample > peak) peak = absSample;
-        }
+        values[0][frame] = std::sqrt(sumSquares / length);
+        values[1][frame] = peak;
+    }
+}
 
-        float rms = std::sqrt(sumSquares / length);
+std::vector<std::vector<std::pair<double, double>>> AmplitudeExtractor::finaliseFrames(
+    const FrameLayout& layout, double sampleRate, FrameValues& values) {
 
-        times.push_back(start / sampleRate);
-        rmsValues.push_back(rms);
-        peakValues.push_back(peak);
-    }
+    std::vector<std::vector<std::pair<double, double>>> results(2);
+
+    auto& rmsValues = values[0];
+    auto& peakValues = values[1];
 
-    if (settings.normalizeOutput) {
+    if (settings.normalizeOutput && !rmsValues.empty()) {
         float maxRms = *std::max_element(rmsValues.begin(), rmsValues.end());
         float maxPeak = *std::max_element(peakValues.begin(), peakValues.end());
 
@@ -58,9 +275,13 @@ std::vector<std::vector<std::pair<double, double>>> AmplitudeExtractor::extract(
                 v /= maxPeak;
     }
 
-    for (size_t i = 0; i < times.size(); ++i) {
-        results[0].push_back({ times[i], rmsValues[i] });
-        results[1].push_back({ times[i], peakValues[i] });
+    results[0].reserve(rmsValues.size());
+    results[1].reserve(peakValues.size());
+
+    for (int frame = 0; frame < layout.numFrames; ++frame) {
+        double time = layout.getFrameTime(frame, sampleRate);
+        results[0].push_back({ time, rmsValues[frame] });
+        results[1].push_back({ time, peakValues[frame] });
     }
 
     return results;
@@ -74,59 +295,76 @@ std::vector<std::vector<std::pair<double, double>>> PanningExtractor::extract(co
     double sampleRate,
     int channel) {
 
-    std::vector<std::vector<std::pair<double, double>>> results(3);
-
     if (buffer.getNumChannels() < 2) {
+        std::vector<std::vector<std::pair<double, double>>> results(3);
         results[0].push_back({ 0.0, 0.0 });
         results[1].push_back({ 0.0, 0.0 });
         results[2].push_back({ 0.0, 0.0 });
         return results;
     }
 
-    const float* left = buffer.getReadPointer(0);
-    const float* right = buffer.getReadPointer(1);
-    int numSamples = buffer.getNumSamples();
+    return HopBasedExtractor::extract(buffer, sampleRate, channel);
+}
 
-    int windowSamples = static_cast<int>(settings.windowSizeMs * sampleRate / 1000.0f);
-    int hopSamples = std::max(1, static_cast<int>(windowSamples * settings.hopSizePct / 100.0f));
+std::vector<std::vector<std::pair<double, double>>> PanningExtractor::extractStreaming(StreamingAudioFile& file,
+    int channel) {
 
-    for (int start = 0; start < numSamples; start += hopSamples) {
-        int end = std::min(start + windowSamples, numSamples);
-        int length = end - start;
+    if (file.getNumChannels() < 2) {
+        std::vector<std::vector<std::pair<double, double>>> results(3);
+        results[0].push_back({ 0.0, 0.0 });
+        results[1].push_back({ 0.0, 0.0 });
+        results[2].push_back({ 0.0, 0.0 });
+        return results;
+    }
+
+    return HopBasedExtractor::extractStreaming(file, channel);
+}
 
-        if (length == 0) continue;
+HopBasedExtractor::FrameLayout PanningExtractor::getFrameLayout(juce::int64 numSamples, double sampleRate) const {
+    return getSettingsLayout(numSamples, sampleRate);
+}
 
-        double time = start / sampleRate;
+void PanningExtractor::computeFrames(const juce::AudioBuffer<float>& buffer, int,
+    const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) {
 
-        float leftSum = 0.0f, rightSum = 0.0f;
-        float leftSq = 0.0f, rightSq = 0.0f;
-        float correlation = 0.0f;
+    const float* left = buffer.getReadPointer(0);
+    const float* right = buffer.getReadPointer(1);
+    int numSamples = buffer.getNumSamples();
 
-        for (int i = start; i < end; ++i) {
-            float l = left[i];
-            float r = right[i];
-            leftSum += std::abs(l);
-            rightSum += std::abs(r);
-            leftSq += l * l;
-            rightSq += r * r;
-            correlation += l * r;
-        }
+    for (int frame = firstFrame; frame < endFrame; ++frame) {
+        int start = layout.getBufferOffset(frame);
+        int end = std::min(start + layout.windowSamples, numSamples);
+        int length = end - start;
 
-        float totalSum = leftSum + rightSum;
-        float pan = totalSum > 0.0f ? (rightSum - leftSum) / totalSum : 0.0f;
+        auto stats = SIMDKernels::stereoStats(left + start, right + start, length);
 
-        float leftRMS = std::sqrt(leftSq / length);
-        float rightRMS = std::sqrt(rightSq / length);
+        float totalSum = stats.leftAbsSum + stats.rightAbsSum;
+        float pan = totalSum > 0.0f ? (stats.rightAbsSum - stats.leftAbsSum) / totalSum : 0.0f;
+
+        float leftRMS = std::sqrt(stats.leftSumSquares / length);
+        float rightRMS = std::sqrt(stats.rightSumSquares / length);
         float denom = leftRMS * rightRMS;
-        float corr = denom > 0.0f ? correlation / (length * denom) : 0.0f;
+        float corr = denom > 0.0f ? stats.crossProduct / (length * denom) : 0.0f;
         float width = 1.0f - (corr * 0.5f + 0.5f);
 
         float totalRMS = leftRMS + rightRMS;
         float balance = totalRMS > 0.0f ? (rightRMS - leftRMS) / totalRMS : 0.0f;
 
-        results[0].push_back({ time, pan });
-        results[1].push_back({ time, width });
-        results[2].push_back({ time, balance });
+        values[0][frame] = pan;
+        values[1][frame] = width;
+        values[2][frame] = balance;
+    }
+}
+
+std::vector<std::vector<std::pair<double, double>>> PanningExtractor::finaliseFrames(
+    const FrameLayout& layout, double sampleRate, FrameValues& values) {
+
+    std::vector<std::vector<std::pair<double, double>>> results(3);
+
+    for (size_t output = 0; output < results.size(); ++output) {
+        results[output].reserve(static_cast<size_t>(layout.numFrames));
+        for (int frame = 0; frame < layout.numFrames; ++frame)
+            results[output].push_back({ layout.getFrameTime(frame, sampleRate), values[output][frame] });
     }
 
     return results;
@@ -137,9 +375,7 @@ std::vector<std::vector<std::pair<double, double>>> PanningExtractor::extract(co
 // ============================================================================
 
 SpectralExtractor::SpectralExtractor() {
-    fft = std::make_unique<juce::dsp::FFT>(11);
-    fftSize = 1 << 11;
-    fftData.resize(fftSize * 2, 0.0f);
+    fftSize = STFTFrameCache::getSharedConfig().fftSize;
 }
 
 std::vector<std::vector<std::pair<double, double>>> SpectralExtractor::extract(const juce::AudioBuffer<float>& buffer,
@@ -148,51 +384,50 @@ std::vector<std::vector<std::pair<double, double>>> SpectralExtractor::extract(c
 
     std::vector<std::vector<std::pair<double, double>>> results(4);
 
-    const float* data = buffer.getReadPointer(channel);
-    int numSamples = buffer.getNumSamples();
-
-    int hopSamples = fftSize / 2;
-    std::vector<float> previousMagnitudes;
+    const auto config = STFTFrameCache::getSharedConfig();
+    jassert(config.fftSize == fftSize && config.hopSamples == fftSize / 2);
 
-    for (int start = 0; start <= numSamples - fftSize; start += hopSamples) {
-        double time = start / sampleRate;
+    // The FFT pass dominates, so it gets most of the progress bar
+    setProgressRange(0.0f, 0.8f);
+    auto frames = getSTFTFrames(buffer, channel, config);
+    setProgressRange(0.8f, 1.0f);
 
-        for (int i = 0; i < fftSize; ++i) {
-            float window = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / fftSize));
-            fftData[i] = data[start + i] * window;
-        }
+    if (frames != nullptr) {
+        const int numFrames = frames->getNumFrames();
+        const int numBins = fftSize / 2;
 
-        fft->performFrequencyOnlyForwardTransform(fftData.data());
+        for (auto& output : results)
+            output.reserve(static_cast<size_t>(numFrames));
 
-        std::vector<float> magnitudes(fftSize / 2);
-        for (int i = 0; i < fftSize / 2; ++i) {
-            float real = fftData[i * 2];
-            float imag = fftData[i * 2 + 1];
-            magnitudes[i] = std::sqrt(real * real + imag * imag);
-        }
+        for (int frame = 0; frame < numFrames; ++frame) {
+            if (!reportProgress(frame, numFrames, frame)) break;
+            const ScratchPool::FrameLoopScope frameLoop;
 
-        float centroid = calculateCentroid(magnitudes, sampleRate);
-        float flux = previousMagnitudes.empty() ? 0.0f : calculateFlux(magnitudes, previousMagnitudes);
-        float flatness = calculateFlatness(magnitudes);
-        float rolloff = calculateRolloff(magnitudes, sampleRate);
+            double time = frames->getFrameStart(frame) / sampleRate;
+            const float* magnitudes = frames->getMagnitudes(frame);
 
-        results[0].push_back({ time, centroid });
-        results[1].push_back({ time, flux });
-        results[2].push_back({ time, flatness });
-        results[3].push_back({ time, rolloff });
+            float centroid = calculateCentroid(magnitudes, numBins, sampleRate);
+            float flux = frame == 0 ? 0.0f : calculateFlux(magnitudes, frames->getMagnitudes(frame - 1), numBins);
+            float flatness = calculateFlatness(magnitudes, numBins);
+            float rolloff = calculateRolloff(magnitudes, numBins, sampleRate);
 
-        previousMagnitudes = magnitudes;
+            results[0].push_back({ time, centroid });
+            results[1].push_back({ time, flux });
+            results[2].push_back({ time, flatness });
+            results[3].push_back({ time, rolloff });
+        }
     }
 
+    setProgressRange(0.0f, 1.0f);
     return results;
 }
 
-float SpectralExtractor::calculateCentroid(const std::vector<float>& magnitudes, double sampleRate) {
+float SpectralExtractor::calculateCentroid(const float* magnitudes, int numBins, double sampleRate) {
     float weightedSum = 0.0f;
     float totalSum = 0.0f;
 
-    for (size_t i = 0; i < magnitudes.size(); ++i) {
-        float freq = i * sampleRate / (fftSize * 2.0f);
+    for (int i = 0; i < numBins; ++i) {
+        float freq = static_cast<float>(i * sampleRate / fftSize);
         weightedSum += freq * magnitudes[i];
         totalSum += magnitudes[i];
     }
@@ -200,21 +435,22 @@ float SpectralExtractor::calculateCentroid(const std::vector<float>& magnitudes,
     return totalSum > 0.0f ? weightedSum / totalSum : 0.0f;
 }
 
-float SpectralExtractor::calculateFlux(const std::vector<float>& current, const std::vector<float>& previous) {
+float SpectralExtractor::calculateFlux(const float* current, const float* previous, int numBins) {
     float sum = 0.0f;
-    for (size_t i = 0; i < current.size(); ++i) {
+    for (int i = 0; i < numBins; ++i) {
         float diff = current[i] - previous[i];
         sum += diff * diff;
     }
-    return std::sqrt(sum / current.size());
+    return std::sqrt(sum / numBins);
 }
 
-float SpectralExtractor::calculateFlatness(const std::vector<float>& magnitudes) {
+float SpectralExtractor::calculateFlatness(const float* magnitudes, int numBins) {
     float geometricMean = 0.0f;
     float arithmeticMean = 0.0f;
     int count = 0;
 
-    for (auto mag : magnitudes) {
+    for (int i = 0; i < numBins; ++i) {
+        float mag = magnitudes[i];
         if (mag > 0.0f) {
             geometricMean += std::log(mag);
             arithmeticMean += mag;
@@ -230,18 +466,18 @@ float SpectralExtractor::calculateFlatness(const std::vector<float>& magnitudes)
     return arithmeticMean > 0.0f ? geometricMean / arithmeticMean : 0.0f;
 }
 
-float SpectralExtractor::calculateRolloff(const std::vector<float>& magnitudes, double sampleRate) {
+float SpectralExtractor::calculateRolloff(const float* magnitudes, int numBins, double sampleRate) {
     float totalEnergy = 0.0f;
-    for (auto mag : magnitudes)
-        totalEnergy += mag;
+    for (int i = 0; i < numBins; ++i)
+        totalEnergy += magnitudes[i];
 
     float threshold = totalEnergy * 0.85f;
     float cumulativeEnergy = 0.0f;
 
-    for (size_t i = 0; i < magnitudes.size(); ++i) {
+    for (int i = 0; i < numBins; ++i) {
         cumulativeEnergy += magnitudes[i];
         if (cumulativeEnergy >= threshold)
-            return i * sampleRate / (fftSize * 2.0f);
+            return static_cast<float>(i * sampleRate / fftSize);
     }
 
     return sampleRate / 2.0f;
@@ -263,23 +499,80 @@ std::vector<std::vector<std::pair<double, double>>> PitchExtractor::extract(cons
     int windowSamples = static_cast<int>(0.05 * sampleRate);
     int hopSamples = windowSamples / 2;
 
-    for (int start = 0; start < numSamples - windowSamples; start += hopSamples) {
-        double time = start / sampleRate;
+    if (mode == Mode::Reference) {
+        for (auto& output : results)
+            output.reserve(static_cast<size_t>(juce::jmax(0, numSamples - windowSamples) / juce::jmax(1, hopSamples) + 1));
 
-        auto [freq, confidence] = detectPitch(data + start, windowSamples, sampleRate);
+        // Sized as detectPitch sizes it, so no hop allocates
+        correlation.resize(static_cast<size_t>(juce::jmax(0,
+            static_cast<int>(sampleRate / 50.0) - static_cast<int>(sampleRate / 1000.0))));
 
-        results[0].push_back({ time, freq });
-        results[1].push_back({ time, confidence });
+        int hopIndex = 0;
+        for (int start = 0; start < numSamples - windowSamples; start += hopSamples, ++hopIndex) {
+            if (!reportProgress(start, numSamples, hopIndex)) break;
+            const ScratchPool::FrameLoopScope frameLoop;
+
+            double time = start / sampleRate;
+
+            auto [freq, confidence] = detectPitch(data + start, windowSamples, sampleRate);
+
+            results[0].push_back({ time, freq });
+            results[1].push_back({ time, confidence });
+        }
+
+        return results;
     }
 
+    // Unwindowed, zero-padded spectra from the frame cache; see prepareFFT for the padding
+    prepareFFT(windowSamples, static_cast<int>(sampleRate / 50.0));
+
+    STFTFrameCache::Config config;
+    config.fftSize = fft->getSize();
+    config.hopSamples = hopSamples;
+    config.frameSamples = windowSamples;
+    config.window = STFTFrameCache::Window::Rectangular;
+
+    // No other extractor reads padded rectangular frames, so they aren't cached
+    setProgressRange(0.0f, 0.5f);
+    auto frames = getSTFTFrames(buffer, channel, config, false);
+    setProgressRange(0.5f, 1.0f);
+
+    if (frames != nullptr) {
+        // Same frames as the reference loop: start < numSamples - windowSamples
+        int span = numSamples - windowSamples;
+        int numFrames = span > 0 ? juce::jmin(frames->getNumFrames(), (span + hopSamples - 1) / hopSamples) : 0;
+
+        for (auto& output : results)
+            output.reserve(static_cast<size_t>(numFrames));
+
+        for (int frame = 0; frame < numFrames; ++frame) {
+            if (!reportProgress(frame, numFrames, frame)) break;
+            const ScratchPool::FrameLoopScope frameLoop;
+
+            double time = frames->getFrameStart(frame) / sampleRate;
+
+            auto [freq, confidence] = detectPitchFFT(frames->getMagnitudes(frame), sampleRate);
+
+            results[0].push_back({ time, freq });
+            results[1].push_back({ time, confidence });
+        }
+    }
+
+    setProgressRange(0.0f, 1.0f);
     return results;
 }
 
+FeatureExtractor::StreamingLayout PitchExtractor::getStreamingLayout(double sampleRate) const {
+    // 50ms windows at 50% overlap, as in extract()
+    const int windowSamples = static_cast<int>(0.05 * sampleRate);
+    return { windowSamples / 2, windowSamples };
+}
+
 std::pair<float, float> PitchExtractor::detectPitch(const float* data, int numSamples, double sampleRate) {
     int minLag = static_cast<int>(sampleRate / 1000.0);
     int maxLag = static_cast<int>(sampleRate / 50.0);
 
-    std::vector<float> correlation(maxLag - minLag);
+    correlation.resize(maxLag - minLag);
 
     for (int lag = minLag; lag < maxLag; ++lag) {
         float sum = 0.0f;
@@ -288,11 +581,51 @@ std::pair<float, float> PitchExtractor::detectPitch(const float* data, int numSa
         correlation[lag - minLag] = sum;
     }
 
-    auto maxIt = std::max_element(correlation.begin(), correlation.end());
-    int peakLag = static_cast<int>(std::distance(correlation.begin(), maxIt)) + minLag;
+    return pickPeak(correlation.data(), minLag, maxLag, sampleRate);
+}
+
+void PitchExtractor::prepareFFT(int numSamples, int maxLag) {
+    // Zero-padding to at least numSamples + maxLag keeps the circular
+    // correlation from wrapping into the lags we read back
+    int order = 1;
+    while ((1 << order) < numSamples + maxLag)
+        ++order;
+
+    if (fft == nullptr || fft->getSize() != (1 << order)) {
+        fft = std::make_unique<juce::dsp::FFT>(order);
+        fftData.assign(static_cast<size_t>(fft->getSize()) * 2, 0.0f);
+    }
+}
+
+std::pair<float, float> PitchExtractor::detectPitchFFT(const float* magnitudes, double sampleRate) {
+    int minLag = static_cast<int>(sampleRate / 1000.0);
+    int maxLag = static_cast<int>(sampleRate / 50.0);
+
+    const int size = fft->getSize();
+
+    // Wiener-Khinchin: autocorrelation is the inverse transform of the power spectrum.
+    // The cache holds bins 0..size/2; the upper half mirrors them for a real signal.
+    for (int bin = 0; bin < size; ++bin) {
+        float magnitude = magnitudes[bin <= size / 2 ? bin : size - bin];
+        fftData[bin * 2] = magnitude * magnitude;
+        fftData[bin * 2 + 1] = 0.0f;
+    }
+
+    fft->performRealOnlyInverseTransform(fftData.data());
+
+    return pickPeak(fftData.data() + minLag, minLag, maxLag, sampleRate);
+}
+
+std::pair<float, float> PitchExtractor::pickPeak(const float* lagCorrelation, int minLag, int maxLag,
+    double sampleRate) const {
+
+    if (maxLag <= minLag) return { 0.0f, 0.0f };
+
+    auto maxIt = std::max_element(lagCorrelation, lagCorrelation + (maxLag - minLag));
+    int peakLag = static_cast<int>(std::distance(lagCorrelation, maxIt)) + minLag;
 
     float freq = static_cast<float>(sampleRate / peakLag);
-    float confidence = *maxIt / correlation[0];
+    float confidence = *maxIt / lagCorrelation[0];
 
     return { freq, std::max(0.0f, std::min(1.0f, confidence)) };
 }
@@ -301,33 +634,104 @@ std::pair<float, float> PitchExtractor::detectPitch(const float* data, int numSa
 // TransientExtractor implementation
 // ============================================================================
 
-std::vector<std::vector<std::pair<double, double>>> TransientExtractor::extract(const juce::AudioBuffer<float>& buffer,
-    double sampleRate,
-    int channel) {
+int TransientExtractor::getFluxFrameRatio(const FrameLayout& layout) {
+    const int sharedHop = STFTFrameCache::getSharedConfig().hopSamples;
+    jassert(sharedHop % layout.hopSamples == 0);
+    return juce::jmax(1, sharedHop / layout.hopSamples);
+}
+
+bool TransientExtractor::prepareBuffer(const juce::AudioBuffer<float>& buffer, int channel,
+    const FrameLayout& layout) {
+
+    // The spectral extractor's frames; each one starts on an energy frame, and
+    // streamed chunks start on one of them so cache frames index from there
+    const auto config = STFTFrameCache::getSharedConfig();
+    jassert(layout.bufferStartSample % config.hopSamples == 0);
+
+    setProgressRange(0.0f, 0.7f);
+    fluxFrames = getSTFTFrames(buffer, channel, config);
+    setProgressRange(0.7f, 1.0f);
+
+    return fluxFrames != nullptr;
+}
+
+void TransientExtractor::releaseBuffer() {
+    fluxFrames.reset();
+    setProgressRange(0.0f, 1.0f);
+}
+
+HopBasedExtractor::FrameLayout TransientExtractor::getFrameLayout(juce::int64 numSamples, double) const {
+    FrameLayout layout;
+    layout.windowSamples = 1024;
+    layout.hopSamples = 512;
+
+    // Only full windows, matching start < numSamples - windowSamples
+    juce::int64 span = numSamples - layout.windowSamples;
+    layout.numFrames = span > 0 ? static_cast<int>((span + layout.hopSamples - 1) / layout.hopSamples) : 0;
+
+    return layout;
+}
+
+int TransientExtractor::getContextFrames() const {
+    // One spectral frame back, for the flux's previous spectrum
+    return getFluxFrameRatio(getFrameLayout(0, 0.0));
+}
+
+int TransientExtractor::getLookAheadFrames() const {
+    // The last spectral frame a chunk starts runs past its energy windows
+    const auto layout = getFrameLayout(0, 0.0);
+    return (STFTFrameCache::getSharedConfig().fftSize - layout.windowSamples + layout.hopSamples - 1) / layout.hopSamples;
+}
 
-    std::vector<std::vector<std::pair<double, double>>> results(1);
+void TransientExtractor::computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+    const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) {
 
     const float* data = buffer.getReadPointer(channel);
-    int numSamples = buffer.getNumSamples();
+    const int ratio = getFluxFrameRatio(layout);
 
-    int windowSamples = 1024;
-    int hopSamples = 512;
+    for (int frame = firstFrame; frame < endFrame; ++frame) {
+        int start = layout.getBufferOffset(frame);
 
-    float previousEnergy = 0.0f;
+        float energy = SIMDKernels::sumOfSquares(data + start, layout.windowSamples);
 
-    for (int start = 0; start < numSamples - windowSamples; start += hopSamples) {
-        double time = start / sampleRate;
+        values[0][frame] = std::sqrt(energy / layout.windowSamples);
 
-        float energy = 0.0f;
-        for (int i = 0; i < windowSamples; ++i) {
-            float sample = data[start + i];
-            energy += sample * sample;
+        // Cache frames are indexed from the start of this buffer, which may be
+        // a streamed chunk beginning a spectral frame before firstFrame
+        int cacheFrame = start / (layout.hopSamples * ratio);
+
+        // Half-wave rectified: only rising bins count towards an onset
+        float flux = noFlux;
+        if (frame % ratio == 0 && cacheFrame < fluxFrames->getNumFrames()) {
+            flux = 0.0f;
+            if (frame > 0 && cacheFrame > 0) {
+                const float* current = fluxFrames->getMagnitudes(cacheFrame);
+                const float* previous = fluxFrames->getMagnitudes(cacheFrame - 1);
+                for (int bin = 0; bin < fluxFrames->getNumBins(); ++bin)
+                    flux += std::max(0.0f, current[bin] - previous[bin]);
+            }
         }
-        energy = std::sqrt(energy / windowSamples);
 
+        values[1][frame] = flux;
+    }
+}
+
+std::vector<std::vector<std::pair<double, double>>> TransientExtractor::finaliseFrames(
+    const FrameLayout& layout, double sampleRate, FrameValues& values) {
+
+    std::vector<std::vector<std::pair<double, double>>> results(2);
+    results[0].reserve(static_cast<size_t>(layout.numFrames));
+    results[1].reserve(static_cast<size_t>(layout.numFrames / getFluxFrameRatio(layout) + 1));
+
+    float previousEnergy = 0.0f;
+
+    for (int frame = 0; frame < layout.numFrames; ++frame) {
+        float energy = values[0][frame];
         float onsetStrength = std::max(0.0f, energy - previousEnergy);
 
-        results[0].push_back({ time, onsetStrength });
+        results[0].push_back({ layout.getFrameTime(frame, sampleRate), onsetStrength });
+        if (values[1][frame] != noFlux)
+            results[1].push_back({ layout.getFrameTime(frame, sampleRate), values[1][frame] });
 
         previousEnergy = energy;
     }
@@ -339,35 +743,35 @@ std::vector<std::vector<std::pair<double, double>>> TransientExtractor::extract(
 // ADSREnvelopeExtractor Implementation
 // ============================================================================
 
-std::vector<std::vector<std::pair<double, double>>> ADSREnvelopeExtractor::extract(const juce::AudioBuffer<float>& buffer,
-    double sampleRate,
-    int channel) {
-
-    std::vector<std::pair<double, double>> amplitudeData;
-
-    int windowSamples = static_cast<int>(settings.windowSizeMs * sampleRate / 1000.0f);
-    int hopSamples = std::max(1, static_cast<int>(windowSamples * settings.hopSizePct / 100.0f));
+HopBasedExtractor::FrameLayout ADSREnvelopeExtractor::getFrameLayout(juce::int64 numSamples, double sampleRate) const {
+    return getSettingsLayout(numSamples, sampleRate);
+}
 
-    if (windowSamples == 0) windowSamples = 1;
+void ADSREnvelopeExtractor::computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+    const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) {
 
     const float* data = buffer.getReadPointer(channel);
     int numSamples = buffer.getNumSamples();
 
-    for (int start = 0; start < numSamples; start += hopSamples) {
-        int end = std::min(start + windowSamples, numSamples);
+    for (int frame = firstFrame; frame < endFrame; ++frame) {
+        int start = layout.getBufferOffset(frame);
+        int end = std::min(start + layout.windowSamples, numSamples);
         int length = end - start;
 
-        if (length == 0) continue;
+        float sumSquares = SIMDKernels::sumOfSquares(data + start, length);
 
-        float sumSquares = 0.0f;
-        for (int i = start; i < end; ++i) {
-            float sample = data[i];
-            sumSquares += sample * sample;
-        }
-
-        float rms = std::sqrt(sumSquares / length);
-        amplitudeData.push_back({ start / sampleRate, rms });
+        values[0][frame] = std::sqrt(sumSquares / length);
     }
+}
+
+std::vector<std::vector<std::pair<double, double>>> ADSREnvelopeExtractor::finaliseFrames(
+    const FrameLayout& layout, double sampleRate, FrameValues& values) {
+
+    std::vector<std::pair<double, double>> amplitudeData;
+    amplitudeData.reserve(static_cast<size_t>(layout.numFrames));
+
+    for (int frame = 0; frame < layout.numFrames; ++frame)
+        amplitudeData.push_back({ layout.getFrameTime(frame, sampleRate), values[0][frame] });
 
     if (!amplitudeData.empty() && settings.normalizeOutput) {
         float maxVal = 0.0f;
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
 #include <vector>
 #include <memory>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include "ScratchPool.h"
+#include "STFTFrameCache.h"
+#include "StreamingAudioFile.h"
+#include "EditList.h"
 
 class FeatureExtractor {
 public:
@@ -24,16 +30,145 @@ public:
         float maxValue = 1.0f;
         bool smoothOutput = false;
         float smoothTimeMs = 10.0f;
+        bool parallelExtraction = false;   // Split hop-based extractors across all cores
     };
 
     Settings settings;
 
+    // Extractor-specific options outside settings that change the results, for
+    // cache keys; empty if there are none
+    virtual juce::String getSettingsKey() const { return {}; }
+
+    // Installed by AnalysisJobEngine while a job runs; returning false cancels the extraction
+    std::function<bool(float)> onProgress;
+
+    // Shared spectra for the FFT-based extractors; without one each extract() computes its own
+    std::shared_ptr<STFTFrameCache> frameCache;
+
     virtual std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
         double sampleRate,
         int channel = 0) = 0;
+
+    // Pulls the file through in chunks so memory stays bounded however long it is.
+    // The default runs extract() on overlapping chunks described by getStreamingLayout()
+    // and stitches the frames; extractors without a layout read the whole file.
+    virtual std::vector<std::vector<std::pair<double, double>>> extractStreaming(StreamingAudioFile& file,
+        int channel = 0);
+
+protected:
+    // Samples per chunk read in extractStreaming()
+    static constexpr int streamChunkSamples = 1 << 20;
+
+    // Frame hop and window of extract(), for extractors whose frames start at multiples of the hop
+    struct StreamingLayout {
+        int hopSamples = 0;
+        int windowSamples = 0;
+    };
+
+    virtual StreamingLayout getStreamingLayout(double sampleRate) const { return {}; }
+
+    // Reports progress every few hundred hops; returns false once the job should stop
+    bool reportProgress(int position, int total, int hopIndex) const {
+        if (!onProgress || (hopIndex & 255) != 0) return true;
+        return onProgress(mapProgress(total > 0 ? static_cast<float>(position) / total : 1.0f));
+    }
+
+    // Maps later progress reports into [start, end] of the job, for extractors that run several passes
+    void setProgressRange(float start, float end) { progressStart = start; progressEnd = end; }
+
+    // Outer range for the chunk being streamed; setProgressRange() then subdivides it
+    void setChunkProgressRange(float start, float end) { chunkStart = start; chunkEnd = end; }
+
+    // Fetches frames from frameCache, reporting the build as progress; nullptr if cancelled.
+    // Frames no other extractor reads are built uncached, so they go when the caller is done.
+    STFTFrameCache::FramesPtr getSTFTFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const STFTFrameCache::Config& config, bool shared = true);
+
+private:
+    float progressStart = 0.0f;
+    float progressEnd = 1.0f;
+    float chunkStart = 0.0f;
+    float chunkEnd = 1.0f;
+
+    float mapProgress(float fraction) const {
+        return chunkStart + (chunkEnd - chunkStart) * (progressStart + (progressEnd - progressStart) * fraction);
+    }
+};
+
+// ============================================================================
+// Hop-based extractors
+// One frame per hop, computed from a fixed window. Frames are independent, so
+// the hop range can be processed in chunks on several cores; anything that
+// depends on neighbouring frames (normalization, onset differences) happens
+// serially in finaliseFrames(), which keeps parallel output identical to serial.
+// ============================================================================
+
+class HopBasedExtractor : public FeatureExtractor {
+public:
+    std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
+        double sampleRate,
+        int channel = 0) override;
+
+    // Streams the frames chunk by chunk; finaliseFrames() still sees every frame at once
+    std::vector<std::vector<std::pair<double, double>>> extractStreaming(StreamingAudioFile& file,
+        int channel = 0) override;
+
+    // Streams an edited arrangement the same way, so it never needs materialising
+    std::vector<std::vector<std::pair<double, double>>> extractStreaming(const EditList& edits,
+        double sampleRate, int channel = 0);
+
+protected:
+    struct FrameLayout {
+        int windowSamples = 1;
+        int hopSamples = 1;
+        int numFrames = 0;
+        juce::int64 bufferStartSample = 0;   // File position of the buffer's first sample when streaming
+
+        double getFrameTime(int frame, double sampleRate) const { return (frame * static_cast<juce::int64>(hopSamples)) / sampleRate; }
+        int getBufferOffset(int frame) const { return static_cast<int>(frame * static_cast<juce::int64>(hopSamples) - bufferStartSample); }
+    };
+
+    // Raw per-frame values, indexed [value][frame], borrowed from the calling thread's pool
+    static constexpr int maxFrameValues = 3;
+    using FrameValues = std::array<ScratchPool::Block<float>, maxFrameValues>;
+
+    virtual FrameLayout getFrameLayout(juce::int64 numSamples, double sampleRate) const = 0;
+    virtual int getNumFrameValues() const = 0;
+
+    // Frames before and after each streamed chunk whose audio computeFrames() reads
+    virtual int getContextFrames() const { return 0; }
+    virtual int getLookAheadFrames() const { return 0; }
+
+    // Called once per buffer (the whole file, or one streamed chunk) before its frames
+    // are computed; returning false cancels the extraction
+    virtual bool prepareBuffer(const juce::AudioBuffer<float>& buffer, int channel, const FrameLayout& layout) { return true; }
+    virtual void releaseBuffer() {}
+
+    // Fills frames [firstFrame, endFrame); may run concurrently for disjoint ranges
+    virtual void computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) = 0;
+
+    virtual std::vector<std::vector<std::pair<double, double>>> finaliseFrames(
+        const FrameLayout& layout, double sampleRate, FrameValues& values) = 0;
+
+    // Window/hop from settings, shared by the amplitude-style extractors
+    FrameLayout getSettingsLayout(juce::int64 numSamples, double sampleRate) const;
+
+private:
+    // Fills chunk with [start, start + numSamples) of whatever is being streamed
+    using ChunkReader = std::function<bool(juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples)>;
+
+    std::vector<std::vector<std::pair<double, double>>> extractChunks(juce::int64 numSamples,
+        double sampleRate, int channel, const ChunkReader& readChunk);
+
+    void borrowFrameValues(FrameValues& values, int numFrames) const;
+
+    // Computes frames [firstFrame, endFrame) of buffer, reporting progress across that range
+    bool computeFrameRange(const juce::AudioBuffer<float>& buffer, int channel, const FrameLayout& layout,
+        int firstFrame, int endFrame, FrameValues& values);
 };
 
-class AmplitudeExtractor : public FeatureExtractor {
+class AmplitudeExtractor : public HopBasedExtractor {
 public:
     juce::String getName() const override { return "Amplitude"; }
     juce::Colour getColor() const override { return juce::Colours::green; }
@@ -41,12 +176,16 @@ public:
     int getNumOutputs() const override { return 2; }
     juce::String getOutputName(int index) const override { return index == 0 ? "RMS" : "Peak"; }
 
-    std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
-        double sampleRate,
-        int channel = 0) override;
+protected:
+    FrameLayout getFrameLayout(juce::int64 numSamples, double sampleRate) const override;
+    int getNumFrameValues() const override { return 2; }
+    void computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) override;
+    std::vector<std::vector<std::pair<double, double>>> finaliseFrames(
+        const FrameLayout& layout, double sampleRate, FrameValues& values) override;
 };
 
-class PanningExtractor : public FeatureExtractor {
+class PanningExtractor : public HopBasedExtractor {
 public:
     juce::String getName() const override { return "Panning"; }
     juce::Colour getColor() const override { return juce::Colours::blue; }
@@ -64,6 +203,16 @@ public:
     std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
         double sampleRate,
         int channel = 0) override;
+    std::vector<std::vector<std::pair<double, double>>> extractStreaming(StreamingAudioFile& file,
+        int channel = 0) override;
+
+protected:
+    FrameLayout getFrameLayout(juce::int64 numSamples, double sampleRate) const override;
+    int getNumFrameValues() const override { return 3; }
+    void computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) override;
+    std::vector<std::vector<std::pair<double, double>>> finaliseFrames(
+        const FrameLayout& layout, double sampleRate, FrameValues& values) override;
 };
 
 class SpectralExtractor : public FeatureExtractor {
@@ -87,46 +236,94 @@ public:
         double sampleRate,
         int channel = 0) override;
 
+protected:
+    StreamingLayout getStreamingLayout(double) const override { return { fftSize / 2, fftSize }; }
+
 private:
-    std::unique_ptr<juce::dsp::FFT> fft;
-    std::vector<float> fftData;
     int fftSize;
 
-    float calculateCentroid(const std::vector<float>& magnitudes, double sampleRate);
-    float calculateFlux(const std::vector<float>& current, const std::vector<float>& previous);
-    float calculateFlatness(const std::vector<float>& magnitudes);
-    float calculateRolloff(const std::vector<float>& magnitudes, double sampleRate);
+    float calculateCentroid(const float* magnitudes, int numBins, double sampleRate);
+    float calculateFlux(const float* current, const float* previous, int numBins);
+    float calculateFlatness(const float* magnitudes, int numBins);
+    float calculateRolloff(const float* magnitudes, int numBins, double sampleRate);
 };
 
 class PitchExtractor : public FeatureExtractor {
 public:
+    // FFTAutocorrelation computes the same lag correlation via the power spectrum;
+    // Reference is the original brute-force O(lag x N) loop, kept for comparison
+    enum class Mode {
+        FFTAutocorrelation,
+        Reference
+    };
+
     juce::String getName() const override { return "Pitch"; }
     juce::Colour getColor() const override { return juce::Colours::orange; }
     int getNumOutputs() const override { return 2; }
     juce::String getOutputName(int index) const override { return index == 0 ? "Frequency" : "Confidence"; }
 
+    void setMode(Mode newMode) { mode = newMode; }
+    Mode getMode() const { return mode; }
+
+    // The modes agree only to within float rounding, so they're cached apart
+    juce::String getSettingsKey() const override { return mode == Mode::Reference ? "reference" : "fft"; }
+
     std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
         double sampleRate,
         int channel = 0) override;
 
+protected:
+    StreamingLayout getStreamingLayout(double sampleRate) const override;
+
 private:
+    Mode mode = Mode::FFTAutocorrelation;
+
+    // Reused across hops; rebuilt only when the window or lag range changes
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> fftData;
+    std::vector<float> correlation;
+
+    void prepareFFT(int numSamples, int maxLag);
     std::pair<float, float> detectPitch(const float* data, int numSamples, double sampleRate);
+    std::pair<float, float> detectPitchFFT(const float* magnitudes, double sampleRate);
+    std::pair<float, float> pickPeak(const float* lagCorrelation, int minLag, int maxLag, double sampleRate) const;
 };
 
-class TransientExtractor : public FeatureExtractor {
+class TransientExtractor : public HopBasedExtractor {
 public:
     juce::String getName() const override { return "Transients"; }
     juce::Colour getColor() const override { return juce::Colours::red; }
-    int getNumOutputs() const override { return 1; }
-    juce::String getOutputName(int index) const override { return "Onset Strength"; }
+    int getNumOutputs() const override { return 2; }
+    juce::String getOutputName(int index) const override { return index == 0 ? "Onset Strength" : "Spectral Flux"; }
 
-    std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
-        double sampleRate,
-        int channel = 0) override;
+protected:
+    // Frames hold RMS energy over 1024/512 windows; the onset difference against
+    // the previous frame is taken in finaliseFrames so chunk seams see the right
+    // previous value. Spectral flux is read from the shared spectral frames, so
+    // it is only on the frames that start one of them, at that coarser hop.
+    FrameLayout getFrameLayout(juce::int64 numSamples, double sampleRate) const override;
+    int getNumFrameValues() const override { return 2; }
+    int getContextFrames() const override;
+    int getLookAheadFrames() const override;
+    bool prepareBuffer(const juce::AudioBuffer<float>& buffer, int channel, const FrameLayout& layout) override;
+    void releaseBuffer() override;
+    void computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) override;
+    std::vector<std::vector<std::pair<double, double>>> finaliseFrames(
+        const FrameLayout& layout, double sampleRate, FrameValues& values) override;
+
+private:
+    STFTFrameCache::FramesPtr fluxFrames;   // Spectra of the current buffer, between prepare and release
+
+    // Marks energy frames that don't start a spectral frame; real flux is never negative
+    static constexpr float noFlux = -1.0f;
+
+    // Energy frames per shared spectral frame
+    static int getFluxFrameRatio(const FrameLayout& layout);
 };
 
 // ADSR Envelope Extractor
-class ADSREnvelopeExtractor : public FeatureExtractor {
+class ADSREnvelopeExtractor : public HopBasedExtractor {
 public:
     juce::String getName() const override { return "ADSR Envelope"; }
     juce::Colour getColor() const override { return juce::Colours::cyan; }
@@ -142,16 +339,20 @@ public:
         }
     }
 
-    // Standard extract from audio (can also work directly)
-    std::vector<std::vector<std::pair<double, double>>> extract(const juce::AudioBuffer<float>& buffer,
-        double sampleRate,
-        int channel = 0) override;
-
     // Convert from existing amplitude breakpoints
     std::vector<std::vector<std::pair<double, double>>> extractFromAmplitude(
         const std::vector<std::pair<double, double>>& amplitudeData,
         double sampleRate);
 
+protected:
+    // Standard extract from audio runs an RMS pass through HopBasedExtractor
+    FrameLayout getFrameLayout(juce::int64 numSamples, double sampleRate) const override;
+    int getNumFrameValues() const override { return 1; }
+    void computeFrames(const juce::AudioBuffer<float>& buffer, int channel,
+        const FrameLayout& layout, int firstFrame, int endFrame, FrameValues& values) override;
+    std::vector<std::vector<std::pair<double, double>>> finaliseFrames(
+        const FrameLayout& layout, double sampleRate, FrameValues& values) override;
+
 private:
     struct ADSRParams {
         double attackTime = 0.0;
@@ -0,0 +1,247 @@
+// ============================================================================
+// OnsetDetector.cpp
+// ============================================================================
+#include "OnsetDetector.h"
+#include "ParallelFor.h"
+#include "ScratchPool.h"
+#include "SIMDKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+OnsetDetector::Novelty OnsetDetector::computeNovelty(const juce::AudioBuffer<float>& input,
+    double sampleRate, STFTFrameCache* frameCache) const {
+
+    Novelty novelty;
+    if (sampleRate <= 0.0 || input.getNumChannels() == 0) return novelty;
+
+    STFTFrameCache::Config config;
+    config.fftSize = juce::nextPowerOfTwo(juce::jmax(64, static_cast<int>(sampleRate * settings.frameSeconds)));
+    config.hopSamples = config.fftSize / 4;
+
+    novelty.framesPerSecond = sampleRate / config.hopSamples;
+    novelty.frameOffsetSeconds = config.fftSize * 0.5 / sampleRate;
+
+    // Without a shared cache the frames are built for this call alone
+    STFTFrameCache localCache;
+    STFTFrameCache& cache = frameCache != nullptr ? *frameCache : localCache;
+
+    // A full-scale sine peaks near one after the Hann window's gain is taken out
+    const float magnitudeScale = 4.0f / config.fftSize;
+    const float compression = settings.compression;
+
+    for (int ch = 0; ch < input.getNumChannels(); ++ch) {
+        auto frames = cache.getFrames(input, ch, config, true);
+        if (frames == nullptr || frames->getNumFrames() == 0) return {};
+
+        const int numFrames = frames->getNumFrames();
+        const int numBins = frames->getNumBins();
+        novelty.values.resize(static_cast<size_t>(numFrames), 0.0f);
+
+        // Half-wave rectified difference of log magnitudes: only rising bins count,
+        // and the log keeps loud partials from drowning out the rest of the spectrum
+        ParallelFor::forEachChunk(numFrames, ParallelFor::chooseChunkSize(numFrames, 256), [&](int begin, int end) {
+            auto previous = ScratchPool::borrow<float>(static_cast<size_t>(numBins));
+            auto current = ScratchPool::borrow<float>(static_cast<size_t>(numBins));
+
+            auto compress = [&](int frame, ScratchPool::Block<float>& dest) {
+                const float* magnitudes = frames->getMagnitudes(frame);
+                for (int bin = 0; bin < numBins; ++bin)
+                    dest[static_cast<size_t>(bin)] = std::log1p(compression * magnitudeScale * magnitudes[bin]);
+            };
+
+            if (begin > 0) compress(begin - 1, previous);
+
+            for (int frame = begin; frame < end; ++frame) {
+                compress(frame, current);
+
+                float flux = 0.0f;
+                if (frame > 0) {
+                    for (int bin = 0; bin < numBins; ++bin)
+                        flux += std::max(0.0f, current[static_cast<size_t>(bin)] - previous[static_cast<size_t>(bin)]);
+                }
+
+                novelty.values[static_cast<size_t>(frame)] += flux;
+                std::swap(previous, current);
+            }
+        });
+    }
+
+    float peak = 0.0f;
+    for (float value : novelty.values)
+        peak = std::max(peak, value);
+
+    if (peak > 0.0f) {
+        for (float& value : novelty.values)
+            value /= peak;
+    }
+
+    return novelty;
+}
+
+std::vector<double> OnsetDetector::pickOnsets(const Novelty& novelty, double threshold) const {
+    std::vector<double> onsets;
+
+    const int numFrames = novelty.getNumFrames();
+    if (numFrames < 3) return onsets;
+
+    const auto& values = novelty.values;
+    const int medianRadius = juce::jmax(1, static_cast<int>(settings.medianSeconds * novelty.framesPerSecond));
+    const int minGap = juce::jmax(1, static_cast<int>(settings.minOnsetGapSeconds * novelty.framesPerSecond));
+    const int peakRadius = juce::jmax(1, minGap / 2);
+    const float margin = static_cast<float>(threshold * thresholdScale);
+
+    auto neighbourhood = ScratchPool::borrow<float>(static_cast<size_t>(2 * medianRadius + 1));
+    int lastOnset = -minGap;
+
+    for (int frame = 1; frame < numFrames - 1; ++frame) {
+        const float value = values[static_cast<size_t>(frame)];
+        if (value <= margin) continue;
+
+        // Highest in its neighbourhood; a flat top counts at its first frame
+        bool isPeak = true;
+        for (int other = juce::jmax(0, frame - peakRadius); other <= juce::jmin(numFrames - 1, frame + peakRadius) && isPeak; ++other) {
+            const float otherValue = values[static_cast<size_t>(other)];
+            isPeak = other < frame ? otherValue < value : otherValue <= value;
+        }
+
+        if (!isPeak || frame - lastOnset < minGap) continue;
+
+        const int first = juce::jmax(0, frame - medianRadius);
+        const int last = juce::jmin(numFrames, frame + medianRadius + 1);
+        float* neighbours = neighbourhood.data();
+        float* neighboursEnd = std::copy(values.begin() + first, values.begin() + last, neighbours);
+
+        float* middle = neighbours + (neighboursEnd - neighbours) / 2;
+        std::nth_element(neighbours, middle, neighboursEnd);
+
+        if (value < *middle + margin) continue;
+
+        onsets.push_back(novelty.getFrameTime(frame));
+        lastOnset = frame;
+    }
+
+    return onsets;
+}
+
+OnsetDetector::BeatTrack OnsetDetector::trackBeats(const Novelty& novelty) const {
+    BeatTrack track;
+
+    const int numFrames = novelty.getNumFrames();
+    const double period = estimatePeriod(novelty.values, novelty.framesPerSecond);
+    if (period <= 0.0 || numFrames < 2 * period) return track;
+
+    // Onset strength in units of its spread, so tightness means the same for any material
+    const auto& values = novelty.values;
+    const double mean = std::accumulate(values.begin(), values.end(), 0.0) / numFrames;
+    double variance = 0.0;
+    for (float value : values)
+        variance += (value - mean) * (value - mean);
+
+    const double spread = std::sqrt(variance / numFrames);
+    if (spread <= 0.0) return track;
+
+    // Dynamic programming: each frame's best score as a beat is its own strength
+    // plus the best earlier beat, penalised by how far the gap strays from the period
+    auto score = ScratchPool::borrow<double>(static_cast<size_t>(numFrames));
+    auto previousBeat = ScratchPool::borrow<int>(static_cast<size_t>(numFrames));
+    previousBeat.fill(-1);
+
+    const int shortestGap = juce::jmax(1, static_cast<int>(std::round(period * 0.5)));
+    const int longestGap = juce::jmax(shortestGap, static_cast<int>(std::round(period * 2.0)));
+
+    for (int frame = 0; frame < numFrames; ++frame) {
+        double best = 0.0;
+        int bestPrevious = -1;
+
+        for (int gap = shortestGap; gap <= longestGap && gap <= frame; ++gap) {
+            const double deviation = std::log(gap / period);
+            const double candidate = score[static_cast<size_t>(frame - gap)] - settings.tightness * deviation * deviation;
+
+            if (bestPrevious < 0 || candidate > best) {
+                best = candidate;
+                bestPrevious = frame - gap;
+            }
+        }
+
+        score[static_cast<size_t>(frame)] = values[static_cast<size_t>(frame)] / spread + std::max(0.0, best);
+        previousBeat[static_cast<size_t>(frame)] = best > 0.0 ? bestPrevious : -1;
+    }
+
+    // The sequence ends on the best-scoring frame within the last period
+    int beat = numFrames - 1;
+    for (int frame = juce::jmax(0, numFrames - static_cast<int>(period)); frame < numFrames; ++frame) {
+        if (score[static_cast<size_t>(frame)] > score[static_cast<size_t>(beat)])
+            beat = frame;
+    }
+
+    std::vector<int> beatFrames;
+    for (; beat >= 0; beat = previousBeat[static_cast<size_t>(beat)])
+        beatFrames.push_back(beat);
+    std::reverse(beatFrames.begin(), beatFrames.end());
+
+    if (beatFrames.size() < 2) return track;
+
+    for (int frame : beatFrames)
+        track.beats.push_back(novelty.getFrameTime(frame));
+
+    // Least-squares line through beat index and time
+    const double count = static_cast<double>(track.beats.size());
+    double sumIndex = 0.0, sumTime = 0.0, sumIndexTime = 0.0, sumIndexSquared = 0.0;
+    for (size_t i = 0; i < track.beats.size(); ++i) {
+        sumIndex += static_cast<double>(i);
+        sumTime += track.beats[i];
+        sumIndexTime += static_cast<double>(i) * track.beats[i];
+        sumIndexSquared += static_cast<double>(i) * static_cast<double>(i);
+    }
+
+    track.beatPeriod = (count * sumIndexTime - sumIndex * sumTime) / (count * sumIndexSquared - sumIndex * sumIndex);
+    track.firstBeat = (sumTime - track.beatPeriod * sumIndex) / count;
+    track.bpm = track.beatPeriod > 0.0 ? 60.0 / track.beatPeriod : 0.0;
+
+    return track;
+}
+
+double OnsetDetector::estimatePeriod(const std::vector<float>& values, double framesPerSecond) const {
+    const int numFrames = static_cast<int>(values.size());
+    if (numFrames == 0 || framesPerSecond <= 0.0) return 0.0;
+
+    const int minLag = juce::jmax(1, static_cast<int>(std::floor(framesPerSecond * 60.0 / settings.maxTempo)));
+    const int maxLag = juce::jmin(numFrames / 2, static_cast<int>(std::ceil(framesPerSecond * 60.0 / settings.minTempo)));
+    if (minLag + 1 >= maxLag) return 0.0;
+
+    const float mean = std::accumulate(values.begin(), values.end(), 0.0f) / numFrames;
+    auto centred = ScratchPool::borrow<float>(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        centred[i] = values[i] - mean;
+
+    auto weighted = ScratchPool::borrow<double>(static_cast<size_t>(maxLag + 2));
+    weighted.fill(0.0);
+
+    // Autocorrelation weighted by a log-Gaussian around the preferred tempo, an
+    // octave wide, so half and double tempo only win when they're clearly stronger
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag) {
+        if (lag < 1 || lag >= numFrames) continue;
+
+        const double correlation = SIMDKernels::dotProduct(centred.data(), centred.data() + lag, numFrames - lag)
+            / (numFrames - lag);
+        const double octaves = std::log2(framesPerSecond * 60.0 / lag / settings.preferredTempo);
+        weighted[static_cast<size_t>(lag)] = correlation * std::exp(-0.5 * octaves * octaves);
+    }
+
+    int best = minLag;
+    for (int lag = minLag; lag <= maxLag; ++lag) {
+        if (weighted[static_cast<size_t>(lag)] > weighted[static_cast<size_t>(best)])
+            best = lag;
+    }
+
+    if (weighted[static_cast<size_t>(best)] <= 0.0) return 0.0;
+
+    // Parabolic interpolation between lags for a period finer than one frame
+    const double left = weighted[static_cast<size_t>(best - 1)];
+    const double centre = weighted[static_cast<size_t>(best)];
+    const double right = weighted[static_cast<size_t>(best + 1)];
+    const double curvature = left - 2.0 * centre + right;
+
+    return curvature < 0.0 ? best + 0.5 * (left - right) / curvature : static_cast<double>(best);
+}
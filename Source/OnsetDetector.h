@@ -0,0 +1,65 @@
+// ============================================================================
+// OnsetDetector.h
+// Spectral-flux onsets with adaptive peak picking, plus beat tracking
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "STFTFrameCache.h"
+#include <vector>
+
+class OnsetDetector {
+public:
+    struct Settings {
+        double frameSeconds = 0.023;         // Rounded up to a power-of-two FFT, hopped by a quarter
+        float compression = 100.0f;          // Log compression of magnitudes before differencing
+        double medianSeconds = 0.1;          // Each side of a frame, for the adaptive threshold
+        double minOnsetGapSeconds = 0.03;    // Closer peaks are the same onset
+
+        double minTempo = 60.0;
+        double maxTempo = 200.0;
+        double preferredTempo = 120.0;       // Ties between tempo octaves lean towards this
+        double tightness = 100.0;            // How strongly beat spacing is held to the period
+    };
+
+    // Onset strength per STFT frame, normalised to a peak of one
+    struct Novelty {
+        std::vector<float> values;
+        double framesPerSecond = 0.0;
+        double frameOffsetSeconds = 0.0;     // Time of frame zero, the centre of its window
+
+        int getNumFrames() const { return static_cast<int>(values.size()); }
+        double getFrameTime(double frame) const { return frameOffsetSeconds + frame / framesPerSecond; }
+    };
+
+    struct BeatTrack {
+        double bpm = 0.0;                    // 0 if no steady pulse was found
+        std::vector<double> beats;           // Seconds
+
+        // Straight line through the beats, so tempo maps aren't built from frame jitter
+        double firstBeat = 0.0;
+        double beatPeriod = 0.0;
+    };
+
+    Settings settings;
+
+    // Summed over channels. Spectra come from frameCache when one is given, so
+    // it must only ever see buffers that stay put while their entries live.
+    Novelty computeNovelty(const juce::AudioBuffer<float>& input, double sampleRate,
+        STFTFrameCache* frameCache = nullptr) const;
+
+    // Peaks that rise threshold * thresholdScale above the median of their
+    // neighbourhood, so quiet passages still yield onsets and dense ones don't
+    // all merge. Returns seconds.
+    std::vector<double> pickOnsets(const Novelty& novelty, double threshold) const;
+
+    // Tempo from the novelty's autocorrelation, then the beat sequence that best
+    // balances landing on onsets against keeping that period
+    BeatTrack trackBeats(const Novelty& novelty) const;
+
+    static constexpr double thresholdScale = 0.2;
+
+private:
+    double estimatePeriod(const std::vector<float>& values, double framesPerSecond) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OnsetDetector)
+};
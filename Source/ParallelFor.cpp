@@ -0,0 +1,79 @@
+// ============================================================================
+// ParallelFor.cpp
+// ============================================================================
+#include "ParallelFor.h"
+#include <atomic>
+#include <memory>
+
+namespace {
+
+struct ChunkState {
+    std::function<void(int, int)> fn;
+    int numItems = 0;
+    int itemsPerChunk = 1;
+    int numChunks = 0;
+    std::atomic<int> nextChunk{ 0 };
+    std::atomic<int> completedChunks{ 0 };
+    juce::WaitableEvent allDone;
+};
+
+// Claims chunks until none are left. Helpers that start after the caller has
+// returned find nothing to claim, so fn is never called on a stale state.
+void drainChunks(ChunkState& state) {
+    for (;;) {
+        int chunk = state.nextChunk.fetch_add(1);
+        if (chunk >= state.numChunks) return;
+
+        int begin = chunk * state.itemsPerChunk;
+        int end = std::min(state.numItems, begin + state.itemsPerChunk);
+        state.fn(begin, end);
+
+        if (state.completedChunks.fetch_add(1) + 1 == state.numChunks)
+            state.allDone.signal();
+    }
+}
+
+} // namespace
+
+void ParallelFor::forEachChunk(int numItems, int itemsPerChunk,
+    const std::function<void(int begin, int end)>& fn) {
+
+    if (numItems <= 0) return;
+
+    itemsPerChunk = juce::jmax(1, itemsPerChunk);
+    int numChunks = (numItems + itemsPerChunk - 1) / itemsPerChunk;
+
+    if (numChunks == 1) {
+        fn(0, numItems);
+        return;
+    }
+
+    auto state = std::make_shared<ChunkState>();
+    state->fn = fn;
+    state->numItems = numItems;
+    state->itemsPerChunk = itemsPerChunk;
+    state->numChunks = numChunks;
+
+    auto& pool = getSharedPool();
+    int numHelpers = juce::jmin(numChunks - 1, pool.getNumThreads());
+
+    for (int i = 0; i < numHelpers; ++i)
+        pool.addJob([state] { drainChunks(*state); });
+
+    drainChunks(*state);
+    state->allDone.wait();
+}
+
+int ParallelFor::chooseChunkSize(int numItems, int minItemsPerChunk) {
+    int targetChunks = getNumWorkers() * 4;
+    return juce::jmax(juce::jmax(1, minItemsPerChunk), (numItems + targetChunks - 1) / targetChunks);
+}
+
+juce::ThreadPool& ParallelFor::getSharedPool() {
+    static juce::ThreadPool pool(getNumWorkers());
+    return pool;
+}
+
+int ParallelFor::getNumWorkers() {
+    return juce::jmax(1, juce::SystemStats::getNumCpus());
+}
@@ -0,0 +1,22 @@
+// ============================================================================
+// ParallelFor.h
+// Chunked parallel loops on a shared worker pool
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+
+class ParallelFor {
+public:
+    // Splits [0, numItems) into chunks of itemsPerChunk and runs fn(begin, end) for each.
+    // The calling thread works through chunks too, so this is safe to call from a pool
+    // worker and simply runs serially when no workers are free.
+    static void forEachChunk(int numItems, int itemsPerChunk,
+        const std::function<void(int begin, int end)>& fn);
+
+    // Picks a chunk size giving each worker a few chunks to balance uneven work
+    static int chooseChunkSize(int numItems, int minItemsPerChunk = 64);
+
+    static juce::ThreadPool& getSharedPool();
+    static int getNumWorkers();
+};
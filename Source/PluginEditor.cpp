@@ -160,6 +160,8 @@ AudioWorkshopEditor::AudioWorkshopEditor(AudioWorkshopProcessor& p)
     editOperationSelector.addItem("Time Stretch", 4);
     editOperationSelector.addItem("Quantize Audio", 5);
     editOperationSelector.addItem("Humanize", 6);
+    editOperationSelector.addItem("Snap to Grid", 7);
+    editOperationSelector.addItem("Detect Tempo", 8);
     editOperationSelector.setSelectedId(1);
     editOperationSelector.addListener(this);
     addAndMakeVisible(editOperationSelector);
@@ -168,6 +170,16 @@ AudioWorkshopEditor::AudioWorkshopEditor(AudioWorkshopProcessor& p)
     performEditButton.addListener(this);
     addAndMakeVisible(performEditButton);
 
+    undoEditButton.setButtonText("Undo");
+    undoEditButton.addListener(this);
+    undoEditButton.setEnabled(false);
+    addAndMakeVisible(undoEditButton);
+
+    redoEditButton.setButtonText("Redo");
+    redoEditButton.addListener(this);
+    redoEditButton.setEnabled(false);
+    addAndMakeVisible(redoEditButton);
+
     saveBreakpointsButton.setButtonText("Save Breakpoints");
     saveBreakpointsButton.addListener(this);
     addAndMakeVisible(saveBreakpointsButton);
@@ -198,6 +210,11 @@ AudioWorkshopEditor::AudioWorkshopEditor(AudioWorkshopProcessor& p)
     applyButton.addListener(this);
     addAndMakeVisible(applyButton);
 
+    liveToggle.setButtonText("Live");
+    liveToggle.setToggleState(processor.getRealtimeFeature().isNotEmpty(), juce::dontSendNotification);
+    liveToggle.addListener(this);
+    addAndMakeVisible(liveToggle);
+
     exportBreakpointsButton.setButtonText("Export Breakpoints");
     exportBreakpointsButton.addListener(this);
     addAndMakeVisible(exportBreakpointsButton);
@@ -206,10 +223,31 @@ AudioWorkshopEditor::AudioWorkshopEditor(AudioWorkshopProcessor& p)
     exportAudioButton.addListener(this);
     addAndMakeVisible(exportAudioButton);
 
+    exportFormatLabel.setText("Export as:", juce::dontSendNotification);
+    addAndMakeVisible(exportFormatLabel);
+
+    exportFormatSelector.addItem("WAV 16-bit", 1);
+    exportFormatSelector.addItem("WAV 24-bit", 2);
+    exportFormatSelector.addItem("WAV 32-bit float", 3);
+    exportFormatSelector.addItem("AIFF 16-bit", 4);
+    exportFormatSelector.addItem("AIFF 24-bit", 5);
+    exportFormatSelector.addItem("FLAC 16-bit", 6);
+    exportFormatSelector.addItem("FLAC 24-bit", 7);
+    exportFormatSelector.setSelectedId(2);
+    addAndMakeVisible(exportFormatSelector);
+
     clearAllButton.setButtonText("Clear All");
     clearAllButton.addListener(this);
     addAndMakeVisible(clearAllButton);
 
+    telemetryToggle.setButtonText("Stats");
+    telemetryToggle.addListener(this);
+    addAndMakeVisible(telemetryToggle);
+
+    saveTraceButton.setButtonText("Save Trace");
+    saveTraceButton.addListener(this);
+    addAndMakeVisible(saveTraceButton);
+
     // ========================================================================
     // STATUS LABELS
     // ========================================================================
@@ -226,6 +264,19 @@ AudioWorkshopEditor::AudioWorkshopEditor(AudioWorkshopProcessor& p)
     applicationStatusLabel.setColour(juce::Label::textColourId, juce::Colours::grey);
     addAndMakeVisible(applicationStatusLabel);
 
+    // ========================================================================
+    // DRAWING LAYERS
+    // ========================================================================
+
+    addAndMakeVisible(sourceWaveformLayer);
+    addAndMakeVisible(targetWaveformLayer);
+    addAndMakeVisible(gridLayer);
+    addAndMakeVisible(curveLayer);
+    addAndMakeVisible(overlayLayer);
+
+    // Above the layers, hidden until the toggle shows it
+    addChildComponent(telemetryOverlay);
+
     startTimerHz(30);
 }
 
@@ -234,6 +285,8 @@ AudioWorkshopEditor::~AudioWorkshopEditor() {
 }
 
 void AudioWorkshopEditor::paint(juce::Graphics& g) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::Paint, "Paint editor");
+
     g.fillAll(juce::Colour(0xff1a1a1a));
 
     // Title
@@ -242,21 +295,7 @@ void AudioWorkshopEditor::paint(juce::Graphics& g) {
     g.drawText("Audio Workshop", getLocalBounds().removeFromTop(40),
         juce::Justification::centred);
 
-    // Draw source waveform
-    if (processor.hasSourceAudio()) {
-        drawSourceWaveform(g, sourceWaveformBounds);
-    }
-
-    // Draw target waveform
-    if (processor.hasTargetAudio()) {
-        drawTargetWaveform(g, targetWaveformBounds);
-    }
-
-    // Draw breakpoint graph
-    drawGraphBackground(g, breakpointGraphBounds);
-    if (!displayedBreakpoints.empty()) {
-        drawBreakpoints(g, breakpointGraphBounds);
-    }
+    // Waveforms and the breakpoint graph are drawn by their layers
 }
 
 void AudioWorkshopEditor::resized() {
@@ -273,10 +312,12 @@ void AudioWorkshopEditor::resized() {
     loadSourceButton.setBounds(sourceCol.removeFromTop(30));
     sourceInfoLabel.setBounds(sourceCol.removeFromTop(25));
     sourceWaveformBounds = sourceCol.reduced(2);
+    sourceWaveformLayer.setBounds(sourceWaveformBounds);
 
     loadTargetButton.setBounds(targetCol.removeFromTop(30));
     targetInfoLabel.setBounds(targetCol.removeFromTop(25));
     targetWaveformBounds = targetCol.reduced(2);
+    targetWaveformLayer.setBounds(targetWaveformBounds);
 
     // ========================================================================
     // FEATURE EXTRACTION ROW
@@ -308,6 +349,11 @@ void AudioWorkshopEditor::resized() {
     // BREAKPOINT GRAPH AREA
     // ========================================================================
     breakpointGraphBounds = area.removeFromTop(250).reduced(10, 5);
+    gridLayer.setBounds(breakpointGraphBounds);
+    curveLayer.setBounds(breakpointGraphBounds);
+    overlayLayer.setBounds(breakpointGraphBounds);
+    telemetryOverlay.setBounds(breakpointGraphBounds.reduced(8).removeFromRight(320)
+        .removeFromTop(TelemetryOverlay::getIdealHeight()));
 
     // ========================================================================
     // BREAKPOINT CONTROLS ROW
@@ -340,6 +386,8 @@ void AudioWorkshopEditor::resized() {
     editOperationSelector.setBounds(editRow.removeFromLeft(150));
     editRow.removeFromLeft(10);
     performEditButton.setBounds(editRow.removeFromLeft(110));
+    undoEditButton.setBounds(editRow.removeFromLeft(55));
+    redoEditButton.setBounds(editRow.removeFromLeft(55));
     editRow.removeFromLeft(10);
     saveBreakpointsButton.setBounds(editRow.removeFromLeft(130));
     loadBreakpointsButton.setBounds(editRow.removeFromLeft(130));
@@ -354,6 +402,7 @@ void AudioWorkshopEditor::resized() {
     smoothingToggle.setBounds(appRow.removeFromLeft(100));
     appRow.removeFromLeft(10);
     applyButton.setBounds(appRow.removeFromLeft(120));
+    liveToggle.setBounds(appRow.removeFromLeft(60));
     appRow.removeFromLeft(10);
     exportBreakpointsButton.setBounds(appRow.removeFromLeft(140));
     exportAudioButton.setBounds(appRow.removeFromLeft(110));
@@ -363,6 +412,12 @@ void AudioWorkshopEditor::resized() {
     // ========================================================================
     auto clearRow = area.removeFromTop(35).reduced(5);
     clearAllButton.setBounds(clearRow.removeFromLeft(100));
+    clearRow.removeFromLeft(20);
+    exportFormatLabel.setBounds(clearRow.removeFromLeft(70));
+    exportFormatSelector.setBounds(clearRow.removeFromLeft(150));
+    clearRow.removeFromLeft(20);
+    telemetryToggle.setBounds(clearRow.removeFromLeft(70));
+    saveTraceButton.setBounds(clearRow.removeFromLeft(100));
 
     // ========================================================================
     // STATUS ROW
@@ -374,8 +429,51 @@ void AudioWorkshopEditor::resized() {
 }
 
 void AudioWorkshopEditor::timerCallback() {
+    bool analysisRunning = processor.isAnalysisRunning();
+
+    if (analysisRunning) {
+        statusLabel.setText("Analyzing... " +
+            juce::String(juce::roundToInt(processor.getAnalysisProgress() * 100.0f)) + "%",
+            juce::dontSendNotification);
+    }
+    else if (analysisWasRunning) {
+        // Jobs have published their results - pick them up on the message thread
+        if (pendingFeature.isNotEmpty() && processor.isFeatureExtracted(pendingFeature)) {
+            currentFeature = pendingFeature;
+            updateOutputSelector();
+            statusLabel.setText("Extracted: " + pendingFeature, juce::dontSendNotification);
+        }
+        else {
+            statusLabel.setText("Analysis cancelled", juce::dontSendNotification);
+        }
+        pendingFeature.clear();
+    }
+
+    analysisWasRunning = analysisRunning;
+
+    bool renderRunning = processor.isProcessing();
+
+    if (renderRunning) {
+        statusLabel.setText((pendingExportFile != juce::File() ? "Exporting... " : "Applying... ") +
+            juce::String(juce::roundToInt(processor.getProcessingProgress() * 100.0f)) + "%",
+            juce::dontSendNotification);
+    }
+    else if (renderWasRunning) {
+        if (pendingExportFile != juce::File()) {
+            statusLabel.setText(processor.didProcessingComplete() ? "Exported: " + pendingExportFile.getFileName()
+                : "Export failed", juce::dontSendNotification);
+            pendingExportFile = juce::File();
+        }
+        else {
+            statusLabel.setText(processor.didProcessingComplete() ? "Applied! Ready to export" : "Apply cancelled",
+                juce::dontSendNotification);
+        }
+    }
+
+    renderWasRunning = renderRunning;
+
     updateStatus();
-    repaint();
+    refreshWaveformLayers();
 }
 
 // ========================================================================
@@ -383,47 +481,46 @@ void AudioWorkshopEditor::timerCallback() {
 // ========================================================================
 
 void AudioWorkshopEditor::drawSourceWaveform(juce::Graphics& g, const juce::Rectangle<int>& area) {
-    const auto& buffer = processor.getSourceAudio();
-    if (buffer.getNumSamples() == 0) return;
-
-    g.setColour(juce::Colours::lightblue.withAlpha(0.7f));
+    drawWaveformOverview(g, area, processor.getSourceOverview(),
+        juce::Colours::lightblue.withAlpha(0.7f));
+}
 
-    const float* data = buffer.getReadPointer(0);
-    int numSamples = buffer.getNumSamples();
-    int step = juce::jmax(1, numSamples / area.getWidth());
+void AudioWorkshopEditor::drawTargetWaveform(juce::Graphics& g, const juce::Rectangle<int>& area) {
+    drawWaveformOverview(g, area, processor.getTargetOverview(),
+        juce::Colours::lightgreen.withAlpha(0.7f));
+}
 
-    juce::Path path;
-    path.startNewSubPath(area.getX(), area.getCentreY());
+void AudioWorkshopEditor::drawWaveformOverview(juce::Graphics& g, const juce::Rectangle<int>& area,
+    const WaveformOverview& overview, juce::Colour colour) {
 
-    for (int i = 0; i < numSamples; i += step) {
-        float x = area.getX() + (i * area.getWidth() / static_cast<float>(numSamples));
-        float y = area.getCentreY() - (data[i] * area.getHeight() * 0.45f);
-        path.lineTo(x, y);
-    }
+    if (overview.isEmpty() || area.isEmpty()) return;
 
-    g.strokePath(path, juce::PathStrokeType(1.5f));
+    g.setColour(colour);
+    overview.draw(g, area, 0, overview.getNumSamples());
 }
 
-void AudioWorkshopEditor::drawTargetWaveform(juce::Graphics& g, const juce::Rectangle<int>& area) {
-    const auto& buffer = processor.getTargetAudio();
-    if (buffer.getNumSamples() == 0) return;
-
-    g.setColour(juce::Colours::lightgreen.withAlpha(0.7f));
+void AudioWorkshopEditor::refreshWaveformLayers() {
+    // Loading or clearing bumps an overview's version; nothing else changes the waveforms
+    int sourceVersion = processor.getSourceOverview().getVersion();
+    if (sourceVersion != drawnSourceVersion) {
+        drawnSourceVersion = sourceVersion;
+        sourceWaveformLayer.invalidate();
+    }
 
-    const float* data = buffer.getReadPointer(0);
-    int numSamples = buffer.getNumSamples();
-    int step = juce::jmax(1, numSamples / area.getWidth());
+    int targetVersion = processor.getTargetOverview().getVersion();
+    if (targetVersion != drawnTargetVersion) {
+        drawnTargetVersion = targetVersion;
+        targetWaveformLayer.invalidate();
+    }
+}
 
-    juce::Path path;
-    path.startNewSubPath(area.getX(), area.getCentreY());
+void AudioWorkshopEditor::drawGridLayer(juce::Graphics& g, const juce::Rectangle<int>& area) {
+    drawGraphBackground(g, area);
 
-    for (int i = 0; i < numSamples; i += step) {
-        float x = area.getX() + (i * area.getWidth() / static_cast<float>(numSamples));
-        float y = area.getCentreY() - (data[i] * area.getHeight() * 0.45f);
-        path.lineTo(x, y);
+    if (!displayedBreakpoints.empty()) {
+        auto mapping = getGraphMapping();
+        drawMusicalGrid(g, area, mapping.startTime, mapping.endTime);
     }
-
-    g.strokePath(path, juce::PathStrokeType(1.5f));
 }
 
 void AudioWorkshopEditor::drawGraphBackground(juce::Graphics& g, const juce::Rectangle<int>& area) {
@@ -453,63 +550,95 @@ void AudioWorkshopEditor::drawGraphBackground(juce::Graphics& g, const juce::Rec
         static_cast<float>(area.getRight()));
 }
 
+void AudioWorkshopEditor::drawMusicalGrid(juce::Graphics& g, const juce::Rectangle<int>& area,
+    double startSeconds, double endSeconds) {
+    if (!processor.timeLattice || area.getWidth() <= 0 || endSeconds <= startSeconds) return;
+
+    // Lines closer than a few pixels are skipped by the range's stride,
+    // so the cost is bounded by the width, not the length of the session
+    const double secondsPerPixel = (endSeconds - startSeconds) / area.getWidth();
+    const float top = static_cast<float>(area.getY());
+    const float bottom = static_cast<float>(area.getBottom());
+
+    auto drawLines = [&](GridUnit unit, double minPixels, juce::Colour colour) {
+        g.setColour(colour);
+        for (double time : processor.timeLattice->getGridForZoom(unit, startSeconds, endSeconds,
+            minPixels * secondsPerPixel)) {
+            int x = area.getX() + static_cast<int>((time - startSeconds) / secondsPerPixel);
+            g.drawVerticalLine(x, top, bottom);
+        }
+    };
+
+    drawLines(GridUnit::Beats, 8.0, juce::Colour(0xff303840));
+    drawLines(GridUnit::Bars, 24.0, juce::Colour(0xff3c4a58));
+}
+
 void AudioWorkshopEditor::drawBreakpoints(juce::Graphics& g, const juce::Rectangle<int>& area) {
-    if (displayedBreakpoints.empty()) return;
+    if (displayedBreakpoints.empty() || area.getWidth() <= 0) return;
 
-    // Calculate bounds
-    float maxTime = 0.0f;
-    float minValue = 1e10f;
-    float maxValue = -1e10f;
+    auto mapping = getGraphMapping();
 
-    for (const auto& [time, value] : displayedBreakpoints) {
-        maxTime = juce::jmax(maxTime, time);
-        minValue = juce::jmin(minValue, value);
-        maxValue = juce::jmax(maxValue, value);
-    }
+    // Zoomed in, the curve runs on past the edges of the graph
+    juce::Graphics::ScopedSaveState state(g);
+    g.reduceClipRegion(area);
 
-    if (maxTime <= 0.0f) maxTime = 1.0f;
-    float valueRange = maxValue - minValue;
-    if (valueRange < 0.001f) {
-        valueRange = 1.0f;
-        minValue = maxValue - 0.5f;
-    }
+    // Only the visible points, plus one either side so the curve reaches the edges
+    auto visible = breakpointIndex.getIndexRange(mapping.startTime, mapping.endTime);
+    const size_t first = visible.getStart() > 0 ? visible.getStart() - 1 : 0;
+    const size_t last = juce::jmin(visible.getEnd() + 1, displayedBreakpoints.size());
+    const double secondsPerPixel = (mapping.endTime - mapping.startTime) / area.getWidth();
 
-    // Draw curve
     juce::Path curvePath;
-    bool firstPoint = true;
-
-    for (const auto& [time, value] : displayedBreakpoints) {
-        float x = area.getX() + (time / maxTime) * area.getWidth();
-        float normalizedValue = (value - minValue) / valueRange;
-        float y = area.getY() + area.getHeight() * (1.0f - normalizedValue);
 
-        if (firstPoint) {
+    auto addToPath = [&](float x, float y) {
+        if (curvePath.isEmpty())
             curvePath.startNewSubPath(x, y);
-            firstPoint = false;
+        else
+            curvePath.lineTo(x, y);
+    };
+
+    auto addPoint = [&](size_t i) {
+        auto point = displayedBreakpoints[i];
+        addToPath(mapping.timeToX(point.time, area), mapping.valueToY(point.value, area));
+    };
+
+    // Draw curve, one pixel column at a time. A crowded column becomes a single
+    // vertical stroke over its value span rather than a point-by-point zigzag.
+    for (size_t i = first; i < last;) {
+        double column = std::floor((displayedBreakpoints[i].time - mapping.startTime) / secondsPerPixel);
+        double columnEnd = mapping.startTime + (column + 1.0) * secondsPerPixel;
+        size_t columnLast = juce::jlimit(i + 1, last,
+            breakpointIndex.getIndexRange(displayedBreakpoints[i].time, columnEnd).getEnd());
+
+        if (columnLast - i <= 3) {
+            for (size_t j = i; j < columnLast; ++j)
+                addPoint(j);
         }
         else {
-            curvePath.lineTo(x, y);
+            double minValue, maxValue;
+            breakpointIndex.getValueRange(i, columnLast, minValue, maxValue);
+            float x = mapping.timeToX(displayedBreakpoints[i].time, area);
+
+            addPoint(i);
+            addToPath(x, mapping.valueToY(minValue, area));
+            addToPath(x, mapping.valueToY(maxValue, area));
+            addPoint(columnLast - 1);
         }
+
+        i = columnLast;
     }
 
     g.setColour(juce::Colours::cyan.withAlpha(0.8f));
     g.strokePath(curvePath, juce::PathStrokeType(2.5f));
 
-    // Draw breakpoint markers
-    for (size_t i = 0; i < displayedBreakpoints.size(); ++i) {
-        const auto& [time, value] = displayedBreakpoints[i];
-        float x = area.getX() + (time / maxTime) * area.getWidth();
-        float normalizedValue = (value - minValue) / valueRange;
-        float y = area.getY() + area.getHeight() * (1.0f - normalizedValue);
-
-        // Highlight dragged point
-        if (i == draggedBreakpoint.index && isDragging) {
-            g.setColour(juce::Colours::red);
-            g.fillEllipse(x - 8, y - 8, 16, 16);
-            g.setColour(juce::Colours::white);
-            g.drawEllipse(x - 8, y - 8, 16, 16, 2.0f);
-        }
-        else {
+    // Draw breakpoint markers, once they are far enough apart to pick out.
+    // The dragged point is highlighted by the overlay layer.
+    if ((last - first) * 8 <= static_cast<size_t>(area.getWidth())) {
+        for (size_t i = first; i < last; ++i) {
+            auto point = displayedBreakpoints[i];
+            float x = mapping.timeToX(point.time, area);
+            float y = mapping.valueToY(point.value, area);
+
             g.setColour(juce::Colours::yellow);
             g.fillEllipse(x - 6, y - 6, 12, 12);
             g.setColour(juce::Colours::black);
@@ -518,6 +647,103 @@ void AudioWorkshopEditor::drawBreakpoints(juce::Graphics& g, const juce::Rectang
     }
 }
 
+void AudioWorkshopEditor::drawDragOverlay(juce::Graphics& g, const juce::Rectangle<int>& area) {
+    if (!isDragging || !juce::isPositiveAndBelow(draggedBreakpoint.index,
+        static_cast<int>(displayedBreakpoints.size()))) return;
+
+    auto mapping = getGraphMapping();
+    auto point = displayedBreakpoints[static_cast<size_t>(draggedBreakpoint.index)];
+    float x = mapping.timeToX(point.time, area);
+    float y = mapping.valueToY(point.value, area);
+
+    // Highlight dragged point
+    g.setColour(juce::Colours::red);
+    g.fillEllipse(x - 8, y - 8, 16, 16);
+    g.setColour(juce::Colours::white);
+    g.drawEllipse(x - 8, y - 8, 16, 16, 2.0f);
+}
+
+void AudioWorkshopEditor::invalidateGraphLayers() {
+    // The grid only moves with the mapping; the curve changes with every edit
+    auto mapping = getGraphMapping();
+    if (mapping != drawnMapping) {
+        drawnMapping = mapping;
+        gridLayer.invalidate();
+    }
+
+    curveLayer.invalidate();
+    overlayLayer.invalidate();
+}
+
+juce::Rectangle<int> AudioWorkshopEditor::getPointDirtyArea(int index) const {
+    if (!juce::isPositiveAndBelow(index, static_cast<int>(displayedBreakpoints.size()))) return {};
+
+    auto mapping = getGraphMapping();
+    size_t i = static_cast<size_t>(index);
+    size_t previous = i > 0 ? i - 1 : i;
+    size_t next = juce::jmin(i + 1, displayedBreakpoints.size() - 1);
+
+    // Covers the largest marker plus the stroke width
+    const int margin = 10;
+    int left = static_cast<int>(std::floor(mapping.timeToX(displayedBreakpoints[previous].time, breakpointGraphBounds)));
+    int right = static_cast<int>(std::ceil(mapping.timeToX(displayedBreakpoints[next].time, breakpointGraphBounds)));
+
+    return juce::Rectangle<int>::leftTopRightBottom(left - margin, breakpointGraphBounds.getY(),
+        right + margin, breakpointGraphBounds.getBottom());
+}
+
+// ========================================================================
+// GRAPH MAPPING
+// ========================================================================
+
+AudioWorkshopEditor::GraphMapping AudioWorkshopEditor::getGraphMapping() const {
+    GraphMapping mapping;
+    if (displayedBreakpoints.empty()) return mapping;
+
+    mapping.hasCurve = true;
+
+    // Sorted, so the last point ends the curve
+    double lastTime = displayedBreakpoints[displayedBreakpoints.size() - 1].time;
+    mapping.endTime = lastTime > 0.0 ? lastTime : 1.0;
+
+    double minValue, maxValue;
+    if (breakpointIndex.getValueRange(0, breakpointIndex.size(), minValue, maxValue)) {
+        mapping.minValue = minValue;
+        mapping.valueRange = maxValue - minValue;
+
+        if (mapping.valueRange < 0.001) {
+            mapping.valueRange = 1.0;
+            mapping.minValue = maxValue - 0.5;
+        }
+    }
+
+    // The value scale always covers the whole curve, so zooming doesn't rescale it
+    if (!zoomedTimeRange.isEmpty()) {
+        mapping.startTime = zoomedTimeRange.getStart();
+        mapping.endTime = zoomedTimeRange.getEnd();
+    }
+
+    return mapping;
+}
+
+float AudioWorkshopEditor::GraphMapping::timeToX(double time, const juce::Rectangle<int>& area) const {
+    return static_cast<float>(area.getX() + (time - startTime) / (endTime - startTime) * area.getWidth());
+}
+
+float AudioWorkshopEditor::GraphMapping::valueToY(double value, const juce::Rectangle<int>& area) const {
+    double normalizedValue = (value - minValue) / valueRange;
+    return static_cast<float>(area.getY() + area.getHeight() * (1.0 - normalizedValue));
+}
+
+double AudioWorkshopEditor::GraphMapping::xToTime(float x, const juce::Rectangle<int>& area) const {
+    return startTime + (x - area.getX()) / static_cast<double>(area.getWidth()) * (endTime - startTime);
+}
+
+double AudioWorkshopEditor::GraphMapping::yToValue(float y, const juce::Rectangle<int>& area) const {
+    double normalizedValue = 1.0 - (y - area.getY()) / static_cast<double>(area.getHeight());
+    return minValue + normalizedValue * valueRange;
+}
+
 // ========================================================================
 // MOUSE INTERACTION
 // ========================================================================
@@ -530,6 +756,7 @@ void AudioWorkshopEditor::mouseDown(const juce::MouseEvent& event) {
                 draggedBreakpoint.index = index;
                 draggedBreakpoint.dragStartPosition = event.position;
                 isDragging = true;
+                overlayLayer.invalidate();
             }
         }
         else if (event.mods.isRightButtonDown()) {
@@ -547,6 +774,7 @@ void AudioWorkshopEditor::mouseDrag(const juce::MouseEvent& event) {
 void AudioWorkshopEditor::mouseUp(const juce::MouseEvent&) {
     if (isDragging) {
         isDragging = false;
+        overlayLayer.invalidate();
         statusLabel.setText("Breakpoint updated", juce::dontSendNotification);
     }
 }
@@ -557,6 +785,31 @@ void AudioWorkshopEditor::mouseDoubleClick(const juce::MouseEvent& event) {
     }
 }
 
+void AudioWorkshopEditor::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) {
+    if (!breakpointGraphBounds.contains(event.getPosition()) || displayedBreakpoints.empty()
+        || wheel.deltaY == 0.0f) return;
+
+    // Zoom the time axis about the cursor
+    auto mapping = getGraphMapping();
+    double anchor = mapping.xToTime(event.position.x, breakpointGraphBounds);
+    double scale = wheel.deltaY > 0.0f ? 0.8 : 1.25;
+
+    double lastTime = displayedBreakpoints[displayedBreakpoints.size() - 1].time;
+    double fullLength = lastTime > 0.0 ? lastTime : 1.0;
+    double length = (mapping.endTime - mapping.startTime) * scale;
+
+    if (length >= fullLength) {
+        zoomedTimeRange = {};
+    }
+    else {
+        double start = anchor - (anchor - mapping.startTime) * scale;
+        start = juce::jlimit(0.0, fullLength - length, start);
+        zoomedTimeRange = { start, start + length };
+    }
+
+    invalidateGraphLayers();
+}
+
 // ========================================================================
 // FILE DRAG AND DROP
 // ========================================================================
@@ -564,7 +817,8 @@ void AudioWorkshopEditor::mouseDoubleClick(const juce::MouseEvent& event) {
 bool AudioWorkshopEditor::isInterestedInFileDrag(const juce::StringArray& files) {
     for (const auto& file : files) {
         if (file.endsWithIgnoreCase(".wav") || file.endsWithIgnoreCase(".aif") ||
-            file.endsWithIgnoreCase(".aiff") || file.endsWithIgnoreCase(".txt")) {
+            file.endsWithIgnoreCase(".aiff") || file.endsWithIgnoreCase(".txt") ||
+            file.endsWithIgnoreCase(BreakpointFile::fileExtension)) {
             return true;
         }
     }
@@ -573,7 +827,7 @@ bool AudioWorkshopEditor::isInterestedInFileDrag(const juce::StringArray& files)
 
 void AudioWorkshopEditor::filesDropped(const juce::StringArray& files, int, int) {
     for (const auto& file : files) {
-        if (file.endsWithIgnoreCase(".txt")) {
+        if (file.endsWithIgnoreCase(".txt") || file.endsWithIgnoreCase(BreakpointFile::fileExtension)) {
             if (processor.loadBreakpointFile(juce::File(file))) {
                 statusLabel.setText("Loaded breakpoints: " + juce::File(file).getFileName(),
                     juce::dontSendNotification);
@@ -599,7 +853,7 @@ void AudioWorkshopEditor::filesDropped(const juce::StringArray& files, int, int)
             }
         }
     }
-    repaint();
+    refreshWaveformLayers();
 }
 
 // ========================================================================
@@ -609,12 +863,16 @@ void AudioWorkshopEditor::filesDropped(const juce::StringArray& files, int, int)
 void AudioWorkshopEditor::comboBoxChanged(juce::ComboBox* combo) {
     if (combo == &featureSelector) {
         currentFeature = featureSelector.getText();
+        zoomedTimeRange = {};
         updateOutputSelector();
         updateBreakpointDisplay();
+        if (liveToggle.getToggleState()) updateLiveCurve();
     }
     else if (combo == &outputSelector) {
         currentOutput = outputSelector.getSelectedId() - 1;
+        zoomedTimeRange = {};
         updateBreakpointDisplay();
+        if (liveToggle.getToggleState()) updateLiveCurve();
     }
     else if (combo == &ppqnSelector) {
         int ppqnValues[] = { 24, 48, 96, 192, 384, 480, 960 };
@@ -678,6 +936,9 @@ void AudioWorkshopEditor::buttonClicked(juce::Button* button) {
     else if (button == &applyButton) {
         applyBreakpointsToTarget();
     }
+    else if (button == &liveToggle) {
+        updateLiveCurve();
+    }
     else if (button == &exportBreakpointsButton) {
         exportCurrentBreakpoints();
     }
@@ -687,9 +948,27 @@ void AudioWorkshopEditor::buttonClicked(juce::Button* button) {
     else if (button == &performEditButton) {
         performSelectedEdit();
     }
+    else if (button == &undoEditButton) {
+        statusLabel.setText(processor.undoEdit() ? "Edit undone" : "Nothing to undo",
+            juce::dontSendNotification);
+        updateStatus();
+        refreshWaveformLayers();
+    }
+    else if (button == &redoEditButton) {
+        statusLabel.setText(processor.redoEdit() ? "Edit redone" : "Nothing to redo",
+            juce::dontSendNotification);
+        updateStatus();
+        refreshWaveformLayers();
+    }
     else if (button == &clearAllButton) {
         clearAll();
     }
+    else if (button == &telemetryToggle) {
+        telemetryOverlay.setVisible(telemetryToggle.getToggleState());
+    }
+    else if (button == &saveTraceButton) {
+        saveTelemetryTrace();
+    }
 }
 
 void AudioWorkshopEditor::sliderValueChanged(juce::Slider* slider) {
@@ -717,7 +996,7 @@ void AudioWorkshopEditor::loadSourceAudio() {
                         juce::dontSendNotification);
                     statusLabel.setText("Ready to extract features",
                         juce::dontSendNotification);
-                    repaint();
+                    refreshWaveformLayers();
                 }
             }
         });
@@ -740,7 +1019,7 @@ void AudioWorkshopEditor::loadTargetAudio() {
                         juce::dontSendNotification);
                     statusLabel.setText("Ready to apply breakpoints",
                         juce::dontSendNotification);
-                    repaint();
+                    refreshWaveformLayers();
                 }
             }
         });
@@ -750,7 +1029,7 @@ void AudioWorkshopEditor::loadBreakpointFile() {
     fileChooser = std::make_unique<juce::FileChooser>(
         "Load Breakpoint File",
         juce::File::getSpecialLocation(juce::File::userDocumentsDirectory),
-        "*.txt"
+        "*.txt;*.abp"
     );
 
     fileChooser->launchAsync(juce::FileBrowserComponent::openMode |
@@ -775,13 +1054,14 @@ void AudioWorkshopEditor::extractSelectedFeature() {
     }
 
     juce::String feature = featureSelector.getText();
-    processor.extractFeature(feature, 0);
-
-    currentFeature = feature;
-    updateOutputSelector();
-    updateBreakpointDisplay();
+    if (!processor.extractFeatureAsync(feature, 0)) {
+        statusLabel.setText(feature + " is already being analyzed", juce::dontSendNotification);
+        return;
+    }
 
-    statusLabel.setText("Extracted: " + feature, juce::dontSendNotification);
+    pendingFeature = feature;
+    analysisWasRunning = true;
+    statusLabel.setText("Analyzing: " + feature, juce::dontSendNotification);
 }
 
 void AudioWorkshopEditor::extractAllFeatures() {
@@ -792,11 +1072,9 @@ void AudioWorkshopEditor::extractAllFeatures() {
 
     processor.extractAllFeatures();
 
-    currentFeature = "Amplitude"; // Default to first feature
-    updateOutputSelector();
-    updateBreakpointDisplay();
-
-    statusLabel.setText("Extracted all features", juce::dontSendNotification);
+    pendingFeature = "Amplitude"; // Default to first feature
+    analysisWasRunning = true;
+    statusLabel.setText("Analyzing all features...", juce::dontSendNotification);
 }
 
 void AudioWorkshopEditor::extractADSRFromAmplitude() {
@@ -815,21 +1093,21 @@ void AudioWorkshopEditor::extractADSRFromAmplitude() {
 }
 
 void AudioWorkshopEditor::updateBreakpointDisplay() {
-    displayedBreakpoints.clear();
+    displayedBreakpoints = {};
+    breakpointIndex.clear();
 
     if (!currentFeature.isEmpty()) {
-        auto points = processor.getBreakpointsForDisplay(currentFeature, currentOutput);
-        for (const auto& p : points) {
-            displayedBreakpoints.push_back({ static_cast<float>(p.first),
-                                            static_cast<float>(p.second) });
-        }
+        displayedBreakpoints = processor.getBreakpointView(currentFeature, currentOutput);
+        breakpointIndex.build(displayedBreakpoints);
 
-        breakpointCountLabel.setText("Points: " + juce::String(points.size()),
+        breakpointCountLabel.setText("Points: " + juce::String(displayedBreakpoints.size()),
             juce::dontSendNotification);
     }
     else {
         breakpointCountLabel.setText("Points: 0", juce::dontSendNotification);
     }
+
+    invalidateGraphLayers();
 }
 
 void AudioWorkshopEditor::updateOutputSelector() {
@@ -876,9 +1154,33 @@ void AudioWorkshopEditor::applyBreakpointsToTarget() {
         return;
     }
 
-    statusLabel.setText("Applying breakpoints...", juce::dontSendNotification);
-    processor.applyBreakpointsToTarget();
-    statusLabel.setText("Applied! Ready to export", juce::dontSendNotification);
+    if (processor.isProcessing()) {
+        statusLabel.setText("Already applying breakpoints...", juce::dontSendNotification);
+        return;
+    }
+
+    // Progress and completion are reported from timerCallback
+    if (processor.applyBreakpointsToTarget())
+        statusLabel.setText("Applying breakpoints...", juce::dontSendNotification);
+    else
+        statusLabel.setText("No breakpoint curve to apply", juce::dontSendNotification);
+}
+
+void AudioWorkshopEditor::updateLiveCurve() {
+    if (!liveToggle.getToggleState()) {
+        processor.clearRealtimeFeature();
+        statusLabel.setText("Live application off", juce::dontSendNotification);
+        return;
+    }
+
+    if (currentFeature.isEmpty() || !processor.setRealtimeFeature(currentFeature, currentOutput)) {
+        liveToggle.setToggleState(false, juce::dontSendNotification);
+        processor.clearRealtimeFeature();
+        statusLabel.setText("No breakpoint curve to apply live", juce::dontSendNotification);
+        return;
+    }
+
+    statusLabel.setText("Applying " + currentFeature + " live", juce::dontSendNotification);
 }
 
 void AudioWorkshopEditor::exportCurrentBreakpoints() {
@@ -895,7 +1197,7 @@ void AudioWorkshopEditor::exportCurrentBreakpoints() {
         "Export Breakpoints",
         juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
         .getChildFile(defaultName),
-        "*.txt"
+        "*.txt;*.abp"
     );
 
     fileChooser->launchAsync(juce::FileBrowserComponent::saveMode |
@@ -910,35 +1212,87 @@ void AudioWorkshopEditor::exportCurrentBreakpoints() {
         });
 }
 
+void AudioWorkshopEditor::saveTelemetryTrace() {
+    fileChooser = std::make_unique<juce::FileChooser>(
+        "Save Telemetry Trace",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("AudioWorkshopTrace.json"),
+        "*.json"
+    );
+
+    fileChooser->launchAsync(juce::FileBrowserComponent::saveMode |
+        juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser) {
+            auto result = chooser.getResult();
+            if (result.getFullPathName().isNotEmpty()) {
+                statusLabel.setText(processor.dumpTelemetry(result) ? "Saved trace: " + result.getFileName()
+                    : "Couldn't save the trace", juce::dontSendNotification);
+            }
+        });
+}
+
 void AudioWorkshopEditor::exportProcessedAudio() {
     if (!processor.hasTargetAudio()) {
         statusLabel.setText("No processed audio to export", juce::dontSendNotification);
         return;
     }
 
+    if (processor.isProcessing()) {
+        statusLabel.setText("Wait for the current render to finish", juce::dontSendNotification);
+        return;
+    }
+
+    auto options = getSelectedExportOptions();
+    juce::String extension = options.getFileExtension();
+
     juce::String defaultName = processor.hasTargetAudio() ?
-        processor.getTargetFileName() + "_processed.wav" :
-        "processed_audio.wav";
+        processor.getTargetFileName() + "_processed" + extension :
+        "processed_audio" + extension;
 
     fileChooser = std::make_unique<juce::FileChooser>(
         "Export Processed Audio",
         juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
         .getChildFile(defaultName),
-        "*.wav"
+        "*" + extension
     );
 
     fileChooser->launchAsync(juce::FileBrowserComponent::saveMode |
         juce::FileBrowserComponent::canSelectFiles,
-        [this](const juce::FileChooser& chooser) {
+        [this, options, extension](const juce::FileChooser& chooser) {
             auto result = chooser.getResult();
             if (result.getFullPathName().isNotEmpty()) {
-                processor.exportProcessedAudio(result);
-                statusLabel.setText("Exported: " + result.getFileName(),
-                    juce::dontSendNotification);
+                auto destination = result.withFileExtension(extension);
+
+                // Progress and the final status come through timerCallback
+                if (processor.exportProcessedAudioAsync(destination, options)) {
+                    pendingExportFile = destination;
+                    statusLabel.setText("Exporting...", juce::dontSendNotification);
+                }
+                else {
+                    statusLabel.setText("Export could not start", juce::dontSendNotification);
+                }
             }
         });
 }
 
+RenderPipeline::ExportOptions AudioWorkshopEditor::getSelectedExportOptions() const {
+    using Format = RenderPipeline::ExportOptions::Format;
+
+    RenderPipeline::ExportOptions options;
+
+    switch (exportFormatSelector.getSelectedId()) {
+    case 1: options.format = Format::Wav;  options.bitsPerSample = 16; break;
+    case 3: options.format = Format::Wav;  options.bitsPerSample = 32; break;
+    case 4: options.format = Format::Aiff; options.bitsPerSample = 16; break;
+    case 5: options.format = Format::Aiff; options.bitsPerSample = 24; break;
+    case 6: options.format = Format::Flac; options.bitsPerSample = 16; break;
+    case 7: options.format = Format::Flac; options.bitsPerSample = 24; break;
+    default: options.format = Format::Wav; options.bitsPerSample = 24; break;
+    }
+
+    return options;
+}
+
 void AudioWorkshopEditor::performSelectedEdit() {
     if (!processor.hasTargetAudio()) {
         statusLabel.setText("Load target audio first", juce::dontSendNotification);
@@ -979,13 +1333,37 @@ void AudioWorkshopEditor::performSelectedEdit() {
         params = { 0.1 }; // Humanize amount
         break;
 
+    case 7: // Snap to Grid
+        op = AudioWorkshopProcessor::EditOperation::SnapToGrid;
+        break;
+
+    case 8: { // Detect Tempo: sets the grid rather than editing the audio
+        if (!processor.canAnalyseWholeTarget()) {
+            statusLabel.setText("Tempo detection needs the target in memory, not streamed", juce::dontSendNotification);
+            return;
+        }
+
+        double bpm = processor.detectTargetTempo();
+        statusLabel.setText(bpm > 0.0 ? "Detected tempo: " + juce::String(bpm, 1) + " BPM"
+            : "No steady tempo found", juce::dontSendNotification);
+        repaint();
+        return;
+    }
+
     default:
         return;
     }
 
-    auto result = processor.performEditOperation(op, params);
+    const bool needsWholeTarget = op == AudioWorkshopProcessor::EditOperation::SplitByBeats
+        || op == AudioWorkshopProcessor::EditOperation::IsolateTransients;
+
+    if (needsWholeTarget && !processor.canAnalyseWholeTarget()) {
+        statusLabel.setText(editOperationSelector.getText() + " needs the target in memory, not streamed",
+            juce::dontSendNotification);
+        return;
+    }
 
-    if (result.getNumSamples() > 0) {
+    if (processor.performEditOperation(op, params)) {
         statusLabel.setText("Edit completed: " + editOperationSelector.getText(),
             juce::dontSendNotification);
     }
@@ -993,14 +1371,17 @@ void AudioWorkshopEditor::performSelectedEdit() {
         statusLabel.setText("Edit operation had no effect", juce::dontSendNotification);
     }
 
-    repaint();
+    refreshWaveformLayers();
 }
 
 void AudioWorkshopEditor::clearAll() {
+    pendingFeature.clear();
     processor.clearSourceAudio();
     processor.clearTargetAudio();
     processor.clearBreakpoints();
-    displayedBreakpoints.clear();
+    displayedBreakpoints = {};
+    breakpointIndex.clear();
+    zoomedTimeRange = {};
 
     sourceInfoLabel.setText("Source: None", juce::dontSendNotification);
     targetInfoLabel.setText("Target: None", juce::dontSendNotification);
@@ -1009,7 +1390,8 @@ void AudioWorkshopEditor::clearAll() {
     extractionStatusLabel.setText("No features extracted", juce::dontSendNotification);
     applicationStatusLabel.setText("No audio processed", juce::dontSendNotification);
 
-    repaint();
+    refreshWaveformLayers();
+    invalidateGraphLayers();
 }
 
 void AudioWorkshopEditor::updateStatus() {
@@ -1031,6 +1413,9 @@ void AudioWorkshopEditor::updateStatus() {
     else {
         applicationStatusLabel.setText("No audio processed", juce::dontSendNotification);
     }
+
+    undoEditButton.setEnabled(processor.canUndoEdit());
+    redoEditButton.setEnabled(processor.canRedoEdit());
 }
 
 // ========================================================================
@@ -1040,88 +1425,89 @@ void AudioWorkshopEditor::updateStatus() {
 int AudioWorkshopEditor::findBreakpointAtPosition(juce::Point<float> position, float tolerance) {
     if (displayedBreakpoints.empty()) return -1;
 
-    float maxTime = 0.0f;
-    float minValue = 1e10f;
-    float maxValue = -1e10f;
-
-    for (const auto& [time, value] : displayedBreakpoints) {
-        maxTime = juce::jmax(maxTime, time);
-        minValue = juce::jmin(minValue, value);
-        maxValue = juce::jmax(maxValue, value);
-    }
-
-    if (maxTime <= 0.0f) maxTime = 1.0f;
-    float valueRange = maxValue - minValue;
-    if (valueRange < 0.001f) valueRange = 1.0f;
-
-    for (size_t i = 0; i < displayedBreakpoints.size(); ++i) {
-        const auto& [time, value] = displayedBreakpoints[i];
-        float x = breakpointGraphBounds.getX() + (time / maxTime) * breakpointGraphBounds.getWidth();
-        float normalizedValue = (value - minValue) / valueRange;
-        float y = breakpointGraphBounds.getY() + breakpointGraphBounds.getHeight() * (1.0f - normalizedValue);
-
-        if (std::abs(x - position.x) <= tolerance && std::abs(y - position.y) <= tolerance) {
-            return static_cast<int>(i);
+    // Only the points within tolerance of the cursor horizontally are looked at
+    auto mapping = getGraphMapping();
+    auto candidates = breakpointIndex.getIndexRange(
+        mapping.xToTime(position.x - tolerance, breakpointGraphBounds),
+        mapping.xToTime(position.x + tolerance, breakpointGraphBounds));
+
+    int nearest = -1;
+    float nearestDistance = std::numeric_limits<float>::max();
+
+    for (size_t i = candidates.getStart(); i < candidates.getEnd(); ++i) {
+        auto point = displayedBreakpoints[i];
+        juce::Point<float> screen(mapping.timeToX(point.time, breakpointGraphBounds),
+            mapping.valueToY(point.value, breakpointGraphBounds));
+
+        if (std::abs(screen.x - position.x) <= tolerance && std::abs(screen.y - position.y) <= tolerance) {
+            float distance = screen.getDistanceFrom(position);
+            if (distance < nearestDistance) {
+                nearestDistance = distance;
+                nearest = static_cast<int>(i);
+            }
         }
     }
-    return -1;
+    return nearest;
 }
 
 juce::Point<float> AudioWorkshopEditor::timeValueToScreen(float time, float value) {
-    float maxTime = 1.0f;
-    float minValue = 1e10f;
-    float maxValue = -1e10f;
-
-    for (const auto& [t, v] : displayedBreakpoints) {
-        maxTime = juce::jmax(maxTime, t);
-        minValue = juce::jmin(minValue, v);
-        maxValue = juce::jmax(maxValue, v);
-    }
-
-    if (maxTime <= 0.0f) maxTime = 1.0f;
-    float valueRange = maxValue - minValue;
-    if (valueRange < 0.001f) valueRange = 1.0f;
-
-    float x = breakpointGraphBounds.getX() + (time / maxTime) * breakpointGraphBounds.getWidth();
-    float normalizedValue = (value - minValue) / valueRange;
-    float y = breakpointGraphBounds.getY() + breakpointGraphBounds.getHeight() * (1.0f - normalizedValue);
-
-    return { x, y };
+    auto mapping = getGraphMapping();
+    return { mapping.timeToX(time, breakpointGraphBounds), mapping.valueToY(value, breakpointGraphBounds) };
 }
 
 std::pair<float, float> AudioWorkshopEditor::screenToTimeValue(juce::Point<float> screenPos) {
-    float maxTime = 1.0f;
-    float minValue = 1e10f;
-    float maxValue = -1e10f;
-
-    for (const auto& [time, value] : displayedBreakpoints) {
-        maxTime = juce::jmax(maxTime, time);
-        minValue = juce::jmin(minValue, value);
-        maxValue = juce::jmax(maxValue, value);
-    }
-
-    if (maxTime <= 0.0f) maxTime = 1.0f;
-    float valueRange = maxValue - minValue;
-    if (valueRange < 0.001f) valueRange = 1.0f;
-
-    float time = ((screenPos.x - breakpointGraphBounds.getX()) / breakpointGraphBounds.getWidth()) * maxTime;
-    float normalizedValue = 1.0f - ((screenPos.y - breakpointGraphBounds.getY()) / breakpointGraphBounds.getHeight());
-    float value = minValue + normalizedValue * valueRange;
+    auto mapping = getGraphMapping();
+    float time = static_cast<float>(mapping.xToTime(screenPos.x, breakpointGraphBounds));
+    float value = static_cast<float>(mapping.yToValue(screenPos.y, breakpointGraphBounds));
 
     return { juce::jmax(0.0f, time), value };
 }
 
+void AudioWorkshopEditor::releaseDisplayedBreakpoints() {
+    // Nothing else shares the columns now, so the store edits them in place
+    displayedBreakpoints = {};
+    breakpointIndex.releaseView();
+}
+
 void AudioWorkshopEditor::updateBreakpointFromDrag(juce::Point<float> currentPosition) {
     if (draggedBreakpoint.index >= 0) {
         auto [newTime, newValue] = screenToTimeValue(currentPosition);
-        processor.updateBreakpoint(currentFeature, currentOutput, draggedBreakpoint.index, newTime, newValue);
-        updateBreakpointDisplay();
+        int previousIndex = draggedBreakpoint.index;
+        auto dirtyArea = getPointDirtyArea(previousIndex);
+
+        // The point may pass its neighbours, so follow it to its new index
+        releaseDisplayedBreakpoints();
+        draggedBreakpoint.index = processor.updateBreakpoint(currentFeature, currentOutput,
+            previousIndex, newTime, newValue);
+
+        // Only the points between the old and new index have changed
+        displayedBreakpoints = processor.getBreakpointView(currentFeature, currentOutput);
+        if (draggedBreakpoint.index >= 0) {
+            breakpointIndex.update(displayedBreakpoints,
+                static_cast<size_t>(juce::jmin(previousIndex, draggedBreakpoint.index)),
+                static_cast<size_t>(juce::jmax(previousIndex, draggedBreakpoint.index)));
+        }
+        else {
+            breakpointIndex.build(displayedBreakpoints);
+        }
+
+        // Moving the first, last, highest or lowest point rescales the whole graph;
+        // otherwise only the strip around the old and new positions is redrawn
+        if (getGraphMapping() != drawnMapping) {
+            invalidateGraphLayers();
+        }
+        else {
+            dirtyArea = dirtyArea.getUnion(getPointDirtyArea(draggedBreakpoint.index));
+            curveLayer.invalidate(dirtyArea);
+            overlayLayer.invalidate(dirtyArea);
+        }
     }
 }
 
 void AudioWorkshopEditor::addBreakpointAtPosition(juce::Point<float> position) {
     if (breakpointGraphBounds.contains(position.toInt())) {
         auto [time, value] = screenToTimeValue(position);
+        releaseDisplayedBreakpoints();
         processor.addBreakpoint(currentFeature, currentOutput, time, value);
         updateBreakpointDisplay();
         statusLabel.setText("Added breakpoint at " + juce::String(time, 2) + "s",
@@ -1132,6 +1518,7 @@ void AudioWorkshopEditor::addBreakpointAtPosition(juce::Point<float> position) {
 void AudioWorkshopEditor::removeBreakpointAtPosition(juce::Point<float> position) {
     int index = findBreakpointAtPosition(position);
     if (index >= 0) {
+        releaseDisplayedBreakpoints();
         processor.removeBreakpoint(currentFeature, currentOutput, index);
         updateBreakpointDisplay();
         statusLabel.setText("Removed breakpoint " + juce::String(index),
@@ -5,6 +5,9 @@
 #pragma once
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "BreakpointIndex.h"
+#include "EditorLayer.h"
+#include "TelemetryOverlay.h"
 
 class AudioWorkshopEditor : public juce::AudioProcessorEditor,
     private juce::Timer,
@@ -23,6 +26,7 @@ public:
     void mouseDrag(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
     void mouseDoubleClick(const juce::MouseEvent& event) override;
+    void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
 
 private:
     AudioWorkshopProcessor& processor;
@@ -68,7 +72,30 @@ private:
     // ========================================================================
 
     juce::Rectangle<int> breakpointGraphBounds;
-    std::vector<std::pair<float, float>> displayedBreakpoints;
+    BreakpointStore::View displayedBreakpoints;   // Shares the processor's columns
+    BreakpointIndex breakpointIndex;              // Over displayedBreakpoints
+    juce::Range<double> zoomedTimeRange;          // Empty shows the whole curve
+
+    // Maps the visible part of the curve onto the graph bounds
+    struct GraphMapping {
+        double startTime = 0.0;
+        double endTime = 1.0;
+        double minValue = 0.0;
+        double valueRange = 1.0;
+        bool hasCurve = false;
+
+        bool operator==(const GraphMapping& other) const {
+            return startTime == other.startTime && endTime == other.endTime && minValue == other.minValue
+                && valueRange == other.valueRange && hasCurve == other.hasCurve;
+        }
+        bool operator!=(const GraphMapping& other) const { return !(*this == other); }
+
+        float timeToX(double time, const juce::Rectangle<int>& area) const;
+        float valueToY(double value, const juce::Rectangle<int>& area) const;
+        double xToTime(float x, const juce::Rectangle<int>& area) const;
+        double yToValue(float y, const juce::Rectangle<int>& area) const;
+    };
+    GraphMapping getGraphMapping() const;
     juce::String currentFeature;
     int currentOutput = 0;
 
@@ -98,6 +125,8 @@ private:
     juce::ComboBox editOperationSelector;
     juce::Label editOperationLabel;
     juce::TextButton performEditButton;
+    juce::TextButton undoEditButton;
+    juce::TextButton redoEditButton;
     juce::TextButton saveBreakpointsButton;
     juce::TextButton loadBreakpointsButton;
 
@@ -111,11 +140,18 @@ private:
     juce::ToggleButton smoothingToggle;
 
     juce::TextButton applyButton;
+    juce::ToggleButton liveToggle;   // Applies the displayed curve to the host's audio as it plays
     juce::TextButton exportBreakpointsButton;
     juce::TextButton exportAudioButton;
+    juce::ComboBox exportFormatSelector;
+    juce::Label exportFormatLabel;
 
     juce::TextButton clearAllButton;
 
+    juce::ToggleButton telemetryToggle;   // Shows the overlay over the breakpoint graph
+    juce::TextButton saveTraceButton;
+    TelemetryOverlay telemetryOverlay;
+
     // ========================================================================
     // STATUS & INFO
     // ========================================================================
@@ -126,6 +162,35 @@ private:
 
     std::unique_ptr<juce::FileChooser> fileChooser;
 
+    // Background analysis tracking
+    bool analysisWasRunning = false;
+    juce::String pendingFeature;
+    bool renderWasRunning = false;
+
+    juce::File pendingExportFile;   // Set while a background export is writing
+
+    // ========================================================================
+    // DRAWING LAYERS
+    // Each keeps its own image and redraws only what is invalidated on it, so
+    // the timer and drags no longer repaint the whole editor.
+    // ========================================================================
+
+    EditorLayer sourceWaveformLayer{ [this](juce::Graphics& g) { drawSourceWaveform(g, sourceWaveformBounds); } };
+    EditorLayer targetWaveformLayer{ [this](juce::Graphics& g) { drawTargetWaveform(g, targetWaveformBounds); } };
+    EditorLayer gridLayer{ [this](juce::Graphics& g) { drawGridLayer(g, breakpointGraphBounds); }, true };
+    EditorLayer curveLayer{ [this](juce::Graphics& g) { drawBreakpoints(g, breakpointGraphBounds); } };
+    EditorLayer overlayLayer{ [this](juce::Graphics& g) { drawDragOverlay(g, breakpointGraphBounds); } };
+
+    int drawnSourceVersion = -1;   // Overview versions the waveform layers show
+    int drawnTargetVersion = -1;
+    GraphMapping drawnMapping;     // Mapping the grid layer was drawn with
+
+    void refreshWaveformLayers();
+    void invalidateGraphLayers();
+
+    // The point's marker and its segments to either neighbour, full graph height
+    juce::Rectangle<int> getPointDirtyArea(int index) const;
+
     // ========================================================================
     // MOUSE INTERACTION
     // ========================================================================
@@ -156,8 +221,14 @@ private:
     // Drawing methods
     void drawSourceWaveform(juce::Graphics& g, const juce::Rectangle<int>& area);
     void drawTargetWaveform(juce::Graphics& g, const juce::Rectangle<int>& area);
+    void drawWaveformOverview(juce::Graphics& g, const juce::Rectangle<int>& area,
+        const WaveformOverview& overview, juce::Colour colour);
     void drawBreakpoints(juce::Graphics& g, const juce::Rectangle<int>& area);
+    void drawDragOverlay(juce::Graphics& g, const juce::Rectangle<int>& area);
+    void drawGridLayer(juce::Graphics& g, const juce::Rectangle<int>& area);
     void drawGraphBackground(juce::Graphics& g, const juce::Rectangle<int>& area);
+    void drawMusicalGrid(juce::Graphics& g, const juce::Rectangle<int>& area,
+        double startSeconds, double endSeconds);
 
     // Mouse interaction helpers
     int findBreakpointAtPosition(juce::Point<float> position, float tolerance = 10.0f);
@@ -165,6 +236,7 @@ private:
     std::pair<float, float> screenToTimeValue(juce::Point<float> screenPos);
     void updateBreakpointFromDrag(juce::Point<float> currentPosition);
     void addBreakpointAtPosition(juce::Point<float> position);
+    void releaseDisplayedBreakpoints();   // Before an edit, so it happens in place
     void removeBreakpointAtPosition(juce::Point<float> position);
 
     // UI actions
@@ -178,8 +250,11 @@ private:
     void updateOutputSelector();
     void quantizeBreakpointsToGrid();
     void applyBreakpointsToTarget();
+    void updateLiveCurve();
     void exportCurrentBreakpoints();
     void exportProcessedAudio();
+    void saveTelemetryTrace();
+    RenderPipeline::ExportOptions getSelectedExportOptions() const;
     void performSelectedEdit();
     void clearAll();
     void updateStatus();
@@ -3,6 +3,22 @@
 // ============================================================================
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    std::shared_ptr<FeatureCache> getSharedFeatureCache() {
+        static auto cache = std::make_shared<FeatureCache>(
+            juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                .getChildFile("AudioWorkshop").getChildFile("FeatureCache"));
+        return cache;
+    }
+
+    // Pan curves position the audio; amplitude, ADSR and anything else scale the gain
+    RenderPipeline::Mode getApplyMode(const juce::String& featureName) {
+        return featureName.containsIgnoreCase("Pan") ? RenderPipeline::Mode::Pan : RenderPipeline::Mode::Gain;
+    }
+}
 
 AudioWorkshopProcessor::AudioWorkshopProcessor()
     : AudioProcessor(BusesProperties()
@@ -41,83 +57,246 @@ AudioWorkshopProcessor::AudioWorkshopProcessor()
         )
         })
 {
+    analysisEngine = std::make_unique<AnalysisJobEngine>(isAnalyzing, analysisProgress);
+    renderPipeline = std::make_unique<RenderPipeline>(processing, processingProgress);
+    featureCache = getSharedFeatureCache();
+    intensityParameter = params.getRawParameterValue("intensity");
     initializeExtractors();
     initializeTimeLattice();
 }
 
-AudioWorkshopProcessor::~AudioWorkshopProcessor() {}
+AudioWorkshopProcessor::~AudioWorkshopProcessor() {
+    analysisEngine->cancelAll();
+    renderPipeline->cancel();
+    releaseProcessedStream();
+}
 
 bool AudioWorkshopProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const {
     return layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
 }
 
-void AudioWorkshopProcessor::prepareToPlay(double sampleRate, int) {
-    if (timeLattice) {
-        timeLattice->setSampleRate(sampleRate);
+void AudioWorkshopProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
+    {
+        const juce::ScopedLock sl(breakpointLock);
+        if (timeLattice) {
+            timeLattice->setSampleRate(sampleRate);
+        }
     }
+
+    realtimePlayer.prepare(sampleRate, samplesPerBlock);
 }
 
 void AudioWorkshopProcessor::releaseResources() {}
 
 void AudioWorkshopProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) {
     juce::ScopedNoDenormals noDenormals;
-    // Pass-through - this is an offline editor
+
+    for (int ch = getTotalNumInputChannels(); ch < getTotalNumOutputChannels(); ++ch)
+        buffer.clear(ch, 0, buffer.getNumSamples());
+
+    // Pass-through unless a curve is applied live
+    realtimePlayer.process(buffer, getPlayHead(), intensityParameter->load());
 }
 
 // ============================================================================
 // AUDIO FILE MANAGEMENT
 // ============================================================================
 
-bool AudioWorkshopProcessor::loadSourceAudio(const juce::File& file) {
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
+void AudioWorkshopProcessor::setStreamingThreshold(juce::int64 numSamples) {
+    // Buffers are int-indexed, so anything longer has to stream regardless
+    streamingThreshold = juce::jlimit<juce::int64>(0, std::numeric_limits<int>::max(), numSamples);
+}
 
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    if (reader != nullptr) {
-        sourceSampleRate = reader->sampleRate;
-        int numChannels = static_cast<int>(reader->numChannels);
-        int numSamples = static_cast<int>(reader->lengthInSamples);
+bool AudioWorkshopProcessor::openAudioFile(const juce::File& file, juce::AudioBuffer<float>& buffer,
+    std::unique_ptr<StreamingAudioFile>& stream, double& sampleRate) {
 
-        sourceAudio.setSize(numChannels, numSamples);
-        reader->read(&sourceAudio, 0, numSamples, 0, true, true);
-        sourceFileName = file.getFileNameWithoutExtension();
+    auto opened = StreamingAudioFile::open(file);
+    if (opened == nullptr) return false;
 
+    if (opened->getLengthInSamples() > streamingThreshold) {
+        buffer.setSize(0, 0);
+        sampleRate = opened->getSampleRate();
+        stream = std::move(opened);
         return true;
     }
-    return false;
+
+    juce::AudioBuffer<float> loaded;
+    if (!opened->readAll(loaded)) return false;
+
+    // Short files are read once and the file handle released
+    buffer = std::move(loaded);
+    sampleRate = opened->getSampleRate();
+    stream.reset();
+    return true;
+}
+
+bool AudioWorkshopProcessor::loadSourceAudio(const juce::File& file) {
+    // Running jobs read sourceAudio or sourceStream directly
+    analysisEngine->cancelAll();
+    frameCache->clear(sourceAudio);
+
+    if (!openAudioFile(file, sourceAudio, sourceStream, sourceSampleRate))
+        return false;
+
+    if (sourceStream != nullptr) sourceOverview.build(*sourceStream);
+    else sourceOverview.build(sourceAudio);
+
+    sourceFileName = file.getFileNameWithoutExtension();
+    clearSourceAudioHash();
+    return true;
 }
 
 void AudioWorkshopProcessor::clearSourceAudio() {
+    analysisEngine->cancelAll();
+    frameCache->clear(sourceAudio);
     sourceAudio.setSize(0, 0);
+    sourceStream.reset();
+    sourceOverview.clear();
     sourceFileName = "";
+    clearSourceAudioHash();
+}
+
+juce::int64 AudioWorkshopProcessor::getSourceLengthInSamples() const {
+    return sourceStream != nullptr ? sourceStream->getLengthInSamples() : sourceAudio.getNumSamples();
+}
+
+int AudioWorkshopProcessor::getSourceNumChannels() const {
+    return sourceStream != nullptr ? sourceStream->getNumChannels() : sourceAudio.getNumChannels();
 }
 
 bool AudioWorkshopProcessor::loadTargetAudio(const juce::File& file) {
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
+    // A running render reads targetAudio or targetStream directly
+    renderPipeline->cancel();
 
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    if (reader != nullptr) {
-        targetSampleRate = reader->sampleRate;
-        int numChannels = static_cast<int>(reader->numChannels);
-        int numSamples = static_cast<int>(reader->lengthInSamples);
+    // Onset detection caches the target's spectra alongside the source's, which stay
+    frameCache->clear(targetAudio);
 
-        targetAudio.setSize(numChannels, numSamples);
-        reader->read(&targetAudio, 0, numSamples, 0, true, true);
-        targetFileName = file.getFileNameWithoutExtension();
+    const juce::ScopedLock sl(processedAudioLock);
 
-        processedAudio.makeCopyOf(targetAudio);
-        return true;
-    }
-    return false;
+    if (!openAudioFile(file, targetAudio, targetStream, targetSampleRate))
+        return false;
+
+    targetEdits = targetStream != nullptr
+        ? EditList(std::make_shared<EditList::Source>(*targetStream))
+        : EditList(std::make_shared<EditList::Source>(targetAudio));
+    editHistory.reset(targetEdits);
+
+    if (targetStream != nullptr) targetSourceOverview.build(*targetStream);
+    else targetSourceOverview.build(targetAudio);
+    updateTargetOverview();
+
+    targetFileName = file.getFileNameWithoutExtension();
+    analysisScratch.setSize(0, 0);
+
+    // Until something is applied, exporting writes the target itself
+    processedAudio.setSize(0, 0);
+    releaseProcessedStream();
+    return true;
 }
 
 void AudioWorkshopProcessor::clearTargetAudio() {
+    renderPipeline->cancel();
+    frameCache->clear(targetAudio);
+    targetEdits = EditList();
+    editHistory.reset(targetEdits);
     targetAudio.setSize(0, 0);
+    targetStream.reset();
+    targetSourceOverview.clear();
+    updateTargetOverview();
+    analysisScratch.setSize(0, 0);
+
+    const juce::ScopedLock sl(processedAudioLock);
     processedAudio.setSize(0, 0);
+    releaseProcessedStream();
     targetFileName = "";
 }
 
+juce::int64 AudioWorkshopProcessor::getTargetLengthInSamples() const {
+    return targetEdits.getLengthInSamples();
+}
+
+void AudioWorkshopProcessor::revertTargetEdits() {
+    if (!isTargetEdited()) return;
+
+    if (targetStream != nullptr)
+        setTargetEdits(EditList(std::make_shared<EditList::Source>(*targetStream)));
+    else
+        setTargetEdits(EditList(std::make_shared<EditList::Source>(targetAudio)));
+
+    editHistory.reset(targetEdits);
+}
+
+void AudioWorkshopProcessor::setTargetEdits(EditList&& edits) {
+    // A running render reads the old edit list's slices
+    renderPipeline->cancel();
+
+    {
+        const juce::ScopedLock sl(processedAudioLock);
+        targetEdits = std::move(edits);
+
+        // Whatever was applied to the previous arrangement no longer matches it
+        processedAudio.setSize(0, 0);
+        releaseProcessedStream();
+    }
+
+    updateTargetOverview();
+}
+
+void AudioWorkshopProcessor::updateTargetOverview() {
+    // The unedited target is drawn from its own overview
+    if (!isTargetEdited()) {
+        targetOverview.clear();
+        renderedSourceOverviews.clear();
+        return;
+    }
+
+    // New material is in memory, so its overview costs no disk reads, and each is built once
+    decltype(renderedSourceOverviews) kept;
+
+    for (const auto& slice : targetEdits.getSlices()) {
+        const auto* buffer = slice.source->getBuffer();
+        if (buffer == nullptr || buffer == &targetAudio) continue;
+
+        auto sameSource = [&slice](const auto& entry) { return entry.first.lock() == slice.source; };
+        if (std::any_of(kept.begin(), kept.end(), sameSource)) continue;
+
+        auto existing = std::find_if(renderedSourceOverviews.begin(), renderedSourceOverviews.end(), sameSource);
+        if (existing != renderedSourceOverviews.end()) {
+            kept.push_back(std::move(*existing));
+            continue;
+        }
+
+        auto overview = std::make_unique<WaveformOverview>();
+        overview->build(*buffer);
+        kept.emplace_back(slice.source, std::move(overview));
+    }
+
+    renderedSourceOverviews = std::move(kept);
+
+    const bool derived = targetOverview.build(targetEdits,
+        [this](const EditList::Source& source) -> const WaveformOverview* {
+            if (source.getBuffer() == &targetAudio
+                || (targetStream != nullptr && source.getStream() == targetStream.get()))
+                return &targetSourceOverview;
+
+            for (const auto& [weakSource, overview] : renderedSourceOverviews) {
+                if (weakSource.lock().get() == &source) return overview.get();
+            }
+            return nullptr;
+        });
+
+    // Only reached for sources the lookup doesn't know, which are read in full
+    if (!derived) targetOverview.build(targetEdits);
+}
+
+void AudioWorkshopProcessor::releaseProcessedStream() {
+    processedStream.reset();
+
+    if (processedStreamFile != juce::File())
+        processedStreamFile.deleteFile();
+    processedStreamFile = juce::File();
+}
+
 // ============================================================================
 // FEATURE EXTRACTION
 // ============================================================================
@@ -131,33 +310,129 @@ void AudioWorkshopProcessor::initializeExtractors() {
     extractors["ADSR Envelope"] = FeatureExtractorFactory::createExtractor("ADSR Envelope");
 }
 
+void AudioWorkshopProcessor::applyExtractorSettings(FeatureExtractor& extractor) {
+    extractor.settings.windowSizeMs = params.getRawParameterValue("windowSize")->load();
+    extractor.settings.hopSizePct = params.getRawParameterValue("hopSize")->load();
+    extractor.settings.normalizeOutput = params.getRawParameterValue("normalize")->load() > 0.5f;
+    extractor.settings.parallelExtraction = parallelExtraction;
+    extractor.frameCache = frameCache;
+}
+
+void AudioWorkshopProcessor::publishFeatureResults(const juce::String& featureName,
+    std::vector<std::vector<std::pair<double, double>>>&& results) {
+    publishFeatureResults(featureName, std::move(results),
+        simplifyExtractedCurves ? getSimplifyThreshold() : 0.0);
+}
+
+void AudioWorkshopProcessor::publishFeatureResults(const juce::String& featureName,
+    std::vector<std::vector<std::pair<double, double>>>&& results, double simplifyThreshold) {
+    if (simplifyThreshold > 0.0) {
+        for (auto& points : results)
+            simplifyCurve(points, simplifyThreshold);
+    }
+
+    const juce::ScopedLock sl(breakpointLock);
+    breakpoints.setOutputs(breakpoints.addFeature(featureName), std::move(results));
+    updateRealtimeCurve(featureName);
+}
+
 void AudioWorkshopProcessor::extractFeature(const juce::String& featureName, int channel) {
     auto it = extractors.find(featureName);
     if (it == extractors.end() || !hasSourceAudio()) return;
 
-    isAnalyzing = true;
+    // The extractor instance can't be shared with a background job
+    analysisEngine->cancel(featureName);
+
     auto& extractor = it->second;
+    applyExtractorSettings(*extractor);
+
+    int channelToUse = juce::jlimit(0, getSourceNumChannels() - 1,
+        channel < 0 ? 0 : channel);
 
-    // Update settings from parameters
-    extractor->settings.windowSizeMs = params.getRawParameterValue("windowSize")->load();
-    extractor->settings.hopSizePct = params.getRawParameterValue("hopSize")->load();
-    extractor->settings.normalizeOutput = params.getRawParameterValue("normalize")->load() > 0.5f;
+    const auto cacheKey = getFeatureCacheKey(featureName, *extractor, channelToUse);
+    FeatureCache::Results results;
+    if (featureCache != nullptr && featureCache->lookup(cacheKey, results)) {
+        publishFeatureResults(featureName, std::move(results));
+        return;
+    }
+
+    {
+        Telemetry::ScopedTimer timer(Telemetry::Category::Extraction, featureName);
+        timer.setItems(getSourceLengthInSamples());
+
+        results = sourceStream != nullptr
+            ? extractor->extractStreaming(*sourceStream, channelToUse)
+            : extractor->extract(sourceAudio, sourceSampleRate, channelToUse);
+    }
+
+    if (featureCache != nullptr) featureCache->store(cacheKey, *extractor, results);
+    publishFeatureResults(featureName, std::move(results));
+}
+
+bool AudioWorkshopProcessor::extractFeatureAsync(const juce::String& featureName, int channel) {
+    auto it = extractors.find(featureName);
+    if (it == extractors.end() || !hasSourceAudio()) return false;
+    if (analysisEngine->isRunning(featureName)) return false;
 
-    int channelToUse = juce::jlimit(0, sourceAudio.getNumChannels() - 1,
+    applyExtractorSettings(*it->second);
+
+    int channelToUse = juce::jlimit(0, getSourceNumChannels() - 1,
         channel < 0 ? 0 : channel);
 
-    auto results = extractor->extract(sourceAudio, sourceSampleRate, channelToUse);
-    featureBreakpoints[featureName] = results;
+    // Hashing a streamed source is a pass over the whole file, so the key is
+    // worked out and looked up in the job rather than here
+    struct CacheState {
+        juce::String key;
+        bool hit = false;
+    };
+
+    auto state = std::make_shared<CacheState>();
+    AnalysisJobEngine::CacheLookup lookup;
+
+    if (featureCache != nullptr) {
+        lookup = [this, state, cache = featureCache, featureName, channelToUse,
+            &extractor = *it->second](AnalysisJobEngine::Results& results) {
+            state->key = getFeatureCacheKey(featureName, extractor, channelToUse);
+            state->hit = cache->lookup(state->key, results);
+            return state->hit;
+        };
+    }
+
+    // Raw results are cached, so simplification settings can change without a miss.
+    // The settings in force now are used, as the lattice can change under the job.
+    const double simplifyThreshold = simplifyExtractedCurves ? getSimplifyThreshold() : 0.0;
+
+    auto publish = [this, state, cache = featureCache, &extractor = *it->second, simplifyThreshold](
+        const juce::String& name, AnalysisJobEngine::Results&& results) {
+        if (cache != nullptr && !state->hit) cache->store(state->key, extractor, results);
+        publishFeatureResults(name, std::move(results), simplifyThreshold);
+    };
 
-    isAnalyzing = false;
+    if (sourceStream != nullptr)
+        return analysisEngine->submit(featureName, *it->second, *sourceStream, channelToUse, publish, lookup);
+
+    return analysisEngine->submit(featureName, *it->second, sourceAudio, sourceSampleRate,
+        channelToUse, publish, lookup);
 }
 
 void AudioWorkshopProcessor::extractAllFeatures() {
+    if (!hasSourceAudio()) return;
+
+    analysisEngine->cancelAll();
+
     for (const auto& [featureName, extractor] : extractors) {
-        extractFeature(featureName, 0);
+        extractFeatureAsync(featureName, 0);
     }
 }
 
+void AudioWorkshopProcessor::cancelAnalysis() {
+    analysisEngine->cancelAll();
+}
+
+bool AudioWorkshopProcessor::waitForAnalysis(int timeoutMs) {
+    return analysisEngine->waitForAll(timeoutMs);
+}
+
 void AudioWorkshopProcessor::extractADSRFromAmplitude() {
     if (!hasSourceAudio()) return;
 
@@ -171,24 +446,22 @@ void AudioWorkshopProcessor::extractADSRFromAmplitude() {
     auto adsrExtractor = FeatureExtractorFactory::createExtractor("ADSR Envelope");
     if (!adsrExtractor) return;
 
+    // Uses a private instance so a running ADSR job keeps its extractor
     auto adsrExtractorPtr = dynamic_cast<ADSREnvelopeExtractor*>(adsrExtractor.get());
     if (adsrExtractorPtr) {
         auto adsrResults = adsrExtractorPtr->extractFromAmplitude(amplitudeBreakpoints, sourceSampleRate);
-        featureBreakpoints["ADSR Envelope"] = adsrResults;
-        extractors["ADSR Envelope"] = std::move(adsrExtractor);
+        publishFeatureResults("ADSR Envelope", std::move(adsrResults));
     }
 }
 
 bool AudioWorkshopProcessor::isFeatureExtracted(const juce::String& featureName) const {
-    return featureBreakpoints.find(featureName) != featureBreakpoints.end();
+    const juce::ScopedLock sl(breakpointLock);
+    return breakpoints.findFeature(featureName) != BreakpointStore::invalidId;
 }
 
 juce::StringArray AudioWorkshopProcessor::getExtractedFeatures() const {
-    juce::StringArray features;
-    for (const auto& [name, _] : featureBreakpoints) {
-        features.add(name);
-    }
-    return features;
+    const juce::ScopedLock sl(breakpointLock);
+    return breakpoints.getFeatureNames();
 }
 
 juce::StringArray AudioWorkshopProcessor::getAvailableFeatures() const {
@@ -222,90 +495,80 @@ juce::String AudioWorkshopProcessor::getOutputName(const juce::String& featureNa
 std::vector<std::pair<double, double>> AudioWorkshopProcessor::getBreakpointsForDisplay(
     const juce::String& featureName, int outputIndex) const {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        return it->second[outputIndex];
-    }
-    return {};
+    const juce::ScopedLock sl(breakpointLock);
+    return breakpoints.getPoints(breakpoints.findFeature(featureName), outputIndex);
+}
+
+BreakpointStore::View AudioWorkshopProcessor::getBreakpointView(const juce::String& featureName,
+    int outputIndex) const {
+
+    const juce::ScopedLock sl(breakpointLock);
+    return breakpoints.getView(breakpoints.findFeature(featureName), outputIndex);
 }
 
-void AudioWorkshopProcessor::addBreakpoint(const juce::String& featureName,
+int AudioWorkshopProcessor::addBreakpoint(const juce::String& featureName,
     int outputIndex, double time, double value) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        it->second[outputIndex].emplace_back(time, value);
-        sortBreakpoints(featureName, outputIndex);
-    }
+    const juce::ScopedLock sl(breakpointLock);
+    int index = breakpoints.insertPoint(breakpoints.findFeature(featureName), outputIndex, time, value);
+    updateRealtimeCurve(featureName);
+    return index;
 }
 
-void AudioWorkshopProcessor::updateBreakpoint(const juce::String& featureName,
+int AudioWorkshopProcessor::updateBreakpoint(const juce::String& featureName,
     int outputIndex, size_t pointIndex, double time, double value) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        auto& points = it->second[outputIndex];
-        if (pointIndex < points.size()) {
-            points[pointIndex] = { juce::jmax(0.0, time), value };
-            sortBreakpoints(featureName, outputIndex);
-        }
-    }
+    const juce::ScopedLock sl(breakpointLock);
+    int index = breakpoints.movePoint(breakpoints.findFeature(featureName), outputIndex, pointIndex,
+        juce::jmax(0.0, time), value);
+    updateRealtimeCurve(featureName);
+    return index;
 }
 
 void AudioWorkshopProcessor::removeBreakpoint(const juce::String& featureName,
     int outputIndex, size_t pointIndex) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        auto& points = it->second[outputIndex];
-        if (pointIndex < points.size()) {
-            points.erase(points.begin() + pointIndex);
-        }
-    }
-}
-
-void AudioWorkshopProcessor::sortBreakpoints(const juce::String& featureName, int outputIndex) {
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        std::sort(it->second[outputIndex].begin(), it->second[outputIndex].end(),
-            [](const auto& a, const auto& b) { return a.first < b.first; });
-    }
+    const juce::ScopedLock sl(breakpointLock);
+    breakpoints.removePoint(breakpoints.findFeature(featureName), outputIndex, pointIndex);
+    updateRealtimeCurve(featureName);
 }
 
 void AudioWorkshopProcessor::decimateBreakpoints(const juce::String& featureName,
     int outputIndex, int targetPoints) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it == featureBreakpoints.end() || outputIndex >= it->second.size()) return;
+    const juce::ScopedLock sl(breakpointLock);
+    auto id = breakpoints.findFeature(featureName);
+    if (breakpoints.getNumPoints(id, outputIndex) <= static_cast<size_t>(juce::jmax(0, targetPoints))) return;
 
-    auto& points = it->second[outputIndex];
-    if (points.size() <= targetPoints) return;
+    breakpoints.setOutput(id, outputIndex, BreakpointSimplifier::simplifyToCount(
+        breakpoints.getPoints(id, outputIndex), static_cast<size_t>(targetPoints)));
+    updateRealtimeCurve(featureName);
+}
 
-    std::vector<std::pair<double, double>> decimated;
-    decimated.reserve(targetPoints);
+void AudioWorkshopProcessor::simplifyBreakpoints(const juce::String& featureName, int outputIndex) {
+    const juce::ScopedLock sl(breakpointLock);
+    auto id = breakpoints.findFeature(featureName);
+    if (outputIndex >= breakpoints.getNumOutputs(id)) return;
 
-    int step = points.size() / targetPoints;
-    for (size_t i = 0; i < points.size(); i += step) {
-        if (decimated.size() < targetPoints) {
-            decimated.push_back(points[i]);
-        }
-    }
+    auto points = breakpoints.getPoints(id, outputIndex);
+    simplifyCurve(points, getSimplifyThreshold());
+    breakpoints.setOutput(id, outputIndex, points);
+    updateRealtimeCurve(featureName);
+}
 
-    if (!points.empty() && decimated.back().first != points.back().first) {
-        decimated.push_back(points.back());
-    }
+double AudioWorkshopProcessor::getSimplifyThreshold() const {
+    return timeLattice ? timeLattice->calculatePerceptualThreshold(currentResolution) : 0.001;
+}
 
-    points = decimated;
+void AudioWorkshopProcessor::simplifyCurve(std::vector<std::pair<double, double>>& points, double threshold) {
+    points = BreakpointSimplifier::simplify(points, BreakpointSimplifier::getTolerance(points, threshold));
 }
 
 int AudioWorkshopProcessor::getCurrentBreakpointCount(const juce::String& featureName,
     int outputIndex) const {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it != featureBreakpoints.end() && outputIndex < it->second.size()) {
-        return static_cast<int>(it->second[outputIndex].size());
-    }
-    return 0;
+    const juce::ScopedLock sl(breakpointLock);
+    return static_cast<int>(breakpoints.getNumPoints(breakpoints.findFeature(featureName), outputIndex));
 }
 
 // ============================================================================
@@ -313,46 +576,42 @@ int AudioWorkshopProcessor::getCurrentBreakpointCount(const juce::String& featur
 // ============================================================================
 
 bool AudioWorkshopProcessor::loadBreakpointFile(const juce::File& file) {
+    if (BreakpointFile::isBinaryFile(file))
+        return loadBinaryBreakpointFile(file);
+
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Read breakpoint text");
+
     juce::FileInputStream stream(file);
     if (!stream.openedOk()) return false;
 
     juce::String content = stream.readEntireStreamAsString();
     auto lines = juce::StringArray::fromLines(content);
 
+    // Outputs are collected per feature in file order, then stored in one go
+    std::map<juce::String, std::vector<std::vector<std::pair<double, double>>>> loaded;
+
     juce::String currentFeatureName;
     std::vector<std::pair<double, double>> currentOutput;
-    juce::String currentOutputName;
+
+    auto finishOutput = [&] {
+        if (!currentOutput.empty() && extractors.find(currentFeatureName) != extractors.end())
+            loaded[currentFeatureName].push_back(std::move(currentOutput));
+        currentOutput.clear();
+    };
 
     for (const auto& line : lines) {
         if (line.startsWith("# Feature:")) {
+            finishOutput();
             currentFeatureName = line.fromFirstOccurrenceOf("# Feature:", false, false).trim();
             continue;
         }
 
-        if (line.startsWith("#") && !line.startsWith("# Feature:") &&
-            !line.startsWith("# Source:") && !line.startsWith("# Sample Rate:") &&
-            !line.startsWith("# Generated:") && !line.startsWith("# Format:") &&
-            !line.startsWith("# Audio")) {
-
-            if (!currentOutput.empty() && !currentFeatureName.isEmpty()) {
-                if (featureBreakpoints.find(currentFeatureName) == featureBreakpoints.end()) {
-                    auto extractorIt = extractors.find(currentFeatureName);
-                    if (extractorIt != extractors.end()) {
-                        int numOutputs = extractorIt->second->getNumOutputs();
-                        featureBreakpoints[currentFeatureName] =
-                            std::vector<std::vector<std::pair<double, double>>>(numOutputs);
-                    }
-                }
-
-                if (featureBreakpoints.find(currentFeatureName) != featureBreakpoints.end()) {
-                    auto& outputs = featureBreakpoints[currentFeatureName];
-                    outputs.push_back(currentOutput);
-                }
-
-                currentOutput.clear();
-            }
+        if (line.startsWith("#") && !line.startsWith("# Source:") &&
+            !line.startsWith("# Sample Rate:") && !line.startsWith("# Generated:") &&
+            !line.startsWith("# Format:") && !line.startsWith("# Audio")) {
 
-            currentOutputName = line.fromFirstOccurrenceOf("#", false, false).trim();
+            // Output name header
+            finishOutput();
             continue;
         }
 
@@ -366,29 +625,71 @@ bool AudioWorkshopProcessor::loadBreakpointFile(const juce::File& file) {
         }
     }
 
-    if (!currentOutput.empty() && !currentFeatureName.isEmpty()) {
-        if (featureBreakpoints.find(currentFeatureName) == featureBreakpoints.end()) {
-            auto extractorIt = extractors.find(currentFeatureName);
-            if (extractorIt != extractors.end()) {
-                int numOutputs = extractorIt->second->getNumOutputs();
-                featureBreakpoints[currentFeatureName] =
-                    std::vector<std::vector<std::pair<double, double>>>(numOutputs);
-            }
-        }
+    finishOutput();
 
-        if (featureBreakpoints.find(currentFeatureName) != featureBreakpoints.end()) {
-            featureBreakpoints[currentFeatureName].push_back(currentOutput);
-        }
+    const juce::ScopedLock sl(breakpointLock);
+
+    for (auto& [featureName, outputs] : loaded) {
+        int numOutputs = extractors.find(featureName)->second->getNumOutputs();
+        outputs.resize(juce::jmax(outputs.size(), static_cast<size_t>(numOutputs)));
+        breakpoints.setOutputs(breakpoints.addFeature(featureName), std::move(outputs));
+        updateRealtimeCurve(featureName);
     }
 
-    return !featureBreakpoints.empty();
+    return !breakpoints.isEmpty();
+}
+
+bool AudioWorkshopProcessor::loadBinaryBreakpointFile(const juce::File& file) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Read breakpoint file");
+
+    auto mapped = BreakpointFile::MappedFile::open(file);
+    if (mapped == nullptr || mapped->getFeatureName().isEmpty()) return false;
+
+    // The file's columns go straight into the store's, with no points in between
+    std::vector<BreakpointStore::Columns> outputs(static_cast<size_t>(mapped->getNumOutputs()));
+    juce::int64 numPoints = 0;
+
+    for (int i = 0; i < mapped->getNumOutputs(); ++i) {
+        auto& columns = outputs[static_cast<size_t>(i)];
+        columns.times = mapped->getTimeColumn(i);
+        columns.values = mapped->getValueColumn(i);
+        numPoints += static_cast<juce::int64>(columns.times.size());
+    }
+
+    timer.setItems(numPoints);
+
+    const auto featureName = mapped->getFeatureName();
+    auto extractorIt = extractors.find(featureName);
+    if (extractorIt != extractors.end())
+        outputs.resize(juce::jmax(outputs.size(), static_cast<size_t>(extractorIt->second->getNumOutputs())));
+
+    const juce::ScopedLock sl(breakpointLock);
+    breakpoints.setOutputColumns(breakpoints.addFeature(featureName), std::move(outputs));
+    updateRealtimeCurve(featureName);
+    return true;
+}
+
+juce::String AudioWorkshopProcessor::getBreakpointOutputName(const juce::String& featureName,
+    int outputIndex) const {
+    auto extractorIt = extractors.find(featureName);
+    return extractorIt != extractors.end() ?
+        extractorIt->second->getOutputName(outputIndex) :
+        "Output " + juce::String(outputIndex + 1);
 }
 
 void AudioWorkshopProcessor::saveBreakpoints(const juce::String& featureName,
     const juce::File& file) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it == featureBreakpoints.end()) return;
+    const juce::ScopedLock sl(breakpointLock);
+    auto id = breakpoints.findFeature(featureName);
+    if (id == BreakpointStore::invalidId) return;
+
+    if (file.hasFileExtension(BreakpointFile::fileExtension)) {
+        saveBinaryBreakpoints(featureName, file);
+        return;
+    }
+
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Write breakpoint text");
 
     juce::FileOutputStream stream(file);
     if (stream.openedOk()) {
@@ -401,16 +702,12 @@ void AudioWorkshopProcessor::saveBreakpoints(const juce::String& featureName,
             "\n", false, false, "\n");
         stream.writeText("# Format: time(seconds) value\n\n", false, false, "\n");
 
-        const auto& outputs = it->second;
-        for (size_t i = 0; i < outputs.size(); ++i) {
-            auto extractorIt = extractors.find(featureName);
-            juce::String outputName = extractorIt != extractors.end() ?
-                extractorIt->second->getOutputName(static_cast<int>(i)) :
-                "Output " + juce::String(i + 1);
+        for (int i = 0; i < breakpoints.getNumOutputs(id); ++i) {
+            juce::String outputName = getBreakpointOutputName(featureName, i);
 
             stream.writeText("# " + outputName + "\n", false, false, "\n");
 
-            for (const auto& [time, value] : outputs[i]) {
+            for (const auto& [time, value] : breakpoints.getView(id, i)) {
                 stream.writeText(juce::String(time, 6) + "\t" +
                     juce::String(value, 6) + "\n", false, false, "\n");
             }
@@ -419,20 +716,42 @@ void AudioWorkshopProcessor::saveBreakpoints(const juce::String& featureName,
     }
 }
 
-void AudioWorkshopProcessor::saveAllBreakpoints(const juce::File& directory) {
-    for (const auto& [featureName, _] : featureBreakpoints) {
+bool AudioWorkshopProcessor::saveBinaryBreakpoints(const juce::String& featureName,
+    const juce::File& file, BreakpointFile::Encoding encoding) {
+
+    const juce::ScopedLock sl(breakpointLock);
+    auto id = breakpoints.findFeature(featureName);
+    if (id == BreakpointStore::invalidId) return false;
+
+    BreakpointFile::Contents contents;
+    contents.featureName = featureName;
+    contents.sourceName = sourceFileName;
+    contents.sampleRate = sourceSampleRate;
+
+    for (int i = 0; i < breakpoints.getNumOutputs(id); ++i)
+        contents.outputs.push_back({ getBreakpointOutputName(featureName, i), breakpoints.getPoints(id, i) });
+
+    return BreakpointFile::write(file, contents, encoding);
+}
+
+void AudioWorkshopProcessor::saveAllBreakpoints(const juce::File& directory, bool binary) {
+    const juce::ScopedLock sl(breakpointLock);
+    for (const auto& featureName : breakpoints.getFeatureNames()) {
         juce::File file = directory.getChildFile(sourceFileName + "_" +
-            featureName + ".txt");
+            featureName + (binary ? BreakpointFile::fileExtension : ".txt"));
         saveBreakpoints(featureName, file);
     }
 }
 
 void AudioWorkshopProcessor::clearBreakpoints() {
-    featureBreakpoints.clear();
+    const juce::ScopedLock sl(breakpointLock);
+    breakpoints.clear();
+    updateRealtimeCurve();
 }
 
 bool AudioWorkshopProcessor::hasBreakpoints() const {
-    return !featureBreakpoints.empty();
+    const juce::ScopedLock sl(breakpointLock);
+    return !breakpoints.isEmpty();
 }
 
 // ============================================================================
@@ -440,15 +759,19 @@ bool AudioWorkshopProcessor::hasBreakpoints() const {
 // ============================================================================
 
 void AudioWorkshopProcessor::initializeTimeLattice() {
+    const juce::ScopedLock sl(breakpointLock);
     timeLattice = std::make_unique<AudioTimeLattice>(currentPPQN, sourceSampleRate);
     timeLattice->setTempo(120.0);
 }
 
 void AudioWorkshopProcessor::setTimeGridPPQN(int ppqn) {
+    const juce::ScopedLock sl(breakpointLock);
     currentPPQN = ppqn;
     if (timeLattice) {
         timeLattice->setPPQN(ppqn);
     }
+
+    updateRealtimeCurve();
 }
 
 void AudioWorkshopProcessor::setTimeGridResolution(ValueResolution resolution) {
@@ -458,13 +781,15 @@ void AudioWorkshopProcessor::setTimeGridResolution(ValueResolution resolution) {
 void AudioWorkshopProcessor::quantizeBreakpointsToGrid(const juce::String& featureName,
     int outputIndex) {
 
-    auto it = featureBreakpoints.find(featureName);
-    if (it == featureBreakpoints.end() || outputIndex >= it->second.size()) return;
+    const juce::ScopedLock sl(breakpointLock);
+    auto id = breakpoints.findFeature(featureName);
+    if (outputIndex >= breakpoints.getNumOutputs(id)) return;
 
     if (timeLattice) {
-        auto& points = it->second[outputIndex];
-        auto quantized = timeLattice->quantizeBreakpoints(points, currentResolution, true);
-        points = quantized;
+        auto quantized = timeLattice->quantizeBreakpoints(breakpoints.getPoints(id, outputIndex),
+            currentResolution, true);
+        breakpoints.setOutput(id, outputIndex, quantized);
+        updateRealtimeCurve(featureName);
     }
 }
 
@@ -475,280 +800,488 @@ void AudioWorkshopProcessor::quantizeBreakpointsToGrid(const juce::String& featu
 float AudioWorkshopProcessor::interpolateValue(const std::vector<std::pair<double, double>>& points,
     double time) {
 
-    if (points.empty()) return 0.0f;
-    if (points.size() == 1) return static_cast<float>(points[0].second);
-    if (time <= points.front().first) return static_cast<float>(points.front().second);
-    if (time >= points.back().first) return static_cast<float>(points.back().second);
+    return BreakpointEnvelope(points).getValueAt(time);
+}
 
-    for (size_t i = 0; i < points.size() - 1; ++i) {
-        if (time >= points[i].first && time <= points[i + 1].first) {
-            double t1 = points[i].first;
-            double t2 = points[i + 1].first;
-            double v1 = points[i].second;
-            double v2 = points[i + 1].second;
+bool AudioWorkshopProcessor::applyBreakpointsToTarget() {
+    if (!hasTargetAudio() || !hasBreakpoints() || renderPipeline->isRunning()) return false;
 
-            double ratio = (time - t1) / (t2 - t1);
-            return static_cast<float>(v1 + ratio * (v2 - v1));
-        }
+    RenderPipeline::Settings settings;
+    if (!makeRenderSettings(settings)) return false;
+
+    if (targetStream != nullptr || isTargetEdited()) {
+        // The previous render's file is still mapped until it is replaced. Edited
+        // targets render from their slices too, so the edits are only ever
+        // materialised a chunk at a time.
+        auto destination = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile("AudioWorkshopRender", ".wav", false);
+
+        RenderPipeline::ExportOptions options;
+        options.bitsPerSample = 32;
+
+        auto onRendered = [this](const juce::File& rendered) {
+            auto stream = StreamingAudioFile::open(rendered);
+
+            const juce::ScopedLock sl(processedAudioLock);
+            releaseProcessedStream();
+            processedStreamFile = rendered;
+            processedStream = std::move(stream);
+        };
+
+        return isTargetEdited()
+            ? renderPipeline->startExport(targetEdits, std::move(settings), destination, options, onRendered)
+            : renderPipeline->startExport(*targetStream, std::move(settings), destination, options, onRendered);
     }
 
-    return static_cast<float>(points.back().second);
+    return renderPipeline->start(targetAudio, std::move(settings),
+        [this](juce::AudioBuffer<float>&& rendered) {
+            const juce::ScopedLock sl(processedAudioLock);
+            processedAudio = std::move(rendered);
+        });
 }
 
-void AudioWorkshopProcessor::applyBreakpointsToTarget() {
-    if (!hasTargetAudio() || !hasBreakpoints()) return;
+void AudioWorkshopProcessor::cancelProcessing() {
+    renderPipeline->cancel();
+}
 
-    processing = true;
-    processingProgress = 0.0f;
+bool AudioWorkshopProcessor::waitForProcessing(int timeoutMs) {
+    return renderPipeline->waitForCompletion(timeoutMs);
+}
 
-    processedAudio.makeCopyOf(targetAudio);
+bool AudioWorkshopProcessor::didProcessingComplete() const {
+    return renderPipeline->didLastRenderComplete();
+}
 
+bool AudioWorkshopProcessor::makeRenderSettings(RenderPipeline::Settings& settings) {
     // Determine which feature to apply (use first extracted feature)
     auto features = getExtractedFeatures();
-    if (features.isEmpty()) {
-        processing = false;
-        return;
-    }
+    if (features.isEmpty()) return false;
 
     juce::String featureName = features[0];
 
-    if (featureName.containsIgnoreCase("Amplitude") ||
-        featureName.containsIgnoreCase("ADSR")) {
-        applyAmplitudeModification();
-    }
-    else if (featureName.containsIgnoreCase("Panning") ||
-        featureName.containsIgnoreCase("Pan")) {
-        applyPanningModification();
-    }
-    else {
-        applyAmplitudeModification();
+    {
+        const juce::ScopedLock sl(breakpointLock);
+        auto id = breakpoints.findFeature(featureName);
+        if (breakpoints.getNumOutputs(id) == 0) return false;
+        settings.curve = breakpoints.getPoints(id, 0);
     }
 
-    processing = false;
-    processingProgress = 1.0f;
+    settings.mode = getApplyMode(featureName);
+    settings.intensity = params.getRawParameterValue("intensity")->load();
+    settings.sampleRate = targetSampleRate;
+    return true;
 }
 
-void AudioWorkshopProcessor::applyAmplitudeModification() {
-    auto features = getExtractedFeatures();
-    if (features.isEmpty()) return;
+bool AudioWorkshopProcessor::setRealtimeFeature(const juce::String& featureName, int outputIndex) {
+    const juce::ScopedLock sl(breakpointLock);
 
-    auto it = featureBreakpoints.find(features[0]);
-    if (it == featureBreakpoints.end() || it->second.empty()) return;
+    if (featureName.isNotEmpty() && outputIndex >= breakpoints.getNumOutputs(breakpoints.findFeature(featureName)))
+        return false;
 
-    const auto& envelope = it->second[0];
-    float intensity = params.getRawParameterValue("intensity")->load();
+    realtimeFeature = featureName;
+    realtimeOutput = juce::jmax(0, outputIndex);
+    updateRealtimeCurve();
+    return true;
+}
 
-    int numChannels = processedAudio.getNumChannels();
-    int numSamples = processedAudio.getNumSamples();
+juce::String AudioWorkshopProcessor::getRealtimeFeature() const {
+    const juce::ScopedLock sl(breakpointLock);
+    return realtimeFeature;
+}
 
-    for (int ch = 0; ch < numChannels; ++ch) {
-        float* channelData = processedAudio.getWritePointer(ch);
+void AudioWorkshopProcessor::updateRealtimeCurve(const juce::String& changedFeature) {
+    const juce::ScopedLock sl(breakpointLock);
+    if (changedFeature.isNotEmpty() && changedFeature != realtimeFeature) return;
 
-        for (int i = 0; i < numSamples; ++i) {
-            double time = i / targetSampleRate;
-            float envelopeValue = interpolateValue(envelope, time);
+    // Everything the audio thread needs is copied here, so it never touches the store or the lattice
+    RealtimeCurvePlayer::Curve curve;
 
-            float gain = 1.0f + (envelopeValue - 1.0f) * intensity;
-            channelData[i] *= gain;
+    if (realtimeFeature.isNotEmpty()) {
+        auto id = breakpoints.findFeature(realtimeFeature);
+        if (realtimeOutput < breakpoints.getNumOutputs(id))
+            curve.points = breakpoints.getPoints(id, realtimeOutput);
 
-            if (i % 10000 == 0) {
-                processingProgress = static_cast<float>(i) / numSamples;
-            }
+        curve.mode = getApplyMode(realtimeFeature);
+
+        if (timeLattice) {
+            curve.tempoMap = timeLattice->getTempoMap();
+            curve.ppqn = timeLattice->getPPQN();
         }
     }
+
+    realtimePlayer.publish(std::move(curve));
 }
 
-void AudioWorkshopProcessor::applyPanningModification() {
-    auto features = getExtractedFeatures();
-    if (features.isEmpty() || processedAudio.getNumChannels() < 2) return;
+bool AudioWorkshopProcessor::findExportSource(const juce::AudioBuffer<float>*& buffer,
+    StreamingAudioFile*& stream, const EditList*& edits) const {
 
-    auto it = featureBreakpoints.find(features[0]);
-    if (it == featureBreakpoints.end() || it->second.empty()) return;
+    // Processed result if there is one, otherwise the target as edited
+    buffer = nullptr;
+    stream = nullptr;
+    edits = nullptr;
 
-    const auto& panCurve = it->second[0];
-    float intensity = params.getRawParameterValue("intensity")->load();
+    if (processedStream != nullptr) stream = processedStream.get();
+    else if (processedAudio.getNumSamples() > 0) buffer = &processedAudio;
+    else if (isTargetEdited()) edits = &targetEdits;
+    else if (targetStream != nullptr) stream = targetStream.get();
+    else if (targetAudio.getNumSamples() > 0) buffer = &targetAudio;
 
-    float* leftData = processedAudio.getWritePointer(0);
-    float* rightData = processedAudio.getWritePointer(1);
-    int numSamples = processedAudio.getNumSamples();
+    return buffer != nullptr || stream != nullptr || edits != nullptr;
+}
 
-    for (int i = 0; i < numSamples; ++i) {
-        double time = i / targetSampleRate;
-        float panValue = interpolateValue(panCurve, time);
+bool AudioWorkshopProcessor::exportProcessedAudio(const juce::File& file,
+    const RenderPipeline::ExportOptions& options) {
 
-        panValue *= intensity;
-        panValue = juce::jlimit(-1.0f, 1.0f, panValue);
+    if (renderPipeline->isRunning()) return false;
 
-        float angle = (panValue + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
-        float leftGain = std::cos(angle);
-        float rightGain = std::sin(angle);
+    const juce::ScopedLock sl(processedAudioLock);
 
-        leftData[i] *= leftGain;
-        rightData[i] *= rightGain;
+    const juce::AudioBuffer<float>* buffer;
+    StreamingAudioFile* stream;
+    const EditList* edits;
+    if (!findExportSource(buffer, stream, edits)) return false;
 
-        if (i % 10000 == 0) {
-            processingProgress = static_cast<float>(i) / numSamples;
-        }
-    }
-}
+    // An empty curve copies the audio through unchanged
+    RenderPipeline::Settings settings;
+    settings.sampleRate = targetSampleRate;
 
-void AudioWorkshopProcessor::applyADSRModification() {
-    applyAmplitudeModification();
+    if (edits != nullptr) return RenderPipeline::renderToFile(*edits, file, settings, options);
+
+    return stream != nullptr
+        ? RenderPipeline::renderToFile(*stream, file, settings, options)
+        : RenderPipeline::renderToFile(*buffer, file, settings, options);
 }
 
-void AudioWorkshopProcessor::exportProcessedAudio(const juce::File& file) {
-    if (processedAudio.getNumSamples() == 0) return;
+bool AudioWorkshopProcessor::exportProcessedAudioAsync(const juce::File& file,
+    RenderPipeline::ExportOptions options) {
 
-    juce::WavAudioFormat wavFormat;
-    std::unique_ptr<juce::FileOutputStream> fileStream(file.createOutputStream());
+    if (renderPipeline->isRunning()) return false;
 
-    if (fileStream) {
-        if (auto writer = wavFormat.createWriterFor(fileStream.release(),
-            targetSampleRate,
-            processedAudio.getNumChannels(),
-            24,
-            juce::StringPairArray(),
-            0)) {
-            writer->writeFromAudioSampleBuffer(processedAudio, 0, processedAudio.getNumSamples());
-            delete writer;
-        }
-    }
+    const juce::ScopedLock sl(processedAudioLock);
+
+    const juce::AudioBuffer<float>* buffer;
+    StreamingAudioFile* stream;
+    const EditList* edits;
+    if (!findExportSource(buffer, stream, edits)) return false;
+
+    RenderPipeline::Settings settings;
+    settings.sampleRate = targetSampleRate;
+
+    // Nothing applied yet: render the target through the breakpoints on the way to
+    // disk, so the full processed buffer never has to exist in memory
+    const bool isTarget = edits != nullptr || buffer == &targetAudio || stream == targetStream.get();
+    if (isTarget && hasBreakpoints())
+        makeRenderSettings(settings);
+
+    // The pipeline runs one job at a time, so nothing replaces the source mid-export
+    if (edits != nullptr)
+        return renderPipeline->startExport(*edits, std::move(settings), file, options, nullptr);
+
+    return stream != nullptr
+        ? renderPipeline->startExport(*stream, std::move(settings), file, options, nullptr)
+        : renderPipeline->startExport(*buffer, std::move(settings), file, options, nullptr);
 }
 
 // ============================================================================
 // ADVANCED EDITING OPERATIONS
 // ============================================================================
 
-juce::AudioBuffer<float> AudioWorkshopProcessor::performEditOperation(EditOperation op,
+namespace {
+    // Analysis needs contiguous samples; an unedited buffer target is used as is
+    const juce::AudioBuffer<float>* getAnalysisAudio(const EditList& edits, juce::AudioBuffer<float>& scratch) {
+        if (auto* buffer = edits.getContiguousBuffer()) return buffer;
+        return edits.materialize(scratch) ? &scratch : nullptr;
+    }
+
+    // Whole-buffer analysis of these would pull the entire file into memory
+    bool readsFromStream(const EditList& edits) {
+        return std::any_of(edits.getSlices().begin(), edits.getSlices().end(),
+            [](const EditList::Slice& slice) { return slice.source->getStream() != nullptr; });
+    }
+
+    // The rendered copy is as large as the edited target, so it's let go once
+    // the analysis that needed it is done rather than held until the next load
+    struct ScratchRelease {
+        juce::AudioBuffer<float>& scratch;
+        ~ScratchRelease() { scratch.setSize(0, 0); }
+    };
+}
+
+bool AudioWorkshopProcessor::performEditOperation(EditOperation op,
     const std::vector<double>& params) {
 
-    juce::AudioBuffer<float> result;
+    if (!timeLattice || !hasTargetAudio()) return false;
+
+    EditList edited = targetEdits;
+    if (!applyEditOperation(op, params, edited) || edited == targetEdits) return false;
+
+    // Edits driven by analysis depend on settings that may change before an undo,
+    // and humanizing is random. A stretch would replay exactly, but it re-renders
+    // the whole target, so it keeps its result instead; once the memory limit
+    // drops older steps, the stretch goes with them rather than being redone.
+    const bool replayable = op != EditOperation::SplitByBeats
+        && op != EditOperation::RemoveSilence
+        && op != EditOperation::IsolateTransients
+        && op != EditOperation::SnapToGrid
+        && op != EditOperation::Quantize
+        && op != EditOperation::Humanize
+        && op != EditOperation::TimeStretch;
+
+    editHistory.push({ op, params }, edited, replayable);
+    setTargetEdits(std::move(edited));
+    return true;
+}
+
+bool AudioWorkshopProcessor::undoEdit() {
+    EditList edits = targetEdits;
+    if (!editHistory.undo(edits)) return false;
+
+    setTargetEdits(std::move(edits));
+    return true;
+}
+
+bool AudioWorkshopProcessor::redoEdit() {
+    EditList edits = targetEdits;
+    if (!editHistory.redo(edits)) return false;
+
+    setTargetEdits(std::move(edits));
+    return true;
+}
+
+bool AudioWorkshopProcessor::applyEditOperation(EditOperation op,
+    const std::vector<double>& params, EditList& edits) {
 
-    if (!timeLattice) return result;
+    if (!timeLattice) return false;
+    const ScratchRelease release{ analysisScratch };
+
+    auto param = [&params](size_t index, double fallback) {
+        return index < params.size() ? params[index] : fallback;
+    };
 
     switch (op) {
-    case EditOperation::RemoveSilence:
-        if (hasTargetAudio()) {
-            result = removeSilence(targetAudio, params.empty() ? -40.0 : params[0]);
-        }
-        break;
+    case EditOperation::Trim:
+        edits.trim(secondsToTargetSamples(param(0, 0.0)),
+            secondsToTargetSamples(param(1, edits.getLengthInSamples() / targetSampleRate)));
+        return true;
 
-    case EditOperation::SplitByBeats: {
-        auto segments = splitByBeats(targetAudio);
-        if (!segments.empty()) {
-            result = segments[0];
-        }
-        break;
+    case EditOperation::Cut:
+        edits.cut(secondsToTargetSamples(param(0, 0.0)), secondsToTargetSamples(param(1, 0.0)));
+        return true;
+
+    case EditOperation::Nudge:
+        edits.nudge(secondsToTargetSamples(param(0, 0.0)));
+        return true;
+
+    case EditOperation::TimeStretch: {
+        const double factor = param(0, 1.0);
+        if (factor <= 0.0) return false;
+        if (factor == 1.0) return true;
+
+        // The stretched audio is new material, so it becomes a source of its own
+        const auto* audio = getAnalysisAudio(edits, analysisScratch);
+        if (audio == nullptr) return false;
+
+        edits = EditList(std::make_shared<EditList::Source>(timeLattice->timeStretch(*audio, factor)));
+        return true;
+    }
+
+    case EditOperation::Quantize:
+    case EditOperation::Humanize: {
+        // Moved slices are rendered as new material, like a stretch
+        const auto* audio = getAnalysisAudio(edits, analysisScratch);
+        if (audio == nullptr) return false;
+
+        auto moved = op == EditOperation::Quantize
+            ? timeLattice->quantizeAudio(*audio, param(0, 0.0), param(1, 1.0))
+            : timeLattice->humanize(*audio, 0.0, param(0, 1.0));
+
+        edits = EditList(std::make_shared<EditList::Source>(std::move(moved)));
+        return true;
     }
 
+    case EditOperation::SnapToGrid: {
+        // Each tracked beat is stretched onto the nearest grid line
+        const auto* audio = getAnalysisAudio(edits, analysisScratch);
+        if (audio == nullptr) return false;
+
+        std::vector<double> beats;
+        for (const auto& beat : timeLattice->detectBeats(*audio, getAnalysisFrameCache(audio)))
+            beats.push_back(beat.timeInSeconds);
+
+        if (beats.empty()) return false;
+
+        edits = EditList(std::make_shared<EditList::Source>(timeLattice->warpToGrid(*audio, beats)));
+        return true;
+    }
+
+    case EditOperation::SplitByBeats:
+        // Slices divide at each beat so the beats can be moved on their own later
+        for (auto position : findBeatPositions(edits))
+            edits.splitSlicesAt(position);
+        return true;
+
+    case EditOperation::RemoveSilence:
+        edits = removeSilence(edits, param(0, -40.0));
+        return true;
+
     case EditOperation::IsolateTransients:
-        if (hasTargetAudio()) {
-            result = isolateTransients(targetAudio, params.empty() ? 0.5 : params[0]);
-        }
-        break;
+        edits = isolateTransients(edits, param(0, 0.5));
+        return true;
 
     default:
-        // Use time lattice operations for other cases
-        if (hasTargetAudio()) {
-            result = targetAudio;
-        }
-        break;
+        return false;
     }
-
-    return result;
 }
 
-juce::AudioBuffer<float> AudioWorkshopProcessor::removeSilence(const juce::AudioBuffer<float>& input,
-    double thresholddB) {
-
-    // Use amplitude extractor to find silence
-    AmplitudeExtractor ampExtractor;
-    auto results = ampExtractor.extract(input, targetSampleRate, 0);
+EditList AudioWorkshopProcessor::removeSilence(const EditList& input, double thresholddB) {
+    // Use amplitude extractor to find silence, reading edited targets a chunk at a time
+    auto results = input.getContiguousBuffer() != nullptr
+        ? silenceExtractor.extract(*input.getContiguousBuffer(), targetSampleRate, 0)
+        : silenceExtractor.extractStreaming(input, targetSampleRate, 0);
 
     if (results.empty() || results[0].empty()) return input;
 
     float threshold = std::pow(10.0f, static_cast<float>(thresholddB) / 20.0f);
 
-    // Find non-silent regions
-    std::vector<std::pair<int, int>> nonSilentRegions;
-    int regionStart = -1;
+    // Find silent regions
+    std::vector<std::pair<juce::int64, juce::int64>> silentRegions;
+    juce::int64 regionStart = 0;
 
     for (const auto& [time, value] : results[0]) {
-        int sample = static_cast<int>(time * targetSampleRate);
+        juce::int64 sample = secondsToTargetSamples(time);
 
-        if (value > threshold && regionStart < 0) {
-            regionStart = sample;
-        }
-        else if (value <= threshold && regionStart >= 0) {
-            nonSilentRegions.push_back({ regionStart, sample });
+        if (value > threshold && regionStart >= 0) {
+            silentRegions.push_back({ regionStart, sample });
             regionStart = -1;
         }
+        else if (value <= threshold && regionStart < 0) {
+            regionStart = sample;
+        }
     }
 
     if (regionStart >= 0) {
-        nonSilentRegions.push_back({ regionStart, input.getNumSamples() });
+        silentRegions.push_back({ regionStart, input.getLengthInSamples() });
     }
 
-    // Concatenate non-silent regions
-    int totalSamples = 0;
-    for (const auto& [start, end] : nonSilentRegions) {
-        totalSamples += (end - start);
-    }
-
-    juce::AudioBuffer<float> output(input.getNumChannels(), totalSamples);
-    int writePos = 0;
-
-    for (const auto& [start, end] : nonSilentRegions) {
-        int length = end - start;
-        for (int ch = 0; ch < input.getNumChannels(); ++ch) {
-            output.copyFrom(ch, writePos, input, ch, start, length);
-        }
-        writePos += length;
+    // Cutting from the end keeps the earlier regions' positions valid
+    EditList output = input;
+    for (auto it = silentRegions.rbegin(); it != silentRegions.rend(); ++it) {
+        output.cut(it->first, it->second);
     }
 
     return output;
 }
 
-std::vector<juce::AudioBuffer<float>> AudioWorkshopProcessor::splitByBeats(
-    const juce::AudioBuffer<float>& input) {
+std::vector<EditList> AudioWorkshopProcessor::splitByBeats(const EditList& input) {
+    return input.split(findBeatPositions(input));
+}
 
-    if (!timeLattice) return {};
+std::vector<juce::int64> AudioWorkshopProcessor::findBeatPositions(const EditList& input) {
+    if (!timeLattice || readsFromStream(input)) return {};
 
-    auto beats = timeLattice->detectBeats(input);
+    const ScratchRelease release{ analysisScratch };
+    const auto* audio = getAnalysisAudio(input, analysisScratch);
+    if (audio == nullptr) return {};
 
-    std::vector<double> splitTimes;
+    auto beats = timeLattice->detectBeats(*audio, getAnalysisFrameCache(audio));
+
+    std::vector<juce::int64> positions;
     for (const auto& beat : beats) {
-        splitTimes.push_back(beat.timeInSeconds);
+        positions.push_back(secondsToTargetSamples(beat.timeInSeconds));
     }
 
-    return timeLattice->split(input, splitTimes);
+    return positions;
 }
 
-juce::AudioBuffer<float> AudioWorkshopProcessor::isolateTransients(
-    const juce::AudioBuffer<float>& input, double sensitivity) {
+juce::String AudioWorkshopProcessor::getFeatureCacheKey(const juce::String& featureName,
+    const FeatureExtractor& extractor, int channel) {
+    if (featureCache == nullptr) return {};
+
+    // One pass over the audio per load, however many features are extracted; jobs
+    // asking at once wait for the first rather than hashing again
+    const juce::ScopedLock sl(sourceHashLock);
+
+    if (sourceAudioHash.isEmpty()) {
+        sourceAudioHash = sourceStream != nullptr
+            ? FeatureCache::hashAudio(*sourceStream)
+            : FeatureCache::hashAudio(sourceAudio, sourceSampleRate);
+    }
+
+    return FeatureCache::makeKey(sourceAudioHash, extractor, featureName, channel);
+}
 
-    auto transients = timeLattice->detectTransients(input, sensitivity);
+bool AudioWorkshopProcessor::canAnalyseWholeTarget() const {
+    return hasTargetAudio() && !readsFromStream(targetEdits);
+}
 
-    // Create output with only transient regions
-    juce::AudioBuffer<float> output = input;
-    output.clear();
+void AudioWorkshopProcessor::clearSourceAudioHash() {
+    const juce::ScopedLock sl(sourceHashLock);
+    sourceAudioHash.clear();
+}
+
+double AudioWorkshopProcessor::detectTargetTempo() {
+    if (!timeLattice || !hasTargetAudio() || readsFromStream(targetEdits)) return 0.0;
+
+    const ScratchRelease release{ analysisScratch };
+    const auto* audio = getAnalysisAudio(targetEdits, analysisScratch);
+    if (audio == nullptr) return 0.0;
+
+    const juce::ScopedLock sl(breakpointLock);
+    double bpm = timeLattice->applyDetectedTempo(*audio, 0.0, getAnalysisFrameCache(audio));
+    updateRealtimeCurve();
+    return bpm;
+}
+
+STFTFrameCache* AudioWorkshopProcessor::getAnalysisFrameCache(const juce::AudioBuffer<float>* audio) const {
+    // The cache is keyed on sample pointers, so only the loaded target, which
+    // clears its own entries whenever it changes, is safe to cache; rendered edits come and go
+    return audio == &targetAudio ? frameCache.get() : nullptr;
+}
+
+EditList AudioWorkshopProcessor::isolateTransients(const EditList& input, double sensitivity) {
+    if (readsFromStream(input)) return input;
+
+    const ScratchRelease release{ analysisScratch };
+    const auto* audio = getAnalysisAudio(input, analysisScratch);
+    if (audio == nullptr || !timeLattice) return input;
+
+    auto transients = timeLattice->detectTransients(*audio, sensitivity, getAnalysisFrameCache(audio));
 
     float windowMs = 50.0f; // 50ms around each transient
-    int windowSamples = static_cast<int>(windowMs * 0.001 * targetSampleRate);
+    juce::int64 windowSamples = secondsToTargetSamples(windowMs * 0.001);
 
+    // Merge overlapping windows so each stretch of audio is kept once
+    std::vector<std::pair<juce::int64, juce::int64>> windows;
     for (double transientTime : transients) {
-        int centerSample = static_cast<int>(transientTime * targetSampleRate);
-        int start = juce::jmax(0, centerSample - windowSamples / 2);
-        int end = juce::jmin(input.getNumSamples(), centerSample + windowSamples / 2);
+        juce::int64 centerSample = secondsToTargetSamples(transientTime);
+        juce::int64 start = juce::jmax<juce::int64>(0, centerSample - windowSamples / 2);
+        juce::int64 end = juce::jmin(input.getLengthInSamples(), centerSample + windowSamples / 2);
 
-        for (int ch = 0; ch < input.getNumChannels(); ++ch) {
-            output.copyFrom(ch, start, input, ch, start, end - start);
-        }
+        if (start >= end) continue;
+
+        if (!windows.empty() && start <= windows.back().second)
+            windows.back().second = juce::jmax(windows.back().second, end);
+        else
+            windows.push_back({ start, end });
+    }
+
+    // Silence everything between the windows, leaving the windows where they were
+    EditList output = input;
+    juce::int64 keptUntil = 0;
+
+    for (const auto& [start, end] : windows) {
+        output.silence(keptUntil, start);
+        keptUntil = end;
     }
+    output.silence(keptUntil, input.getLengthInSamples());
 
     return output;
 }
 
+juce::int64 AudioWorkshopProcessor::secondsToTargetSamples(double seconds) const {
+    return static_cast<juce::int64>(std::floor(seconds * targetSampleRate + 0.5));
+}
+
 // ============================================================================
 // STATE MANAGEMENT
 // ============================================================================
@@ -7,6 +7,19 @@
 #include <JuceHeader.h>
 #include "AudioTimeLattice.h"
 #include "FeatureExtractors.h"
+#include "AnalysisJobEngine.h"
+#include "BreakpointEnvelope.h"
+#include "BreakpointFile.h"
+#include "BreakpointSimplifier.h"
+#include "BreakpointStore.h"
+#include "EditHistory.h"
+#include "EditList.h"
+#include "FeatureCache.h"
+#include "RealtimeCurvePlayer.h"
+#include "RenderPipeline.h"
+#include "StreamingAudioFile.h"
+#include "Telemetry.h"
+#include "WaveformOverview.h"
 #include <map>
 #include <vector>
 
@@ -42,31 +55,61 @@ public:
     // AUDIO FILE MANAGEMENT (Dual Audio System)
     // ========================================================================
 
+    // Files longer than this many samples per channel stay on disk and are
+    // streamed through extraction and rendering in chunks instead of loaded
+    void setStreamingThreshold(juce::int64 numSamples);
+    juce::int64 getStreamingThreshold() const { return streamingThreshold; }
+
     // Source audio (for feature extraction)
     bool loadSourceAudio(const juce::File& file);
     void clearSourceAudio();
-    bool hasSourceAudio() const { return sourceAudio.getNumSamples() > 0; }
-    const juce::AudioBuffer<float>& getSourceAudio() const { return sourceAudio; }
+    bool hasSourceAudio() const { return sourceAudio.getNumSamples() > 0 || sourceStream != nullptr; }
+    bool isSourceStreaming() const { return sourceStream != nullptr; }
+    juce::int64 getSourceLengthInSamples() const;
+    const juce::AudioBuffer<float>& getSourceAudio() const { return sourceAudio; }   // Empty while streaming
+    const WaveformOverview& getSourceOverview() const { return sourceOverview; }
     double getSourceSampleRate() const { return sourceSampleRate; }
     juce::String getSourceFileName() const { return sourceFileName; }
 
     // Target audio (for breakpoint application)
     bool loadTargetAudio(const juce::File& file);
     void clearTargetAudio();
-    bool hasTargetAudio() const { return targetAudio.getNumSamples() > 0; }
-    const juce::AudioBuffer<float>& getTargetAudio() const { return targetAudio; }
-    const juce::AudioBuffer<float>& getProcessedAudio() const { return processedAudio; }
+    bool hasTargetAudio() const { return targetAudio.getNumSamples() > 0 || targetStream != nullptr; }
+    bool isTargetStreaming() const { return targetStream != nullptr; }
+    juce::int64 getTargetLengthInSamples() const;
+    const juce::AudioBuffer<float>& getTargetAudio() const { return targetAudio; }         // Empty while streaming
+    const juce::AudioBuffer<float>& getProcessedAudio() const { return processedAudio; }   // Not while isProcessing()
+    const WaveformOverview& getTargetOverview() const { return isTargetEdited() ? targetOverview : targetSourceOverview; }
     double getTargetSampleRate() const { return targetSampleRate; }
+    const EditList& getTargetEdits() const { return targetEdits; }   // The target as currently edited
+    bool isTargetEdited() const { return hasTargetAudio() && !targetEdits.isUnedited(); }
+    void revertTargetEdits();   // Also forgets the edit history
     juce::String getTargetFileName() const { return targetFileName; }
 
     // ========================================================================
     // FEATURE EXTRACTION (from AudioDeconstructor)
     // ========================================================================
 
+    // Synchronous extraction on the calling thread
     void extractFeature(const juce::String& featureName, int channel = 0);
+
+    // Background extraction - results are published as each job finishes
+    bool extractFeatureAsync(const juce::String& featureName, int channel = 0);
     void extractAllFeatures();
+    void cancelAnalysis();
+    bool waitForAnalysis(int timeoutMs = -1);
+    bool isAnalysisRunning() const { return isAnalyzing.load(); }
+    void setParallelExtraction(bool shouldSplitAcrossCores) { parallelExtraction = shouldSplitAcrossCores; }
+    float getAnalysisProgress() const { return analysisProgress.load(); }
+
     void extractADSRFromAmplitude();
 
+    // Results already extracted from the same audio with the same settings are
+    // read back from the cache instead. All processors share one cache in the
+    // user's application data folder unless given another; nullptr disables it.
+    void setFeatureCache(std::shared_ptr<FeatureCache> cache) { featureCache = std::move(cache); }
+    FeatureCache* getFeatureCache() const { return featureCache.get(); }
+
     bool isFeatureExtracted(const juce::String& featureName) const;
     juce::StringArray getExtractedFeatures() const;
     juce::StringArray getAvailableFeatures() const;
@@ -79,28 +122,39 @@ public:
     // BREAKPOINT MANAGEMENT (Unified System)
     // ========================================================================
 
-    // Access breakpoints
+    // Access breakpoints. The view shares the stored columns rather than
+    // copying them and stays valid after the store changes.
     std::vector<std::pair<double, double>> getBreakpointsForDisplay(
         const juce::String& featureName, int outputIndex = 0) const;
+    BreakpointStore::View getBreakpointView(const juce::String& featureName, int outputIndex = 0) const;
 
-    // Edit breakpoints
-    void addBreakpoint(const juce::String& featureName, int outputIndex,
+    // Edit breakpoints. Points stay sorted, so add and update return the
+    // point's index afterwards (-1 if the output doesn't exist).
+    int addBreakpoint(const juce::String& featureName, int outputIndex,
         double time, double value);
-    void updateBreakpoint(const juce::String& featureName, int outputIndex,
+    int updateBreakpoint(const juce::String& featureName, int outputIndex,
         size_t pointIndex, double time, double value);
     void removeBreakpoint(const juce::String& featureName, int outputIndex,
         size_t pointIndex);
-    void sortBreakpoints(const juce::String& featureName, int outputIndex);
 
-    // Decimation for performance
+    // Point reduction. Decimation keeps the targetPoints that best preserve the
+    // curve; simplification drops whatever the time grid resolution can't resolve.
     void decimateBreakpoints(const juce::String& featureName, int outputIndex,
         int targetPoints);
+    void simplifyBreakpoints(const juce::String& featureName, int outputIndex);
+
+    // Extracted curves are simplified before they are stored
+    void setSimplifyExtractedCurves(bool shouldSimplify) { simplifyExtractedCurves = shouldSimplify; }
+    bool getSimplifyExtractedCurves() const { return simplifyExtractedCurves; }
     int getCurrentBreakpointCount(const juce::String& featureName, int outputIndex) const;
 
-    // File I/O for breakpoints
+    // File I/O for breakpoints. Binary files are detected on load; saving picks
+    // the binary format for the BreakpointFile extension and text otherwise.
     bool loadBreakpointFile(const juce::File& file);
     void saveBreakpoints(const juce::String& featureName, const juce::File& file);
-    void saveAllBreakpoints(const juce::File& directory);
+    bool saveBinaryBreakpoints(const juce::String& featureName, const juce::File& file,
+        BreakpointFile::Encoding encoding = BreakpointFile::Encoding::Plain);
+    void saveAllBreakpoints(const juce::File& directory, bool binary = false);
     void clearBreakpoints();
     bool hasBreakpoints() const;
 
@@ -121,42 +175,85 @@ public:
     // AUDIO PROCESSING & APPLICATION
     // ========================================================================
 
-    void applyBreakpointsToTarget();
-    void exportProcessedAudio(const juce::File& file);
+    // Renders processedAudio in the background; returns false if nothing could be started
+    bool applyBreakpointsToTarget();
+    void cancelProcessing();
+    bool waitForProcessing(int timeoutMs = -1);
+    bool didProcessingComplete() const;
+
+    // Writes the processed result (or the target, if nothing has been applied) on the calling thread
+    bool exportProcessedAudio(const juce::File& file, const RenderPipeline::ExportOptions& options = {});
+
+    // Renders to disk in the background through a writer thread; progress is reported
+    // like processing. Without an applied result the breakpoints are rendered on the fly.
+    bool exportProcessedAudioAsync(const juce::File& file, RenderPipeline::ExportOptions options = {});
+
     bool isProcessing() const { return processing.load(); }
     float getProcessingProgress() const { return processingProgress.load(); }
 
+    // Applies a curve to the host's audio in processBlock, following the
+    // transport through the lattice's tempo map. The curve is republished
+    // whenever it or the tempo map changes; an empty name turns it off.
+    bool setRealtimeFeature(const juce::String& featureName, int outputIndex = 0);
+    void clearRealtimeFeature() { setRealtimeFeature({}); }
+    juce::String getRealtimeFeature() const;
+    bool isRealtimeActive() const { return realtimePlayer.isActive(); }
+
+    // ========================================================================
+    // TELEMETRY
+    // ========================================================================
+
+    // Timings of extraction, quantization, render blocks, file I/O and editor
+    // painting. Recording is process-wide, so every processor reports the
+    // same timings.
+    Telemetry::Snapshot getTelemetry() const { return Telemetry::getSnapshot(); }
+    void resetTelemetry() { Telemetry::reset(); }
+    void setTelemetryEnabled(bool shouldRecord) { Telemetry::setEnabled(shouldRecord); }
+    bool isTelemetryEnabled() const { return Telemetry::isEnabled(); }
+
+    // Writes the recent timings as a Chrome trace, for chrome://tracing or Perfetto
+    bool dumpTelemetry(const juce::File& file) const { return Telemetry::writeChromeTrace(file); }
+
     // ========================================================================
     // AUDIO EDITING OPERATIONS (Using Time Lattice + Analysis)
     // ========================================================================
 
-    enum class EditOperation {
-        None,
-        Trim,
-        Cut,
-        Split,
-        Nudge,
-        TimeStretch,
-        Quantize,
-        Humanize,
-        DetectBeats,
-        SnapToGrid,
-        Crossfade,
-        RemoveSilence,     // NEW: Use amplitude analysis
-        IsolateTransients, // NEW: Use transient detection
-        SplitByBeats      // NEW: Use beat detection
-    };
-
-    juce::AudioBuffer<float> performEditOperation(EditOperation op,
+    // Declared with the edit history, which records and replays them
+    using EditOperation = ::EditOperation;
+
+    // Edits the target's edit list in place; times in params are in seconds.
+    // Nothing is copied until the target is rendered or exported. Returns
+    // false if the operation changed nothing.
+    bool performEditOperation(EditOperation op,
         const std::vector<double>& params);
 
-    // Advanced editing using analysis
-    juce::AudioBuffer<float> removeSilence(const juce::AudioBuffer<float>& input,
+    // Edit history. Undo rebuilds from the nearest snapshot by replaying the
+    // recorded operations, so the limit bounds snapshot memory, not depth.
+    bool undoEdit();
+    bool redoEdit();
+    bool canUndoEdit() const { return editHistory.canUndo(); }
+    bool canRedoEdit() const { return editHistory.canRedo(); }
+    void setEditHistoryMemoryLimit(size_t bytes) { editHistory.setMemoryLimit(bytes); }
+    size_t getEditHistoryMemoryUsage() const { return editHistory.getMemoryUsage(); }
+
+    // Advanced editing using analysis. These read the edited audio to analyse
+    // it but return edit lists over the same sources. Removing silence reads
+    // it a chunk at a time; the beat and transient edits need it whole, so they
+    // leave lists that read from a stream unchanged rather than load the file.
+    EditList removeSilence(const EditList& input,
         double threshold = -40.0); // dB
-    std::vector<juce::AudioBuffer<float>> splitByBeats(const juce::AudioBuffer<float>& input);
-    juce::AudioBuffer<float> isolateTransients(const juce::AudioBuffer<float>& input,
+    std::vector<EditList> splitByBeats(const EditList& input);
+    EditList isolateTransients(const EditList& input,
         double sensitivity = 0.5);
 
+    // False while the edited target still reads from a stream, when the beat
+    // and transient analysis above and tempo detection are unavailable
+    bool canAnalyseWholeTarget() const;
+
+    // Sets the lattice tempo map from the beats tracked in the edited target.
+    // Returns the tempo, or 0 if none was found.
+    double detectTargetTempo();
+
     juce::AudioProcessorValueTreeState params;
     std::unique_ptr<AudioTimeLattice> timeLattice;
 
@@ -166,6 +263,34 @@ private:
     juce::AudioBuffer<float> targetAudio;      // For application
     juce::AudioBuffer<float> processedAudio;   // Result
 
+    // Streamed counterparts for files over the threshold; at most one of each pair is in use
+    static constexpr juce::int64 defaultStreamingThreshold = juce::int64(1) << 26;
+    juce::int64 streamingThreshold = defaultStreamingThreshold;
+    std::unique_ptr<StreamingAudioFile> sourceStream;
+    std::unique_ptr<StreamingAudioFile> targetStream;
+
+    // Slices over targetAudio or targetStream; edits rewrite these, never the audio
+    EditList targetEdits;
+    EditHistory editHistory{ [this](EditList& edits, const EditHistory::Step& step) {
+        return applyEditOperation(step.operation, step.params, edits);
+    } };
+    std::unique_ptr<StreamingAudioFile> processedStream;   // Streamed renders land in a temp file
+
+    // Edited targets are rendered here for the length of one analysis
+    juce::AudioBuffer<float> analysisScratch;
+    AmplitudeExtractor silenceExtractor;   // Default settings, independent of the extraction parameters
+    juce::File processedStreamFile;
+
+    // Built once per load for the editor's waveform displays
+    WaveformOverview sourceOverview;
+    WaveformOverview targetSourceOverview;
+
+    // The edited target, derived from its sources' overviews on each edit
+    WaveformOverview targetOverview;
+
+    // Audio the edits rendered as new material, with its overview, for as long as the edits use it
+    std::vector<std::pair<std::weak_ptr<const EditList::Source>, std::unique_ptr<WaveformOverview>>> renderedSourceOverviews;
+
     double sourceSampleRate = 44100.0;
     double targetSampleRate = 44100.0;
     juce::String sourceFileName;
@@ -173,27 +298,71 @@ private:
 
     // Feature extraction system
     std::map<juce::String, std::unique_ptr<FeatureExtractor>> extractors;
-    std::map<juce::String, std::vector<std::vector<std::pair<double, double>>>> featureBreakpoints;
+    BreakpointStore breakpoints;
+    juce::CriticalSection breakpointLock;   // Guards breakpoints and timeLattice changes against analysis jobs
 
     std::atomic<bool> isAnalyzing{ false };
     std::atomic<float> analysisProgress{ 0.0f };
+    std::unique_ptr<AnalysisJobEngine> analysisEngine;
+    std::shared_ptr<STFTFrameCache> frameCache = std::make_shared<STFTFrameCache>();   // One FFT pass per file
+    std::shared_ptr<FeatureCache> featureCache;
+    juce::String sourceAudioHash;     // Worked out on the first extraction after each load
+    juce::CriticalSection sourceHashLock;   // Guards sourceAudioHash against analysis jobs
+    bool parallelExtraction = true;   // Chunk hop-based extractors across cores
 
     // Time grid state
     int currentPPQN = 960;
     ValueResolution currentResolution = ValueResolution::Bit14;
+    bool simplifyExtractedCurves = true;   // Error-bounded by currentResolution
 
     // Processing state
     std::atomic<bool> processing{ false };
     std::atomic<float> processingProgress{ 0.0f };
+    std::unique_ptr<RenderPipeline> renderPipeline;
+    juce::CriticalSection processedAudioLock;   // Guards processedAudio against the render thread
+
+    // Real-time application; the feature and output are guarded by breakpointLock
+    RealtimeCurvePlayer realtimePlayer;
+    juce::String realtimeFeature;
+    int realtimeOutput = 0;
+    std::atomic<float>* intensityParameter = nullptr;
 
     // Helper methods
     void initializeExtractors();
+    void applyExtractorSettings(FeatureExtractor& extractor);
+    // The settings are read by the caller; jobs capture them when submitted.
+    // A threshold of 0 publishes the curves as extracted.
+    void publishFeatureResults(const juce::String& featureName,
+        std::vector<std::vector<std::pair<double, double>>>&& results);
+    void publishFeatureResults(const juce::String& featureName,
+        std::vector<std::vector<std::pair<double, double>>>&& results, double simplifyThreshold);
+    double getSimplifyThreshold() const;
+    static void simplifyCurve(std::vector<std::pair<double, double>>& points, double threshold);
+    bool loadBinaryBreakpointFile(const juce::File& file);
+    juce::String getBreakpointOutputName(const juce::String& featureName, int outputIndex) const;
     float interpolateValue(const std::vector<std::pair<double, double>>& points, double time);
 
-    // Processing methods
-    void applyAmplitudeModification();
-    void applyPanningModification();
-    void applyADSRModification();
+    // Builds the render settings from the first extracted feature
+    bool makeRenderSettings(RenderPipeline::Settings& settings);
+
+    // Republishes the real-time curve if it follows changedFeature, or always if that's empty
+    void updateRealtimeCurve(const juce::String& changedFeature = {});
+
+    // Opens a file, keeping it streamed if it is over the threshold or loading it into buffer
+    bool openAudioFile(const juce::File& file, juce::AudioBuffer<float>& buffer,
+        std::unique_ptr<StreamingAudioFile>& stream, double& sampleRate);
+    void releaseProcessedStream();
+    void updateTargetOverview();
+    bool findExportSource(const juce::AudioBuffer<float>*& buffer, StreamingAudioFile*& stream,
+        const EditList*& edits) const;
+    void setTargetEdits(EditList&& edits);
+    bool applyEditOperation(EditOperation op, const std::vector<double>& params, EditList& edits);
+    std::vector<juce::int64> findBeatPositions(const EditList& input);
+    juce::String getFeatureCacheKey(const juce::String& featureName, const FeatureExtractor& extractor, int channel);
+    void clearSourceAudioHash();
+    STFTFrameCache* getAnalysisFrameCache(const juce::AudioBuffer<float>* audio) const;
+    juce::int64 secondsToTargetSamples(double seconds) const;
+    int getSourceNumChannels() const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioWorkshopProcessor)
 };
\ No newline at end of file
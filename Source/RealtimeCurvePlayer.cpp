@@ -0,0 +1,132 @@
+// ============================================================================
+// RealtimeCurvePlayer.cpp
+// ============================================================================
+#include "RealtimeCurvePlayer.h"
+#include "BreakpointEnvelope.h"
+
+RealtimeCurvePlayer::RealtimeCurvePlayer() {
+    prepare(sampleRate, 512);
+}
+
+void RealtimeCurvePlayer::publish(Curve curve) {
+    const juce::ScopedLock sl(publishLock);
+    const bool hasPoints = !curve.points.empty();
+    const int back = 1 - front.load();
+
+    // The audio thread may still be in the slot from before the last flip
+    while (inUse.load() == back)
+        juce::Thread::yield();
+
+    // The old curve is freed here rather than on the audio thread
+    slots[back] = std::move(curve);
+    front.store(back);
+    active.store(hasPoints);
+}
+
+void RealtimeCurvePlayer::prepare(double newSampleRate, int maximumBlockSize) {
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+    const auto size = static_cast<size_t>(juce::jmax(1, maximumBlockSize));
+    leftGain.assign(size, 1.0f);
+    rightGain.assign(size, 1.0f);
+    curveTimes.assign(size, 0.0);
+    freeRunningSample = 0;
+}
+
+const RealtimeCurvePlayer::Curve& RealtimeCurvePlayer::acquire() {
+    // Claim the front slot, then make sure it didn't flip before the claim was seen
+    int index;
+    do {
+        index = front.load();
+        inUse.store(index);
+    } while (index != front.load());
+
+    return slots[index];
+}
+
+RealtimeCurvePlayer::Position RealtimeCurvePlayer::findPosition(juce::AudioPlayHead* playHead, int numSamples) {
+    Position position;
+
+    if (playHead != nullptr) {
+        if (const auto info = playHead->getPosition()) {
+            // A stopped transport holds the curve where it is
+            const bool playing = info->getIsPlaying();
+
+            if (const auto ppq = info->getPpqPosition()) {
+                position.musical = true;
+                position.start = *ppq;
+                if (playing) position.perSample = info->getBpm().orFallback(120.0) / (60.0 * sampleRate);
+                return position;
+            }
+
+            if (const auto samples = info->getTimeInSamples()) {
+                position.start = static_cast<double>(*samples) / sampleRate;
+                if (playing) position.perSample = 1.0 / sampleRate;
+                return position;
+            }
+        }
+    }
+
+    position.start = static_cast<double>(freeRunningSample) / sampleRate;
+    position.perSample = 1.0 / sampleRate;
+    freeRunningSample += numSamples;
+    return position;
+}
+
+void RealtimeCurvePlayer::process(juce::AudioBuffer<float>& buffer, juce::AudioPlayHead* playHead, float intensity) {
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+
+    // Worked out even while inactive, so the free-running count keeps time
+    const auto position = findPosition(playHead, numSamples);
+    if (!active.load() || numSamples == 0 || numChannels == 0) return;
+
+    const auto& curve = acquire();
+    const bool panning = curve.mode == RenderPipeline::Mode::Pan;
+
+    // Panning on mono leaves the audio unchanged, as in an offline render
+    if (curve.points.empty() || (panning && numChannels < 2)) {
+        release();
+        return;
+    }
+
+    BreakpointEnvelope envelope(curve.points);
+    BreakpointEnvelope::Cursor cursor(envelope);
+
+    // Hosts may send more than they announced in prepareToPlay, so go through the scratch in chunks
+    const int chunkSize = static_cast<int>(leftGain.size());
+
+    for (int start = 0; start < numSamples; start += chunkSize) {
+        const int length = juce::jmin(chunkSize, numSamples - start);
+
+        for (int i = 0; i < length; ++i)
+            curveTimes[i] = position.start + (start + i) * position.perSample;
+
+        if (position.musical) {
+            for (int i = 0; i < length; ++i)
+                curveTimes[i] *= curve.ppqn;
+            curve.tempoMap.ticksToSeconds(curveTimes.data(), curveTimes.data(), length);
+        }
+
+        if (panning) {
+            for (int i = 0; i < length; ++i) {
+                float panValue = juce::jlimit(-1.0f, 1.0f, cursor.getValueAt(curveTimes[i]) * intensity);
+                float angle = (panValue + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+                leftGain[i] = std::cos(angle);
+                rightGain[i] = std::sin(angle);
+            }
+
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(0, start), leftGain.data(), length);
+            juce::FloatVectorOperations::multiply(buffer.getWritePointer(1, start), rightGain.data(), length);
+        }
+        else {
+            for (int i = 0; i < length; ++i)
+                leftGain[i] = 1.0f + (cursor.getValueAt(curveTimes[i]) - 1.0f) * intensity;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch, start), leftGain.data(), length);
+        }
+    }
+
+    release();
+}
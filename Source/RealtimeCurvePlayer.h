@@ -0,0 +1,74 @@
+// ============================================================================
+// RealtimeCurvePlayer.h
+// Applies a breakpoint curve to the host's audio as it plays
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "AudioTimeLattice.h"
+#include "RenderPipeline.h"
+#include <atomic>
+#include <vector>
+
+// Curves are published from the message thread into a double buffer: the
+// writer fills the slot the audio thread isn't using and flips the index, so
+// process() never locks or allocates. A publish waits at most one audio block
+// for the audio thread to let go of the slot it is about to overwrite.
+class RealtimeCurvePlayer {
+public:
+    struct Curve {
+        RenderPipeline::Mode mode = RenderPipeline::Mode::Gain;
+        std::vector<std::pair<double, double>> points;   // Seconds on the tempo map's timeline
+
+        // Host positions in quarter notes are mapped through this onto the curve
+        TempoMap tempoMap;
+        int ppqn = 960;
+    };
+
+    RealtimeCurvePlayer();
+
+    // ========================================================================
+    // Message thread
+    // ========================================================================
+
+    // An empty curve turns the player off
+    void publish(Curve curve);
+    void clear() { publish({}); }
+    bool isActive() const { return active.load(); }
+
+    // Sizes the scratch gains; call from prepareToPlay, before processing starts
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // ========================================================================
+    // Audio thread
+    // ========================================================================
+
+    // Follows the play head's musical position when it has one, its time in
+    // samples when it doesn't, and a free-running count without a play head
+    void process(juce::AudioBuffer<float>& buffer, juce::AudioPlayHead* playHead, float intensity);
+
+private:
+    Curve slots[2];
+    std::atomic<int> front{ 0 };       // Slot the audio thread should read next
+    std::atomic<int> inUse{ -1 };      // Slot the audio thread is reading, or -1
+    std::atomic<bool> active{ false };
+    juce::CriticalSection publishLock;   // Serialises writers; never taken by the audio thread
+
+    double sampleRate = 44100.0;
+    std::vector<float> leftGain;
+    std::vector<float> rightGain;
+    std::vector<double> curveTimes;
+    juce::int64 freeRunningSample = 0;
+
+    // Where the block starts on the host's timeline and how far each sample moves it
+    struct Position {
+        bool musical = false;      // Quarter notes rather than seconds
+        double start = 0.0;
+        double perSample = 0.0;
+    };
+
+    const Curve& acquire();
+    void release() { inUse.store(-1); }
+    Position findPosition(juce::AudioPlayHead* playHead, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeCurvePlayer)
+};
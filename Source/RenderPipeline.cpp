@@ -0,0 +1,403 @@
+// ============================================================================
+// RenderPipeline.cpp
+// ============================================================================
+#include "RenderPipeline.h"
+#include "BreakpointEnvelope.h"
+#include "ParallelFor.h"
+#include "Telemetry.h"
+
+// ============================================================================
+// RenderJob
+// ============================================================================
+
+class RenderPipeline::RenderJob : public juce::ThreadPoolJob {
+public:
+    RenderJob(RenderPipeline& owner, Settings settings)
+        : juce::ThreadPoolJob("Render breakpoints"), settings(std::move(settings)), owner(owner) {
+    }
+
+    JobStatus runJob() override {
+        bool completed = renderAll([this](float fraction) {
+            owner.progress = fraction;
+            return !shouldExit();
+        });
+
+        if (completed && !shouldExit()) {
+            complete();
+            owner.progress = 1.0f;
+            owner.lastRenderCompleted = true;
+        }
+
+        owner.busy = false;
+        return jobHasFinished;
+    }
+
+protected:
+    // Returns false if the progress callback asked to stop or the render failed
+    virtual bool renderAll(const std::function<bool(float)>& progress) = 0;
+
+    // Hands the result over; only called after a successful render
+    virtual void complete() = 0;
+
+    const Settings settings;
+
+private:
+    RenderPipeline& owner;
+};
+
+class RenderPipeline::BufferRenderJob : public RenderJob {
+public:
+    BufferRenderJob(RenderPipeline& owner,
+        const juce::AudioBuffer<float>& source,
+        Settings settings,
+        CompletionCallback onComplete)
+        : RenderJob(owner, std::move(settings)), source(source), onComplete(std::move(onComplete)) {
+    }
+
+protected:
+    bool renderAll(const std::function<bool(float)>& progress) override {
+        return render(source, rendered, settings, progress);
+    }
+
+    void complete() override {
+        if (onComplete) onComplete(std::move(rendered));
+    }
+
+private:
+    const juce::AudioBuffer<float>& source;
+    juce::AudioBuffer<float> rendered;
+    CompletionCallback onComplete;
+};
+
+class RenderPipeline::FileRenderJob : public RenderJob {
+public:
+    FileRenderJob(RenderPipeline& owner,
+        std::function<bool(const juce::File&, const Settings&, const ExportOptions&, const std::function<bool(float)>&)> renderFile,
+        Settings settings,
+        const juce::File& destination,
+        ExportOptions options,
+        FileCompletionCallback onComplete)
+        : RenderJob(owner, std::move(settings)), renderFile(std::move(renderFile)),
+        destination(destination), options(options), onComplete(std::move(onComplete)) {
+    }
+
+protected:
+    bool renderAll(const std::function<bool(float)>& progress) override {
+        return renderFile(destination, settings, options, progress);
+    }
+
+    void complete() override {
+        if (onComplete) onComplete(destination);
+    }
+
+private:
+    std::function<bool(const juce::File&, const Settings&, const ExportOptions&, const std::function<bool(float)>&)> renderFile;
+    const juce::File destination;
+    const ExportOptions options;
+    FileCompletionCallback onComplete;
+};
+
+// ============================================================================
+// ExportOptions
+// ============================================================================
+
+juce::String RenderPipeline::ExportOptions::getFileExtension() const {
+    switch (format) {
+    case Format::Aiff: return ".aiff";
+    case Format::Flac: return ".flac";
+    default:           return ".wav";
+    }
+}
+
+// ============================================================================
+// RenderPipeline
+// ============================================================================
+
+RenderPipeline::RenderPipeline(std::atomic<bool>& busyFlag, std::atomic<float>& progressValue)
+    : busy(busyFlag), progress(progressValue) {
+}
+
+RenderPipeline::~RenderPipeline() {
+    cancel();
+}
+
+bool RenderPipeline::start(const juce::AudioBuffer<float>& source, Settings settings,
+    CompletionCallback onComplete) {
+
+    return launch(std::make_unique<BufferRenderJob>(*this, source, std::move(settings), std::move(onComplete)));
+}
+
+bool RenderPipeline::startExport(const juce::AudioBuffer<float>& source, Settings settings,
+    const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete) {
+
+    auto renderFile = [&source](const juce::File& file, const Settings& renderSettings,
+        const ExportOptions& exportOptions, const std::function<bool(float)>& progress) {
+        return renderToFile(source, file, renderSettings, exportOptions, progress);
+    };
+
+    return launch(std::make_unique<FileRenderJob>(*this, renderFile, std::move(settings),
+        destination, options, std::move(onComplete)));
+}
+
+bool RenderPipeline::startExport(StreamingAudioFile& source, Settings settings,
+    const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete) {
+
+    auto renderFile = [&source](const juce::File& file, const Settings& renderSettings,
+        const ExportOptions& exportOptions, const std::function<bool(float)>& progress) {
+        return renderToFile(source, file, renderSettings, exportOptions, progress);
+    };
+
+    return launch(std::make_unique<FileRenderJob>(*this, renderFile, std::move(settings),
+        destination, options, std::move(onComplete)));
+}
+
+bool RenderPipeline::startExport(const EditList& source, Settings settings,
+    const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete) {
+
+    auto renderFile = [source](const juce::File& file, const Settings& renderSettings,
+        const ExportOptions& exportOptions, const std::function<bool(float)>& progress) {
+        return renderToFile(source, file, renderSettings, exportOptions, progress);
+    };
+
+    return launch(std::make_unique<FileRenderJob>(*this, renderFile, std::move(settings),
+        destination, options, std::move(onComplete)));
+}
+
+bool RenderPipeline::launch(std::unique_ptr<RenderJob> newJob) {
+    if (isRunning()) return false;
+
+    busy = true;
+    progress = 0.0f;
+    lastRenderCompleted = false;
+
+    job = std::move(newJob);
+    pool.addJob(job.get(), false);
+    return true;
+}
+
+void RenderPipeline::cancel(int timeoutMs) {
+    if (job == nullptr) return;
+
+    pool.removeJob(job.get(), true, timeoutMs);
+
+    if (!isRunning())
+        busy = false;
+}
+
+bool RenderPipeline::waitForCompletion(int timeoutMs) {
+    return job == nullptr || pool.waitForJobToFinish(job.get(), timeoutMs);
+}
+
+bool RenderPipeline::isRunning() const {
+    return job != nullptr && pool.contains(job.get());
+}
+
+bool RenderPipeline::render(const juce::AudioBuffer<float>& source,
+    juce::AudioBuffer<float>& dest,
+    const Settings& settings,
+    const std::function<bool(float)>& progress) {
+
+    return renderRange(source, dest, settings, 0, progress);
+}
+
+bool RenderPipeline::renderToFile(const juce::AudioBuffer<float>& source,
+    const juce::File& destination,
+    const Settings& settings,
+    const ExportOptions& options,
+    const std::function<bool(float)>& progress) {
+
+    auto readChunk = [&source](juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples) {
+        chunk.setSize(source.getNumChannels(), numSamples, false, false, true);
+        for (int ch = 0; ch < source.getNumChannels(); ++ch)
+            chunk.copyFrom(ch, 0, source, ch, static_cast<int>(start), numSamples);
+        return true;
+    };
+
+    return renderChunksToFile(readChunk, source.getNumChannels(), settings.sampleRate,
+        source.getNumSamples(), destination, settings, options, progress);
+}
+
+bool RenderPipeline::renderToFile(StreamingAudioFile& source,
+    const juce::File& destination,
+    const Settings& settings,
+    const ExportOptions& options,
+    const std::function<bool(float)>& progress) {
+
+    auto readChunk = [&source](juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples) {
+        return source.read(chunk, start, numSamples);
+    };
+
+    return renderChunksToFile(readChunk, source.getNumChannels(), source.getSampleRate(),
+        source.getLengthInSamples(), destination, settings, options, progress);
+}
+
+bool RenderPipeline::renderToFile(const EditList& source,
+    const juce::File& destination,
+    const Settings& settings,
+    const ExportOptions& options,
+    const std::function<bool(float)>& progress) {
+
+    // Edits are materialised a chunk at a time on the way to disk
+    auto readChunk = [&source](juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples) {
+        return source.read(chunk, start, numSamples);
+    };
+
+    return renderChunksToFile(readChunk, source.getNumChannels(), settings.sampleRate,
+        source.getLengthInSamples(), destination, settings, options, progress);
+}
+
+bool RenderPipeline::renderChunksToFile(const ChunkReader& readChunk,
+    int numChannels, double sampleRate, juce::int64 numSamples,
+    const juce::File& destination,
+    const Settings& settings,
+    const ExportOptions& options,
+    const std::function<bool(float)>& progress) {
+
+    std::unique_ptr<juce::AudioFormat> format;
+    switch (options.format) {
+    case ExportOptions::Format::Aiff: format = std::make_unique<juce::AiffAudioFormat>(); break;
+    case ExportOptions::Format::Flac: format = std::make_unique<juce::FlacAudioFormat>(); break;
+    default:                          format = std::make_unique<juce::WavAudioFormat>(); break;
+    }
+
+    if (numChannels <= 0 || !format->getPossibleBitDepths().contains(options.bitsPerSample))
+        return false;
+
+    destination.deleteFile();
+
+    const int chunkSamples = juce::jmax(1, settings.blockSize) * exportChunkBlocks;
+    bool completed = false;
+    {
+        auto stream = std::make_unique<juce::FileOutputStream>(destination);
+        if (!stream->openedOk()) return false;
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+            sampleRate, static_cast<unsigned int>(numChannels), options.bitsPerSample, {}, 0));
+
+        if (writer == nullptr) return false;
+        stream.release();   // The writer owns it now
+
+        // Rendering stays on this thread while the writer thread drains the FIFO to disk.
+        // Destroying the ThreadedWriter flushes what is left and closes the file.
+        juce::TimeSliceThread writerThread("Export writer");
+        writerThread.startThread();
+
+        {
+            juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread,
+                chunkSamples * juce::jmax(2, options.fifoChunks));
+
+            juce::AudioBuffer<float> chunk;
+            juce::AudioBuffer<float> rendered;
+            completed = true;
+
+            for (juce::int64 start = 0; start < numSamples && completed; start += chunkSamples) {
+                const int length = static_cast<int>(juce::jmin<juce::int64>(chunkSamples, numSamples - start));
+
+                completed = readChunk(chunk, start, length)
+                    && renderRange(chunk, rendered, settings, start, nullptr);
+
+                // A full FIFO means the disk is behind; wait for it rather than buffering more
+                while (completed && !threadedWriter.write(rendered.getArrayOfReadPointers(), length)) {
+                    if (progress && !progress(static_cast<float>(start) / numSamples)) completed = false;
+                    else juce::Thread::sleep(1);
+                }
+
+                if (completed && progress && !progress(static_cast<float>(start + length) / numSamples))
+                    completed = false;
+            }
+        }
+
+        writerThread.stopThread(1000);
+    }
+
+    if (!completed)
+        destination.deleteFile();
+
+    return completed;
+}
+
+bool RenderPipeline::renderRange(const juce::AudioBuffer<float>& source,
+    juce::AudioBuffer<float>& dest,
+    const Settings& settings,
+    juce::int64 timelineStart,
+    const std::function<bool(float)>& progress) {
+
+    const int numChannels = source.getNumChannels();
+    const int numSamples = source.getNumSamples();
+
+    dest.setSize(numChannels, numSamples, false, false, true);
+    if (numSamples == 0 || numChannels == 0) return true;
+
+    const int blockSize = juce::jmax(1, settings.blockSize);
+    const int numBlocks = (numSamples + blockSize - 1) / blockSize;
+
+    // An empty curve, or panning on mono material, leaves the audio unchanged
+    const bool hasCurve = !settings.curve.empty();
+    const bool panning = settings.mode == Mode::Pan;
+    const bool applyCurve = hasCurve && (!panning || numChannels >= 2);
+
+    BreakpointEnvelope envelope(settings.curve);
+
+    std::atomic<int> blocksDone{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    auto renderBlocks = [&](int firstBlock, int endBlock) {
+        Telemetry::ScopedTimer timer(Telemetry::Category::Render, "Render blocks");
+        timer.setItems(static_cast<juce::int64>(juce::jmin(numSamples, endBlock * blockSize) - firstBlock * blockSize));
+
+        BreakpointEnvelope::Cursor cursor(envelope);
+        cursor.seek((timelineStart + static_cast<juce::int64>(firstBlock) * blockSize) / settings.sampleRate);
+
+        std::vector<float> leftGain(static_cast<size_t>(blockSize));
+        std::vector<float> rightGain(panning ? static_cast<size_t>(blockSize) : 0);
+
+        for (int block = firstBlock; block < endBlock && !cancelled; ++block) {
+            const int start = block * blockSize;
+            const int length = juce::jmin(blockSize, numSamples - start);
+            int firstUnmodifiedChannel = 0;
+
+            if (applyCurve && panning) {
+                for (int i = 0; i < length; ++i) {
+                    float panValue = cursor.getValueAt((timelineStart + start + i) / settings.sampleRate);
+
+                    panValue *= settings.intensity;
+                    panValue = juce::jlimit(-1.0f, 1.0f, panValue);
+
+                    float angle = (panValue + 1.0f) * juce::MathConstants<float>::pi * 0.25f;
+                    leftGain[i] = std::cos(angle);
+                    rightGain[i] = std::sin(angle);
+                }
+
+                juce::FloatVectorOperations::multiply(dest.getWritePointer(0, start),
+                    source.getReadPointer(0, start), leftGain.data(), length);
+                juce::FloatVectorOperations::multiply(dest.getWritePointer(1, start),
+                    source.getReadPointer(1, start), rightGain.data(), length);
+                firstUnmodifiedChannel = 2;
+            }
+            else if (applyCurve) {
+                // One gain vector per block, shared by every channel
+                for (int i = 0; i < length; ++i) {
+                    float envelopeValue = cursor.getValueAt((timelineStart + start + i) / settings.sampleRate);
+                    leftGain[i] = 1.0f + (envelopeValue - 1.0f) * settings.intensity;
+                }
+
+                for (int ch = 0; ch < numChannels; ++ch) {
+                    juce::FloatVectorOperations::multiply(dest.getWritePointer(ch, start),
+                        source.getReadPointer(ch, start), leftGain.data(), length);
+                }
+                firstUnmodifiedChannel = numChannels;
+            }
+
+            for (int ch = firstUnmodifiedChannel; ch < numChannels; ++ch)
+                dest.copyFrom(ch, start, source, ch, start, length);
+
+            int done = ++blocksDone;
+            if (progress && !progress(static_cast<float>(done) / numBlocks))
+                cancelled = true;
+        }
+    };
+
+    ParallelFor::forEachChunk(numBlocks, ParallelFor::chooseChunkSize(numBlocks, 4), renderBlocks);
+
+    return !cancelled;
+}
@@ -0,0 +1,138 @@
+// ============================================================================
+// RenderPipeline.h
+// Applies a breakpoint curve to audio in fixed-size blocks across all cores
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "EditList.h"
+#include "StreamingAudioFile.h"
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+
+class RenderPipeline {
+public:
+    enum class Mode {
+        Gain,   // Curve scales every channel: 1 + (value - 1) * intensity
+        Pan     // Curve is a -1..1 pan position applied to channels 0 and 1
+    };
+
+    struct Settings {
+        Mode mode = Mode::Gain;
+        std::vector<std::pair<double, double>> curve;
+        float intensity = 1.0f;
+        double sampleRate = 44100.0;
+        int blockSize = 4096;
+    };
+
+    struct ExportOptions {
+        enum class Format { Wav, Aiff, Flac };
+
+        Format format = Format::Wav;
+        int bitsPerSample = 24;              // 32 writes floating point WAV
+        int fifoChunks = 4;                  // Rendered chunks the writer thread may fall behind by
+
+        juce::String getFileExtension() const;
+    };
+
+    // Called on the render thread with the finished buffer; never called after a cancel
+    using CompletionCallback = std::function<void(juce::AudioBuffer<float>&& rendered)>;
+
+    // Called on the render thread once the destination file has been fully written and closed
+    using FileCompletionCallback = std::function<void(const juce::File& rendered)>;
+
+    // The busy flag and progress value are written by the pipeline as blocks complete
+    RenderPipeline(std::atomic<bool>& busyFlag, std::atomic<float>& progressValue);
+    ~RenderPipeline();
+
+    // ========================================================================
+    // Background Rendering
+    // ========================================================================
+
+    // Renders off the calling thread; the source must stay alive until the render
+    // finishes or is cancelled. Returns false if a render is already running.
+    bool start(const juce::AudioBuffer<float>& source, Settings settings, CompletionCallback onComplete);
+
+    // Renders block by block straight into an audio file, with disk writes on a
+    // separate writer thread, so only a few blocks are ever held in memory.
+    // A cancelled or failed export deletes the partial file.
+    bool startExport(const juce::AudioBuffer<float>& source, Settings settings,
+        const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete);
+    bool startExport(StreamingAudioFile& source, Settings settings,
+        const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete);
+
+    // Edit lists are copied into the job, which keeps their sources alive; audio
+    // they only reference must still outlive the export
+    bool startExport(const EditList& source, Settings settings,
+        const juce::File& destination, ExportOptions options, FileCompletionCallback onComplete);
+
+    void cancel(int timeoutMs = 5000);
+    bool waitForCompletion(int timeoutMs = -1);
+
+    bool isRunning() const;
+    bool didLastRenderComplete() const { return lastRenderCompleted.load(); }
+
+    // ========================================================================
+    // Direct Rendering
+    // ========================================================================
+
+    // Renders on the calling thread, still spreading blocks across the shared pool.
+    // Returns false if the progress callback asked to stop.
+    static bool render(const juce::AudioBuffer<float>& source,
+        juce::AudioBuffer<float>& dest,
+        const Settings& settings,
+        const std::function<bool(float)>& progress = nullptr);
+
+    static bool renderToFile(const juce::AudioBuffer<float>& source,
+        const juce::File& destination,
+        const Settings& settings,
+        const ExportOptions& options,
+        const std::function<bool(float)>& progress = nullptr);
+    static bool renderToFile(StreamingAudioFile& source,
+        const juce::File& destination,
+        const Settings& settings,
+        const ExportOptions& options,
+        const std::function<bool(float)>& progress = nullptr);
+    static bool renderToFile(const EditList& source,
+        const juce::File& destination,
+        const Settings& settings,
+        const ExportOptions& options,
+        const std::function<bool(float)>& progress = nullptr);
+
+private:
+    class RenderJob;
+    class BufferRenderJob;
+    class FileRenderJob;
+
+    // Blocks rendered per chunk when writing to a file
+    static constexpr int exportChunkBlocks = 16;
+
+    // Fills chunk with [start, start + numSamples) of the source
+    using ChunkReader = std::function<bool(juce::AudioBuffer<float>& chunk, juce::int64 start, int numSamples)>;
+
+    static bool renderChunksToFile(const ChunkReader& readChunk,
+        int numChannels, double sampleRate, juce::int64 numSamples,
+        const juce::File& destination,
+        const Settings& settings,
+        const ExportOptions& options,
+        const std::function<bool(float)>& progress);
+
+    // Renders source as the stretch of the timeline starting at timelineStart
+    static bool renderRange(const juce::AudioBuffer<float>& source,
+        juce::AudioBuffer<float>& dest,
+        const Settings& settings,
+        juce::int64 timelineStart,
+        const std::function<bool(float)>& progress);
+
+    bool launch(std::unique_ptr<RenderJob> newJob);
+
+    std::atomic<bool>& busy;
+    std::atomic<float>& progress;
+    std::atomic<bool> lastRenderCompleted{ false };
+
+    juce::ThreadPool pool{ 1 };
+    std::unique_ptr<RenderJob> job;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderPipeline)
+};
@@ -0,0 +1,443 @@
+// ============================================================================
+// SIMDKernels.cpp
+// ============================================================================
+#include "SIMDKernels.h"
+#include <atomic>
+#include <cmath>
+
+#if JUCE_INTEL && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+ #define SIMDKERNELS_X86 1
+ #include <immintrin.h>
+#else
+ #define SIMDKERNELS_X86 0
+#endif
+
+#if JUCE_ARM && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+ #define SIMDKERNELS_NEON 1
+ #include <arm_neon.h>
+#else
+ #define SIMDKERNELS_NEON 0
+#endif
+
+// AVX2 code is compiled per function so the rest of the binary keeps the baseline ISA;
+// MSVC accepts the intrinsics without a flag
+#if SIMDKERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+ #define SIMDKERNELS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+ #define SIMDKERNELS_TARGET_AVX2
+#endif
+
+namespace {
+
+// ============================================================================
+// Scalar reference
+// ============================================================================
+
+float sumOfSquaresScalar(const float* data, int numSamples) {
+    float sum = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+        sum += data[i] * data[i];
+    return sum;
+}
+
+void sumOfSquaresAndPeakScalar(const float* data, int numSamples, float& sumSquares, float& peak) {
+    float sum = 0.0f;
+    float maxAbs = 0.0f;
+    for (int i = 0; i < numSamples; ++i) {
+        float sample = data[i];
+        sum += sample * sample;
+        maxAbs = std::max(maxAbs, std::abs(sample));
+    }
+    sumSquares = sum;
+    peak = maxAbs;
+}
+
+SIMDKernels::StereoStats stereoStatsScalar(const float* left, const float* right, int numSamples) {
+    SIMDKernels::StereoStats stats;
+    for (int i = 0; i < numSamples; ++i) {
+        float l = left[i];
+        float r = right[i];
+        stats.leftAbsSum += std::abs(l);
+        stats.rightAbsSum += std::abs(r);
+        stats.leftSumSquares += l * l;
+        stats.rightSumSquares += r * r;
+        stats.crossProduct += l * r;
+    }
+    return stats;
+}
+
+float dotProductScalar(const float* a, const float* b, int numSamples) {
+    float sum = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// Vector paths finish the last partial register with the scalar loop
+void addScalarTail(const float* left, const float* right, int numSamples, SIMDKernels::StereoStats& stats) {
+    auto tail = stereoStatsScalar(left, right, numSamples);
+    stats.leftAbsSum += tail.leftAbsSum;
+    stats.rightAbsSum += tail.rightAbsSum;
+    stats.leftSumSquares += tail.leftSumSquares;
+    stats.rightSumSquares += tail.rightSumSquares;
+    stats.crossProduct += tail.crossProduct;
+}
+
+#if SIMDKERNELS_X86
+
+// ============================================================================
+// SSE2
+// ============================================================================
+
+inline float horizontalSum(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+inline float horizontalMax(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 maxes = _mm_max_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, maxes);
+    return _mm_cvtss_f32(_mm_max_ss(maxes, shuffled));
+}
+
+inline __m128 absSSE(__m128 v) {
+    return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+float sumOfSquaresSSE2(const float* data, int numSamples) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m128 a = _mm_loadu_ps(data + i);
+        __m128 b = _mm_loadu_ps(data + i + 4);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(a, a));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(b, b));
+    }
+
+    return horizontalSum(_mm_add_ps(acc0, acc1)) + sumOfSquaresScalar(data + i, numSamples - i);
+}
+
+float dotProductSSE2(const float* a, const float* b, int numSamples) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    return horizontalSum(_mm_add_ps(acc0, acc1)) + dotProductScalar(a + i, b + i, numSamples - i);
+}
+
+void sumOfSquaresAndPeakSSE2(const float* data, int numSamples, float& sumSquares, float& peak) {
+    __m128 acc = _mm_setzero_ps();
+    __m128 maxAbs = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 x = _mm_loadu_ps(data + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(x, x));
+        maxAbs = _mm_max_ps(maxAbs, absSSE(x));
+    }
+
+    float tailSum = 0.0f, tailPeak = 0.0f;
+    sumOfSquaresAndPeakScalar(data + i, numSamples - i, tailSum, tailPeak);
+
+    sumSquares = horizontalSum(acc) + tailSum;
+    peak = std::max(horizontalMax(maxAbs), tailPeak);
+}
+
+SIMDKernels::StereoStats stereoStatsSSE2(const float* left, const float* right, int numSamples) {
+    __m128 leftAbs = _mm_setzero_ps(), rightAbs = _mm_setzero_ps();
+    __m128 leftSq = _mm_setzero_ps(), rightSq = _mm_setzero_ps();
+    __m128 cross = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        leftAbs = _mm_add_ps(leftAbs, absSSE(l));
+        rightAbs = _mm_add_ps(rightAbs, absSSE(r));
+        leftSq = _mm_add_ps(leftSq, _mm_mul_ps(l, l));
+        rightSq = _mm_add_ps(rightSq, _mm_mul_ps(r, r));
+        cross = _mm_add_ps(cross, _mm_mul_ps(l, r));
+    }
+
+    SIMDKernels::StereoStats stats;
+    stats.leftAbsSum = horizontalSum(leftAbs);
+    stats.rightAbsSum = horizontalSum(rightAbs);
+    stats.leftSumSquares = horizontalSum(leftSq);
+    stats.rightSumSquares = horizontalSum(rightSq);
+    stats.crossProduct = horizontalSum(cross);
+
+    addScalarTail(left + i, right + i, numSamples - i, stats);
+    return stats;
+}
+
+// ============================================================================
+// AVX2 + FMA
+// ============================================================================
+
+SIMDKERNELS_TARGET_AVX2 inline float horizontalSum256(__m256 v) {
+    return horizontalSum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+SIMDKERNELS_TARGET_AVX2 inline float horizontalMax256(__m256 v) {
+    return horizontalMax(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+SIMDKERNELS_TARGET_AVX2 inline __m256 absAVX(__m256 v) {
+    return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
+SIMDKERNELS_TARGET_AVX2 float sumOfSquaresAVX2(const float* data, int numSamples) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        __m256 a = _mm256_loadu_ps(data + i);
+        __m256 b = _mm256_loadu_ps(data + i + 8);
+        acc0 = _mm256_fmadd_ps(a, a, acc0);
+        acc1 = _mm256_fmadd_ps(b, b, acc1);
+    }
+
+    return horizontalSum256(_mm256_add_ps(acc0, acc1)) + sumOfSquaresSSE2(data + i, numSamples - i);
+}
+
+SIMDKERNELS_TARGET_AVX2 float dotProductAVX2(const float* a, const float* b, int numSamples) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+
+    return horizontalSum256(_mm256_add_ps(acc0, acc1)) + dotProductSSE2(a + i, b + i, numSamples - i);
+}
+
+SIMDKERNELS_TARGET_AVX2 void sumOfSquaresAndPeakAVX2(const float* data, int numSamples,
+    float& sumSquares, float& peak) {
+
+    __m256 acc = _mm256_setzero_ps();
+    __m256 maxAbs = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256 x = _mm256_loadu_ps(data + i);
+        acc = _mm256_fmadd_ps(x, x, acc);
+        maxAbs = _mm256_max_ps(maxAbs, absAVX(x));
+    }
+
+    float tailSum = 0.0f, tailPeak = 0.0f;
+    sumOfSquaresAndPeakScalar(data + i, numSamples - i, tailSum, tailPeak);
+
+    sumSquares = horizontalSum256(acc) + tailSum;
+    peak = std::max(horizontalMax256(maxAbs), tailPeak);
+}
+
+SIMDKERNELS_TARGET_AVX2 SIMDKernels::StereoStats stereoStatsAVX2(const float* left, const float* right,
+    int numSamples) {
+
+    __m256 leftAbs = _mm256_setzero_ps(), rightAbs = _mm256_setzero_ps();
+    __m256 leftSq = _mm256_setzero_ps(), rightSq = _mm256_setzero_ps();
+    __m256 cross = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        __m256 l = _mm256_loadu_ps(left + i);
+        __m256 r = _mm256_loadu_ps(right + i);
+        leftAbs = _mm256_add_ps(leftAbs, absAVX(l));
+        rightAbs = _mm256_add_ps(rightAbs, absAVX(r));
+        leftSq = _mm256_fmadd_ps(l, l, leftSq);
+        rightSq = _mm256_fmadd_ps(r, r, rightSq);
+        cross = _mm256_fmadd_ps(l, r, cross);
+    }
+
+    SIMDKernels::StereoStats stats;
+    stats.leftAbsSum = horizontalSum256(leftAbs);
+    stats.rightAbsSum = horizontalSum256(rightAbs);
+    stats.leftSumSquares = horizontalSum256(leftSq);
+    stats.rightSumSquares = horizontalSum256(rightSq);
+    stats.crossProduct = horizontalSum256(cross);
+
+    addScalarTail(left + i, right + i, numSamples - i, stats);
+    return stats;
+}
+
+#endif // SIMDKERNELS_X86
+
+#if SIMDKERNELS_NEON
+
+// ============================================================================
+// NEON
+// ============================================================================
+
+inline float horizontalSumNEON(float32x4_t v) {
+    float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+}
+
+inline float horizontalMaxNEON(float32x4_t v) {
+    float32x2_t pair = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpmax_f32(pair, pair), 0);
+}
+
+float sumOfSquaresNEON(const float* data, int numSamples) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        float32x4_t a = vld1q_f32(data + i);
+        float32x4_t b = vld1q_f32(data + i + 4);
+        acc0 = vmlaq_f32(acc0, a, a);
+        acc1 = vmlaq_f32(acc1, b, b);
+    }
+
+    return horizontalSumNEON(vaddq_f32(acc0, acc1)) + sumOfSquaresScalar(data + i, numSamples - i);
+}
+
+float dotProductNEON(const float* a, const float* b, int numSamples) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+
+    return horizontalSumNEON(vaddq_f32(acc0, acc1)) + dotProductScalar(a + i, b + i, numSamples - i);
+}
+
+void sumOfSquaresAndPeakNEON(const float* data, int numSamples, float& sumSquares, float& peak) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    float32x4_t maxAbs = vdupq_n_f32(0.0f);
+
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t x = vld1q_f32(data + i);
+        acc = vmlaq_f32(acc, x, x);
+        maxAbs = vmaxq_f32(maxAbs, vabsq_f32(x));
+    }
+
+    float tailSum = 0.0f, tailPeak = 0.0f;
+    sumOfSquaresAndPeakScalar(data + i, numSamples - i, tailSum, tailPeak);
+
+    sumSquares = horizontalSumNEON(acc) + tailSum;
+    peak = std::max(horizontalMaxNEON(maxAbs), tailPeak);
+}
+
+SIMDKernels::StereoStats stereoStatsNEON(const float* left, const float* right, int numSamples) {
+    float32x4_t leftAbs = vdupq_n_f32(0.0f), rightAbs = vdupq_n_f32(0.0f);
+    float32x4_t leftSq = vdupq_n_f32(0.0f), rightSq = vdupq_n_f32(0.0f);
+    float32x4_t cross = vdupq_n_f32(0.0f);
+
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t l = vld1q_f32(left + i);
+        float32x4_t r = vld1q_f32(right + i);
+        leftAbs = vaddq_f32(leftAbs, vabsq_f32(l));
+        rightAbs = vaddq_f32(rightAbs, vabsq_f32(r));
+        leftSq = vmlaq_f32(leftSq, l, l);
+        rightSq = vmlaq_f32(rightSq, r, r);
+        cross = vmlaq_f32(cross, l, r);
+    }
+
+    SIMDKernels::StereoStats stats;
+    stats.leftAbsSum = horizontalSumNEON(leftAbs);
+    stats.rightAbsSum = horizontalSumNEON(rightAbs);
+    stats.leftSumSquares = horizontalSumNEON(leftSq);
+    stats.rightSumSquares = horizontalSumNEON(rightSq);
+    stats.crossProduct = horizontalSumNEON(cross);
+
+    addScalarTail(left + i, right + i, numSamples - i, stats);
+    return stats;
+}
+
+#endif // SIMDKERNELS_NEON
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+struct KernelTable {
+    SIMDKernels::Backend backend;
+    float (*sumOfSquares)(const float*, int);
+    void (*sumOfSquaresAndPeak)(const float*, int, float&, float&);
+    SIMDKernels::StereoStats (*stereoStats)(const float*, const float*, int);
+    float (*dotProduct)(const float*, const float*, int);
+};
+
+const KernelTable scalarKernels{ SIMDKernels::Backend::Scalar,
+    sumOfSquaresScalar, sumOfSquaresAndPeakScalar, stereoStatsScalar, dotProductScalar };
+
+KernelTable selectKernels() {
+#if SIMDKERNELS_X86
+    if (juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3())
+        return { SIMDKernels::Backend::AVX2, sumOfSquaresAVX2, sumOfSquaresAndPeakAVX2, stereoStatsAVX2,
+            dotProductAVX2 };
+
+    return { SIMDKernels::Backend::SSE2, sumOfSquaresSSE2, sumOfSquaresAndPeakSSE2, stereoStatsSSE2,
+        dotProductSSE2 };
+#elif SIMDKERNELS_NEON
+    return { SIMDKernels::Backend::NEON, sumOfSquaresNEON, sumOfSquaresAndPeakNEON, stereoStatsNEON,
+        dotProductNEON };
+#else
+    return scalarKernels;
+#endif
+}
+
+std::atomic<bool> forceScalar{ false };
+
+const KernelTable& getKernels() {
+    static const KernelTable detected = selectKernels();
+    return forceScalar.load(std::memory_order_relaxed) ? scalarKernels : detected;
+}
+
+} // namespace
+
+float SIMDKernels::sumOfSquares(const float* data, int numSamples) {
+    return numSamples > 0 ? getKernels().sumOfSquares(data, numSamples) : 0.0f;
+}
+
+void SIMDKernels::sumOfSquaresAndPeak(const float* data, int numSamples, float& sumSquares, float& peak) {
+    sumSquares = 0.0f;
+    peak = 0.0f;
+    if (numSamples > 0)
+        getKernels().sumOfSquaresAndPeak(data, numSamples, sumSquares, peak);
+}
+
+SIMDKernels::StereoStats SIMDKernels::stereoStats(const float* left, const float* right, int numSamples) {
+    return numSamples > 0 ? getKernels().stereoStats(left, right, numSamples) : StereoStats();
+}
+
+float SIMDKernels::dotProduct(const float* a, const float* b, int numSamples) {
+    return numSamples > 0 ? getKernels().dotProduct(a, b, numSamples) : 0.0f;
+}
+
+SIMDKernels::Backend SIMDKernels::getActiveBackend() {
+    return getKernels().backend;
+}
+
+juce::String SIMDKernels::getBackendName(Backend backend) {
+    switch (backend) {
+    case Backend::SSE2: return "SSE2";
+    case Backend::AVX2: return "AVX2";
+    case Backend::NEON: return "NEON";
+    default: return "Scalar";
+    }
+}
+
+void SIMDKernels::setForceScalar(bool shouldForceScalar) {
+    forceScalar = shouldForceScalar;
+}
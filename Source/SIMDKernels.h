@@ -0,0 +1,41 @@
+// ============================================================================
+// SIMDKernels.h
+// Vectorized window statistics with runtime CPU dispatch
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+
+class SIMDKernels {
+public:
+    enum class Backend {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    // Per-window sums for the panning extractor, accumulated in one pass over L/R
+    struct StereoStats {
+        float leftAbsSum = 0.0f;
+        float rightAbsSum = 0.0f;
+        float leftSumSquares = 0.0f;
+        float rightSumSquares = 0.0f;
+        float crossProduct = 0.0f;   // Sum of L * R
+    };
+
+    static float sumOfSquares(const float* data, int numSamples);
+
+    // Sum of squares and absolute peak together, for RMS + peak windows
+    static void sumOfSquaresAndPeak(const float* data, int numSamples, float& sumSquares, float& peak);
+
+    static StereoStats stereoStats(const float* left, const float* right, int numSamples);
+
+    // Sum of a[i] * b[i], the inner loop of cross-correlation searches
+    static float dotProduct(const float* a, const float* b, int numSamples);
+
+    // The widest backend this CPU supports is picked on first use. Forcing scalar is
+    // meant for benchmarking and for checking the vector paths against a reference.
+    static Backend getActiveBackend();
+    static juce::String getBackendName(Backend backend);
+    static void setForceScalar(bool shouldForceScalar);
+};
@@ -0,0 +1,188 @@
+// ============================================================================
+// STFTFrameCache.cpp
+// ============================================================================
+#include "STFTFrameCache.h"
+#include "ParallelFor.h"
+#include "ScratchPool.h"
+#include <atomic>
+#include <cmath>
+#include <tuple>
+
+bool STFTFrameCache::Key::operator<(const Key& other) const {
+    return std::tie(data, numSamples, fftSize, hopSamples, frameSamples, window)
+        < std::tie(other.data, other.numSamples, other.fftSize, other.hopSamples, other.frameSamples, other.window);
+}
+
+STFTFrameCache::FramesPtr STFTFrameCache::getFrames(const juce::AudioBuffer<float>& buffer,
+    int channel,
+    const Config& config,
+    bool parallel,
+    const std::function<bool(float)>& progress) {
+
+    if (channel < 0 || channel >= buffer.getNumChannels() || config.fftSize < 2)
+        return nullptr;
+
+    const float* data = buffer.getReadPointer(channel);
+    const int numSamples = buffer.getNumSamples();
+
+    Key key{ data, numSamples, config.fftSize, juce::jmax(1, config.hopSamples),
+        config.getFrameSamples(), config.window };
+
+    std::shared_ptr<Entry> entry;
+    {
+        const juce::ScopedLock sl(entryLock);
+        auto& slot = entries[key];
+        if (slot == nullptr)
+            slot = std::make_shared<Entry>();
+        slot->lastUse = ++useCount;
+        entry = slot;
+    }
+
+    // Held for the whole build so a second extractor waits instead of repeating the FFTs
+    const juce::ScopedLock sl(entry->buildLock);
+
+    if (entry->frames == nullptr) {
+        entry->frames = buildFrames(data, numSamples, config, parallel, progress);
+        if (entry->frames == nullptr) return nullptr;
+
+        const juce::ScopedLock el(entryLock);
+
+        // Cleared or evicted while it was being built
+        auto found = entries.find(key);
+        if (found != entries.end() && found->second == entry) {
+            entry->bytes = entry->frames->magnitudes.size() * sizeof(float);
+            bytesHeld += entry->bytes;
+            evictToFit();
+        }
+    }
+
+    return entry->frames;
+}
+
+void STFTFrameCache::clear() {
+    const juce::ScopedLock sl(entryLock);
+    entries.clear();
+    bytesHeld = 0;
+}
+
+void STFTFrameCache::clear(const juce::AudioBuffer<float>& buffer) {
+    const juce::ScopedLock sl(entryLock);
+
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
+        const float* data = buffer.getReadPointer(channel);
+
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->first.data == data) {
+                bytesHeld -= it->second->bytes;
+                it = entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+}
+
+void STFTFrameCache::setMaxBytes(size_t bytes) {
+    const juce::ScopedLock sl(entryLock);
+    maxBytes = bytes;
+    evictToFit();
+}
+
+size_t STFTFrameCache::getBytesHeld() const {
+    const juce::ScopedLock sl(entryLock);
+    return bytesHeld;
+}
+
+void STFTFrameCache::evictToFit() {
+    while (bytesHeld > maxBytes) {
+        auto oldest = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second->bytes > 0 && (oldest == entries.end() || it->second->lastUse < oldest->second->lastUse))
+                oldest = it;
+        }
+
+        if (oldest == entries.end()) break;
+
+        bytesHeld -= oldest->second->bytes;
+        entries.erase(oldest);
+    }
+}
+
+int STFTFrameCache::getNumEntries() const {
+    const juce::ScopedLock sl(entryLock);
+    return static_cast<int>(entries.size());
+}
+
+STFTFrameCache::FramesPtr STFTFrameCache::buildFrames(const float* data, int numSamples,
+    const Config& config, bool parallel, const std::function<bool(float)>& progress) {
+
+    int order = 0;
+    while ((1 << order) < config.fftSize)
+        ++order;
+
+    const int fftSize = 1 << order;
+    const int frameSamples = juce::jmin(config.getFrameSamples(), fftSize);
+    const int hopSamples = juce::jmax(1, config.hopSamples);
+
+    auto frames = std::make_shared<Frames>();
+    frames->fftSize = fftSize;
+    frames->hopSamples = hopSamples;
+    frames->numBins = fftSize / 2 + 1;
+    frames->numFrames = numSamples >= frameSamples ? (numSamples - frameSamples) / hopSamples + 1 : 0;
+    frames->magnitudes.resize(static_cast<size_t>(frames->numFrames) * frames->numBins);
+
+    // Window is computed once per build rather than per sample per frame
+    auto window = ScratchPool::borrow<float>(static_cast<size_t>(frameSamples));
+    window.fill(1.0f);
+    if (config.window == Window::Hann) {
+        for (int i = 0; i < frameSamples; ++i)
+            window[i] = 0.5f * (1.0f - std::cos(2.0f * juce::MathConstants<float>::pi * i / frameSamples));
+    }
+
+    constexpr int framesPerBlock = 256;
+    std::atomic<int> framesDone{ 0 };
+    std::atomic<bool> cancelled{ false };
+
+    auto processRange = [&](int begin, int end) {
+        // Engines and scratch stay with each worker from one build to the next
+        auto& fft = ScratchPool::getFFT(order);
+        auto fftData = ScratchPool::borrow<float>(static_cast<size_t>(fftSize) * 2);
+
+        for (int block = begin; block < end && !cancelled; block += framesPerBlock) {
+            int blockEnd = std::min(end, block + framesPerBlock);
+            const ScratchPool::FrameLoopScope frameLoop;
+
+            for (int frame = block; frame < blockEnd; ++frame) {
+                const float* frameData = data + frames->getFrameStart(frame);
+
+                for (int i = 0; i < frameSamples; ++i)
+                    fftData[i] = frameData[i] * window[i];
+                std::fill(fftData.begin() + frameSamples, fftData.end(), 0.0f);
+
+                fft.performRealOnlyForwardTransform(fftData.data(), true);
+
+                float* magnitudes = frames->magnitudes.data() + static_cast<size_t>(frame) * frames->numBins;
+                for (int bin = 0; bin < frames->numBins; ++bin) {
+                    float real = fftData[bin * 2];
+                    float imag = fftData[bin * 2 + 1];
+                    magnitudes[bin] = std::sqrt(real * real + imag * imag);
+                }
+            }
+
+            int done = framesDone.fetch_add(blockEnd - block) + (blockEnd - block);
+            if (progress && !progress(static_cast<float>(done) / frames->numFrames))
+                cancelled = true;
+        }
+    };
+
+    if (parallel)
+        ParallelFor::forEachChunk(frames->numFrames, ParallelFor::chooseChunkSize(frames->numFrames, 16), processRange);
+    else
+        processRange(0, frames->numFrames);
+
+    if (cancelled)
+        return nullptr;
+
+    return frames;
+}
@@ -0,0 +1,112 @@
+// ============================================================================
+// STFTFrameCache.h
+// Lazily built magnitude spectra shared by the FFT-based extractors
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include <memory>
+#include <map>
+#include <functional>
+
+class STFTFrameCache {
+public:
+    enum class Window {
+        Hann,
+        Rectangular
+    };
+
+    struct Config {
+        int fftSize = 2048;
+        int hopSamples = 1024;
+        int frameSamples = 0;   // Samples taken per frame before zero-padding; 0 means fftSize
+        Window window = Window::Hann;
+
+        int getFrameSamples() const { return frameSamples > 0 ? juce::jmin(frameSamples, fftSize) : fftSize; }
+    };
+
+    // The frames the spectral and transient extractors both read, so one FFT pass serves both
+    static Config getSharedConfig() { return {}; }
+
+    // One magnitude spectrum (bins 0..fftSize/2 inclusive) per full frame, stored contiguously
+    class Frames {
+    public:
+        int getNumFrames() const { return numFrames; }
+        int getNumBins() const { return numBins; }
+        int getFFTSize() const { return fftSize; }
+        int getHopSamples() const { return hopSamples; }
+        int getFrameStart(int frame) const { return frame * hopSamples; }
+
+        const float* getMagnitudes(int frame) const { return magnitudes.data() + static_cast<size_t>(frame) * numBins; }
+
+    private:
+        friend class STFTFrameCache;
+
+        int numFrames = 0;
+        int numBins = 0;
+        int fftSize = 0;
+        int hopSamples = 1;
+        std::vector<float> magnitudes;
+    };
+
+    using FramesPtr = std::shared_ptr<const Frames>;
+
+    STFTFrameCache() = default;
+
+    // Returns cached frames for this buffer channel and config, computing them on first use.
+    // Concurrent callers asking for the same frames wait for a single build. Returns nullptr
+    // if the progress callback cancels the build; nothing is cached in that case.
+    FramesPtr getFrames(const juce::AudioBuffer<float>& buffer,
+        int channel,
+        const Config& config,
+        bool parallel = false,
+        const std::function<bool(float)>& progress = nullptr);
+
+    // Entries are keyed on the buffer's sample pointer, so call this whenever the
+    // buffer is reloaded or resized, before its samples are freed
+    void clear();
+
+    // Just the entries for this buffer's channels, leaving other buffers' frames cached
+    void clear(const juce::AudioBuffer<float>& buffer);
+    int getNumEntries() const;
+
+    // Once the built frames add up to more than this, the least recently used are
+    // dropped. Callers still holding frames keep them; a later request rebuilds.
+    void setMaxBytes(size_t bytes);
+    size_t getBytesHeld() const;
+
+    static constexpr size_t defaultMaxBytes = size_t(256) << 20;
+
+private:
+    struct Key {
+        const float* data;
+        int numSamples;
+        int fftSize;
+        int hopSamples;
+        int frameSamples;
+        Window window;
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Entry {
+        juce::CriticalSection buildLock;
+        FramesPtr frames;
+        size_t bytes = 0;           // Counted in bytesHeld once built
+        juce::uint64 lastUse = 0;
+    };
+
+    juce::CriticalSection entryLock;
+    std::map<Key, std::shared_ptr<Entry>> entries;
+    size_t bytesHeld = 0;
+    size_t maxBytes = defaultMaxBytes;
+    juce::uint64 useCount = 0;
+
+    // Call with entryLock held
+    void evictToFit();
+
+    static FramesPtr buildFrames(const float* data, int numSamples, const Config& config,
+        bool parallel, const std::function<bool(float)>& progress);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(STFTFrameCache)
+};
@@ -0,0 +1,56 @@
+// ============================================================================
+// ScratchPool.cpp
+// ============================================================================
+#include "ScratchPool.h"
+#include <atomic>
+#include <memory>
+
+namespace {
+    std::atomic<juce::int64> totalBorrows{ 0 };
+    std::atomic<juce::int64> totalAllocations{ 0 };
+
+    constexpr int maxFFTOrder = 24;
+
+    // Constant initialised, so it's safe to read from operator new
+    thread_local int frameLoopDepth = 0;
+}
+
+ScratchPool::AudioBlock::AudioBlock(int numChannels, int numSamples)
+    : samples(borrow<float>(static_cast<size_t>(juce::jmax(0, numChannels)) * static_cast<size_t>(juce::jmax(0, numSamples)))) {
+
+    auto channels = borrow<float*>(static_cast<size_t>(juce::jmax(0, numChannels)));
+    for (int ch = 0; ch < numChannels; ++ch)
+        channels[static_cast<size_t>(ch)] = samples.data() + static_cast<size_t>(ch) * static_cast<size_t>(numSamples);
+
+    // Refers to the borrowed samples rather than allocating its own
+    buffer = juce::AudioBuffer<float>(channels.data(), numChannels, numSamples);
+}
+
+juce::dsp::FFT& ScratchPool::getFFT(int order) {
+    jassert(order >= 0 && order <= maxFFTOrder);
+    thread_local std::unique_ptr<juce::dsp::FFT> engines[maxFFTOrder + 1];
+
+    auto& engine = engines[juce::jlimit(0, maxFFTOrder, order)];
+    if (engine == nullptr) {
+        recordAllocation();
+        engine = std::make_unique<juce::dsp::FFT>(order);
+    }
+
+    return *engine;
+}
+
+ScratchPool::Stats ScratchPool::getStats() {
+    return { totalBorrows.load(), totalAllocations.load() };
+}
+
+ScratchPool::FrameLoopScope::FrameLoopScope() noexcept { ++frameLoopDepth; }
+ScratchPool::FrameLoopScope::~FrameLoopScope() noexcept { --frameLoopDepth; }
+bool ScratchPool::FrameLoopScope::isActive() noexcept { return frameLoopDepth > 0; }
+
+void ScratchPool::recordBorrow() {
+    totalBorrows.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ScratchPool::recordAllocation() {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+}
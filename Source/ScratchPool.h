@@ -0,0 +1,178 @@
+// ============================================================================
+// ScratchPool.h
+// Per-thread reusable scratch buffers and FFT engines for the analysis paths
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Each thread keeps the blocks it has handed out before and hands them out
+// again, best fit first, so once a path has run at its largest size nothing on
+// it touches the heap. Every allocation the pools do make is counted, so the
+// steady state is visible as a count that stops rising.
+class ScratchPool {
+private:
+    template <typename T> struct FreeList;
+
+public:
+    // A block borrowed from the calling thread's pool, given back when it goes
+    // out of scope. Other threads may read and write it, but it must be given
+    // back on the thread that borrowed it. Contents are whatever the last
+    // borrower left.
+    template <typename T>
+    class Block {
+    public:
+        Block() = default;
+        Block(Block&& other) noexcept
+            : storage(std::move(other.storage)), owner(std::exchange(other.owner, nullptr)) {}
+        Block& operator=(Block&& other) noexcept {
+            if (this != &other) {
+                giveBack();
+                storage = std::move(other.storage);
+                owner = std::exchange(other.owner, nullptr);
+            }
+            return *this;
+        }
+        ~Block() { giveBack(); }
+
+        T* data() { return storage.data(); }
+        const T* data() const { return storage.data(); }
+        size_t size() const { return storage.size(); }
+        bool empty() const { return storage.empty(); }
+
+        T& operator[](size_t index) { return storage[index]; }
+        const T& operator[](size_t index) const { return storage[index]; }
+        T* begin() { return storage.data(); }
+        T* end() { return storage.data() + storage.size(); }
+        const T* begin() const { return storage.data(); }
+        const T* end() const { return storage.data() + storage.size(); }
+
+        void fill(const T& value) { std::fill(storage.begin(), storage.end(), value); }
+
+    private:
+        friend class ScratchPool;
+        std::vector<T> storage;
+        FreeList<T>* owner = nullptr;
+
+        void giveBack();
+    };
+
+    // An audio buffer over borrowed samples, for per-chunk work buffers
+    class AudioBlock {
+    public:
+        AudioBlock(int numChannels, int numSamples);
+        juce::AudioBuffer<float>& get() { return buffer; }
+
+    private:
+        Block<float> samples;
+        juce::AudioBuffer<float> buffer;
+    };
+
+    template <typename T>
+    static Block<T> borrow(size_t numItems);
+
+    // The calling thread's engine for this order, built on first use
+    static juce::dsp::FFT& getFFT(int order);
+
+    struct Stats {
+        juce::int64 borrows = 0;
+        juce::int64 heapAllocations = 0;   // New or grown blocks and new FFT engines
+    };
+
+    // Totals over every thread since the process started
+    static Stats getStats();
+
+    // Marks the calling thread as inside a per-frame loop, where everything has
+    // been borrowed or reserved beforehand and nothing should touch the heap.
+    // SourceBatch's HeapCounter counts the allocations made inside one.
+    class FrameLoopScope {
+    public:
+        FrameLoopScope() noexcept;
+        ~FrameLoopScope() noexcept;
+        FrameLoopScope(const FrameLoopScope&) = delete;
+        FrameLoopScope& operator=(const FrameLoopScope&) = delete;
+
+        static bool isActive() noexcept;
+    };
+
+    // What each thread keeps of each type; blocks beyond it are freed on return
+    static constexpr size_t maxBytesPerThread = size_t(64) << 20;
+    static constexpr size_t maxBlocksPerThread = 32;
+
+private:
+    template <typename T>
+    struct FreeList {
+        FreeList() { available.reserve(maxBlocksPerThread); }
+
+        std::vector<std::vector<T>> available;
+        size_t bytesHeld = 0;
+    };
+
+    template <typename T>
+    static FreeList<T>& getLocalList() {
+        thread_local FreeList<T> list;
+        return list;
+    }
+
+    static void recordBorrow();
+    static void recordAllocation();
+};
+
+template <typename T>
+ScratchPool::Block<T> ScratchPool::borrow(size_t numItems) {
+    auto& list = getLocalList<T>();
+    recordBorrow();
+
+    // Smallest block that fits, or else the largest, which grows the least
+    auto& available = list.available;
+    size_t chosen = available.size();
+
+    for (size_t i = 0; i < available.size(); ++i) {
+        if (chosen == available.size()) {
+            chosen = i;
+            continue;
+        }
+
+        const size_t capacity = available[i].capacity();
+        const size_t best = available[chosen].capacity();
+        const bool better = capacity >= numItems ? (best < numItems || capacity < best)
+                                                 : (best < numItems && capacity > best);
+        if (better) chosen = i;
+    }
+
+    Block<T> block;
+    block.owner = &list;
+
+    if (chosen < available.size()) {
+        list.bytesHeld -= available[chosen].capacity() * sizeof(T);
+        std::swap(available[chosen], available.back());
+        block.storage = std::move(available.back());
+        available.pop_back();
+    }
+
+    if (block.storage.capacity() < numItems) {
+        recordAllocation();
+        block.storage.reserve(numItems);
+    }
+
+    block.storage.resize(numItems);
+    return block;
+}
+
+template <typename T>
+void ScratchPool::Block<T>::giveBack() {
+    if (owner == nullptr) return;
+
+    jassert(owner == &getLocalList<T>());   // Given back on a thread that didn't borrow it
+    const size_t bytes = storage.capacity() * sizeof(T);
+
+    if (owner->available.size() < maxBlocksPerThread && owner->bytesHeld + bytes <= maxBytesPerThread) {
+        owner->bytesHeld += bytes;
+        owner->available.push_back(std::move(storage));
+    }
+
+    storage = {};
+    owner = nullptr;
+}
@@ -0,0 +1,99 @@
+// ============================================================================
+// StreamingAudioFile.cpp
+// ============================================================================
+#include "StreamingAudioFile.h"
+#include "Telemetry.h"
+#include <limits>
+
+std::unique_ptr<StreamingAudioFile> StreamingAudioFile::open(const juce::File& file) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+        mappedReader.reset(format->createMemoryMappedReader(file));
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    if (mappedReader == nullptr)
+        reader.reset(formatManager.createReaderFor(file));
+
+    if (mappedReader == nullptr && reader == nullptr)
+        return nullptr;
+
+    return std::unique_ptr<StreamingAudioFile>(
+        new StreamingAudioFile(file, std::move(mappedReader), std::move(reader)));
+}
+
+StreamingAudioFile::StreamingAudioFile(const juce::File& file,
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+    std::unique_ptr<juce::AudioFormatReader> reader)
+    : file(file), mappedReader(std::move(mappedReader)), reader(std::move(reader)) {
+
+    auto& source = getReader();
+    lengthInSamples = source.lengthInSamples;
+    numChannels = static_cast<int>(source.numChannels);
+    sampleRate = source.sampleRate;
+}
+
+juce::AudioFormatReader& StreamingAudioFile::getReader() const {
+    if (mappedReader != nullptr) return *mappedReader;
+    return *reader;
+}
+
+bool StreamingAudioFile::read(juce::AudioBuffer<float>& dest, juce::int64 startSample, int numSamples) {
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Read audio");
+    timer.setItems(numSamples);
+
+    dest.setSize(numChannels, numSamples, false, false, true);
+    dest.clear();
+
+    if (numSamples <= 0) return true;
+
+    juce::int64 available = juce::jlimit<juce::int64>(0, numSamples, lengthInSamples - startSample);
+    if (startSample < 0 || available == 0) return true;
+
+    const juce::ScopedLock sl(readLock);
+
+    if (mappedReader != nullptr) {
+        juce::Range<juce::int64> needed(startSample, startSample + available);
+
+        if (!mappedReader->getMappedSection().contains(needed)) {
+            juce::int64 mapEnd = juce::jmin(lengthInSamples,
+                startSample + juce::jmax(available, mappedWindowSamples));
+
+            if (!mappedReader->mapSectionOfFile({ startSample, mapEnd }))
+                return false;
+        }
+    }
+
+    return getReader().read(&dest, 0, static_cast<int>(available), startSample, true, true);
+}
+
+bool StreamingAudioFile::readAll(juce::AudioBuffer<float>& dest) {
+    if (lengthInSamples > std::numeric_limits<int>::max()) return false;
+
+    if (mappedReader != nullptr) {
+        // A one-off full read doesn't need the whole file mapped at once
+        const int numSamples = static_cast<int>(lengthInSamples);
+        const int blockSize = static_cast<int>(mappedWindowSamples);
+
+        dest.setSize(numChannels, numSamples);
+        juce::AudioBuffer<float> block;
+
+        for (int start = 0; start < numSamples; start += blockSize) {
+            int length = juce::jmin(blockSize, numSamples - start);
+            if (!read(block, start, length)) return false;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                dest.copyFrom(ch, start, block, ch, 0, length);
+        }
+        return true;
+    }
+
+    Telemetry::ScopedTimer timer(Telemetry::Category::FileIO, "Read whole audio file");
+    timer.setItems(lengthInSamples);
+
+    const juce::ScopedLock sl(readLock);
+    dest.setSize(numChannels, static_cast<int>(lengthInSamples));
+    return reader->read(&dest, 0, static_cast<int>(lengthInSamples), 0, true, true);
+}
@@ -0,0 +1,51 @@
+// ============================================================================
+// StreamingAudioFile.h
+// Block access to an audio file without loading it into memory
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+
+class StreamingAudioFile {
+public:
+    // Memory-maps formats that support it (WAV, AIFF) and falls back to a
+    // regular reader otherwise. Returns nullptr if the file can't be read.
+    static std::unique_ptr<StreamingAudioFile> open(const juce::File& file);
+
+    juce::int64 getLengthInSamples() const { return lengthInSamples; }
+    int getNumChannels() const { return numChannels; }
+    double getSampleRate() const { return sampleRate; }
+    const juce::File& getFile() const { return file; }
+    bool isMemoryMapped() const { return mappedReader != nullptr; }
+
+    // Reads [startSample, startSample + numSamples) into dest, resized to the file's
+    // channel count. Anything past the end of the file is zero. Safe to call from
+    // several threads; reads are serialised.
+    bool read(juce::AudioBuffer<float>& dest, juce::int64 startSample, int numSamples);
+
+    // Loads the whole file, provided it fits an int-indexed buffer
+    bool readAll(juce::AudioBuffer<float>& dest);
+
+private:
+    StreamingAudioFile(const juce::File& file,
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+        std::unique_ptr<juce::AudioFormatReader> reader);
+
+    juce::AudioFormatReader& getReader() const;
+
+    // Only a window around the current read position is mapped, so address
+    // space stays bounded on 32-bit hosts and very long files
+    static constexpr juce::int64 mappedWindowSamples = 1 << 22;
+
+    const juce::File file;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    juce::int64 lengthInSamples = 0;
+    int numChannels = 0;
+    double sampleRate = 44100.0;
+
+    juce::CriticalSection readLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamingAudioFile)
+};
@@ -0,0 +1,295 @@
+// ============================================================================
+// Telemetry.cpp
+// ============================================================================
+#include "Telemetry.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+
+namespace {
+    // Fields are atomics so a reader copying a slot the writer is reusing
+    // reads a mix of two events rather than racing; the mix is then dropped
+    struct Slot {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<int> category{ 0 };
+        std::atomic<juce::int64> startTicks{ 0 };
+        std::atomic<juce::int64> endTicks{ 0 };
+        std::atomic<juce::int64> items{ 0 };
+    };
+
+    struct ThreadRing {
+        std::unique_ptr<Slot[]> slots{ new Slot[Telemetry::eventsPerThread] };
+        std::atomic<juce::uint64> claimed{ 0 };   // Slots the writer has started on
+        std::atomic<juce::uint64> written{ 0 };   // Slots the writer has finished
+        juce::String name;
+    };
+
+    struct Totals {
+        std::atomic<juce::int64> count{ 0 };
+        std::atomic<juce::int64> items{ 0 };
+        std::atomic<juce::int64> ticks{ 0 };
+        std::atomic<juce::int64> maxTicks{ 0 };
+    };
+
+    // Never destroyed, so threads still running at shutdown can go on recording
+    struct Registry {
+        juce::CriticalSection lock;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+        std::vector<ThreadRing*> freeRings;   // Left by threads that have exited
+        std::set<juce::String> names;
+        Totals totals[Telemetry::numCategories];
+        std::atomic<juce::int64> resetTicks{ 0 };
+    };
+
+    Registry& getRegistry() {
+        static auto* registry = new Registry();
+        return *registry;
+    }
+
+    // A ring left by an exited thread keeps its events for snapshots until
+    // another thread takes it over, so there are only ever as many rings as
+    // threads that have been recording at once
+    ThreadRing* acquireRing() {
+        juce::String name;
+        if (auto* thread = juce::Thread::getCurrentThread())
+            name = thread->getThreadName();
+        else if (juce::MessageManager::existsAndIsCurrentThread())
+            name = "Message thread";
+
+        auto& registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+        ThreadRing* ring;
+
+        if (!registry.freeRings.empty()) {
+            // Readers hold the lock while they copy, and the old writer has gone
+            ring = registry.freeRings.back();
+            registry.freeRings.pop_back();
+            ring->claimed.store(0);
+            ring->written.store(0);
+        }
+        else {
+            registry.rings.push_back(std::make_unique<ThreadRing>());
+            ring = registry.rings.back().get();
+        }
+
+        ring->name = name.isNotEmpty() ? name : "Thread " + juce::String(static_cast<int>(registry.rings.size() - 1));
+        return ring;
+    }
+
+    // Gives the thread's ring back when the thread exits
+    struct RingOwner {
+        ThreadRing* ring = nullptr;
+
+        ~RingOwner() {
+            if (ring == nullptr) return;
+
+            auto& registry = getRegistry();
+            const juce::ScopedLock sl(registry.lock);
+            registry.freeRings.push_back(ring);
+        }
+    };
+
+    ThreadRing& getLocalRing() {
+        thread_local RingOwner owner;
+
+        if (owner.ring == nullptr)
+            owner.ring = acquireRing();
+
+        return *owner.ring;
+    }
+}
+
+std::atomic<bool> Telemetry::enabled{ true };
+
+const char* Telemetry::getCategoryName(Category category) {
+    switch (category) {
+    case Category::Extraction:   return "Extraction";
+    case Category::Quantization: return "Quantization";
+    case Category::Render:       return "Render";
+    case Category::FileIO:       return "File I/O";
+    case Category::Paint:        return "Paint";
+    }
+
+    return "";
+}
+
+// ============================================================================
+// ScopedTimer
+// ============================================================================
+
+Telemetry::ScopedTimer::ScopedTimer(Category category, const char* name)
+    : name(name), category(category), recording(isEnabled()) {
+    if (recording) startTicks = juce::Time::getHighResolutionTicks();
+}
+
+Telemetry::ScopedTimer::ScopedTimer(Category category, const juce::String& name)
+    : name(nullptr), category(category), recording(isEnabled()) {
+    if (recording) {
+        this->name = intern(name);
+        startTicks = juce::Time::getHighResolutionTicks();
+    }
+}
+
+Telemetry::ScopedTimer::~ScopedTimer() {
+    // Timers started while recording was off stay unrecorded
+    if (recording)
+        record(category, name, startTicks, juce::Time::getHighResolutionTicks(), items);
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+const char* Telemetry::intern(const juce::String& name) {
+    auto& registry = getRegistry();
+    const juce::ScopedLock sl(registry.lock);
+    return registry.names.insert(name).first->toRawUTF8();
+}
+
+void Telemetry::record(Category category, const char* name, juce::int64 startTicks,
+    juce::int64 endTicks, juce::int64 items) {
+
+    auto& ring = getLocalRing();
+    const auto index = ring.written.load(std::memory_order_relaxed);
+    auto& slot = ring.slots[index % eventsPerThread];
+
+    // Claimed before the slot changes, so a reader that sees any of the new event sees the claim
+    ring.claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(static_cast<int>(category), std::memory_order_relaxed);
+    slot.startTicks.store(startTicks, std::memory_order_relaxed);
+    slot.endTicks.store(endTicks, std::memory_order_relaxed);
+    slot.items.store(items, std::memory_order_relaxed);
+    ring.written.store(index + 1, std::memory_order_release);
+
+    auto& totals = getRegistry().totals[static_cast<int>(category)];
+    const juce::int64 ticks = endTicks - startTicks;
+    totals.count.fetch_add(1, std::memory_order_relaxed);
+    totals.items.fetch_add(items, std::memory_order_relaxed);
+    totals.ticks.fetch_add(ticks, std::memory_order_relaxed);
+
+    auto longest = totals.maxTicks.load(std::memory_order_relaxed);
+    while (ticks > longest && !totals.maxTicks.compare_exchange_weak(longest, ticks, std::memory_order_relaxed)) {}
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+Telemetry::Snapshot Telemetry::getSnapshot() {
+    auto& registry = getRegistry();
+    Snapshot snapshot;
+    snapshot.ticksPerSecond = juce::jmax<juce::int64>(1, juce::Time::getHighResolutionTicksPerSecond());
+
+    for (int i = 0; i < numCategories; ++i) {
+        const auto& totals = registry.totals[i];
+        auto& result = snapshot.totals[static_cast<size_t>(i)];
+        result.count = totals.count.load(std::memory_order_relaxed);
+        result.items = totals.items.load(std::memory_order_relaxed);
+        result.totalSeconds = snapshot.toSeconds(totals.ticks.load(std::memory_order_relaxed));
+        result.maxSeconds = snapshot.toSeconds(totals.maxTicks.load(std::memory_order_relaxed));
+    }
+
+    const auto resetTicks = registry.resetTicks.load();
+
+    // Holding the lock keeps the list still and stops rings being handed to new threads mid-copy
+    const juce::ScopedLock sl(registry.lock);
+
+    for (size_t r = 0; r < registry.rings.size(); ++r) {
+        const auto& ring = *registry.rings[r];
+        snapshot.threadNames.push_back(ring.name);
+
+        const auto end = ring.written.load(std::memory_order_acquire);
+        const auto begin = end > eventsPerThread ? end - eventsPerThread : 0;
+        const auto firstEvent = snapshot.events.size();
+
+        for (auto index = begin; index < end; ++index) {
+            const auto& slot = ring.slots[index % eventsPerThread];
+
+            Event event;
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.category = static_cast<Category>(slot.category.load(std::memory_order_relaxed));
+            event.startTicks = slot.startTicks.load(std::memory_order_relaxed);
+            event.endTicks = slot.endTicks.load(std::memory_order_relaxed);
+            event.items = slot.items.load(std::memory_order_relaxed);
+            event.thread = static_cast<int>(r);
+            snapshot.events.push_back(event);
+        }
+
+        // Slots the writer came back round to while they were being copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const auto claimed = ring.claimed.load(std::memory_order_relaxed);
+        const auto overwritten = claimed > eventsPerThread ? claimed - eventsPerThread : 0;
+        const auto keepFrom = firstEvent + static_cast<size_t>(juce::jmin(end, juce::jmax(begin, overwritten)) - begin);
+
+        auto copied = snapshot.events.begin() + static_cast<std::ptrdiff_t>(firstEvent);
+        snapshot.events.erase(copied, snapshot.events.begin() + static_cast<std::ptrdiff_t>(keepFrom));
+    }
+
+    snapshot.events.erase(std::remove_if(snapshot.events.begin(), snapshot.events.end(),
+        [resetTicks](const Event& event) { return event.startTicks < resetTicks; }), snapshot.events.end());
+
+    std::sort(snapshot.events.begin(), snapshot.events.end(),
+        [](const Event& a, const Event& b) { return a.startTicks < b.startTicks; });
+
+    return snapshot;
+}
+
+void Telemetry::reset() {
+    auto& registry = getRegistry();
+    registry.resetTicks.store(juce::Time::getHighResolutionTicks());
+
+    for (auto& totals : registry.totals) {
+        totals.count.store(0);
+        totals.items.store(0);
+        totals.ticks.store(0);
+        totals.maxTicks.store(0);
+    }
+}
+
+juce::var Telemetry::toChromeTrace(const Snapshot& snapshot) {
+    juce::Array<juce::var> traceEvents;
+
+    for (size_t i = 0; i < snapshot.threadNames.size(); ++i) {
+        auto* args = new juce::DynamicObject();
+        args->setProperty("name", snapshot.threadNames[i]);
+
+        auto* metadata = new juce::DynamicObject();
+        metadata->setProperty("name", "thread_name");
+        metadata->setProperty("ph", "M");
+        metadata->setProperty("pid", 1);
+        metadata->setProperty("tid", static_cast<int>(i));
+        metadata->setProperty("args", juce::var(args));
+        traceEvents.add(juce::var(metadata));
+    }
+
+    // Microseconds from the first event, as the format expects
+    const juce::int64 origin = snapshot.events.empty() ? 0 : snapshot.events.front().startTicks;
+
+    for (const auto& event : snapshot.events) {
+        auto* args = new juce::DynamicObject();
+        args->setProperty("items", event.items);
+
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", juce::String(event.name));
+        entry->setProperty("cat", getCategoryName(event.category));
+        entry->setProperty("ph", "X");
+        entry->setProperty("ts", snapshot.toSeconds(event.startTicks - origin) * 1.0e6);
+        entry->setProperty("dur", snapshot.toSeconds(event.endTicks - event.startTicks) * 1.0e6);
+        entry->setProperty("pid", 1);
+        entry->setProperty("tid", event.thread);
+        entry->setProperty("args", juce::var(args));
+        traceEvents.add(juce::var(entry));
+    }
+
+    auto* trace = new juce::DynamicObject();
+    trace->setProperty("traceEvents", traceEvents);
+    trace->setProperty("displayTimeUnit", "ms");
+    return juce::var(trace);
+}
+
+bool Telemetry::writeChromeTrace(const juce::File& file) {
+    return file.replaceWithText(juce::JSON::toString(toChromeTrace(getSnapshot()), true));
+}
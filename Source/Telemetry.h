@@ -0,0 +1,98 @@
+// ============================================================================
+// Telemetry.h
+// Scoped timers over the hot paths, kept in per-thread buffers
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Each thread records its timings into a ring of its own, so recording never
+// locks: the first timer on a thread takes a ring, and every timer after that
+// writes one slot and publishes it. Rings are handed back as their threads
+// exit and reused by later ones. Readers copy the rings from any thread
+// and drop whatever was overwritten while they copied. Totals per category are
+// kept beside the rings and cover everything since the last reset, however
+// much the rings have dropped.
+class Telemetry {
+public:
+    enum class Category {
+        Extraction,
+        Quantization,
+        Render,
+        FileIO,
+        Paint
+    };
+
+    static constexpr int numCategories = 5;
+    static const char* getCategoryName(Category category);
+
+    struct Event {
+        const char* name = nullptr;     // Never freed, so events can outlive their timers
+        Category category = Category::Extraction;
+        juce::int64 startTicks = 0;     // High resolution ticks
+        juce::int64 endTicks = 0;
+        juce::int64 items = 0;          // Samples, points or pixels, as the timer counts them
+        int thread = 0;                 // Index into Snapshot::threadNames
+    };
+
+    struct CategoryTotals {
+        juce::int64 count = 0;
+        juce::int64 items = 0;
+        double totalSeconds = 0.0;
+        double maxSeconds = 0.0;
+    };
+
+    struct Snapshot {
+        std::array<CategoryTotals, numCategories> totals;
+        std::vector<Event> events;              // What the rings still hold, by start time
+        std::vector<juce::String> threadNames;
+        juce::int64 ticksPerSecond = 1;
+
+        double toSeconds(juce::int64 ticks) const { return static_cast<double>(ticks) / static_cast<double>(ticksPerSecond); }
+    };
+
+    // Times the scope it's declared in. The name must outlive the program's
+    // use of the event, as string literals do; names built at run time are
+    // interned, which takes a lock, so keep those off per-block paths.
+    class ScopedTimer {
+    public:
+        ScopedTimer(Category category, const char* name);
+        ScopedTimer(Category category, const juce::String& name);
+        ~ScopedTimer();
+
+        void setItems(juce::int64 count) { items = count; }
+
+    private:
+        const char* name;
+        Category category;
+        bool recording;
+        juce::int64 startTicks = 0;
+        juce::int64 items = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    static void setEnabled(bool shouldRecord) { enabled.store(shouldRecord); }
+    static bool isEnabled() { return enabled.load(); }
+
+    static Snapshot getSnapshot();
+
+    // Later snapshots leave out everything recorded before this
+    static void reset();
+
+    // Chrome's trace event format, which chrome://tracing and Perfetto open
+    static juce::var toChromeTrace(const Snapshot& snapshot);
+    static bool writeChromeTrace(const juce::File& file);
+
+    // Events each thread keeps before overwriting its oldest
+    static constexpr int eventsPerThread = 8192;
+
+private:
+    static std::atomic<bool> enabled;
+
+    static const char* intern(const juce::String& name);
+    static void record(Category category, const char* name, juce::int64 startTicks,
+        juce::int64 endTicks, juce::int64 items);
+};
@@ -0,0 +1,83 @@
+// ============================================================================
+// TelemetryOverlay.cpp
+// ============================================================================
+#include "TelemetryOverlay.h"
+#include <algorithm>
+
+namespace {
+    constexpr int padding = 6;
+
+    juce::String formatSeconds(double seconds) {
+        return seconds >= 1.0 ? juce::String(seconds, 2) + " s"
+                              : juce::String(seconds * 1000.0, 2) + " ms";
+    }
+}
+
+TelemetryOverlay::TelemetryOverlay() {
+    setInterceptsMouseClicks(false, false);
+}
+
+int TelemetryOverlay::getIdealHeight() {
+    // Title, one line per category, then a heading over the slowest events
+    return (Telemetry::numCategories + slowestEventsShown + 2) * lineHeight + padding * 2;
+}
+
+void TelemetryOverlay::visibilityChanged() {
+    if (isVisible()) {
+        refresh();
+        startTimerHz(4);
+    }
+    else {
+        stopTimer();
+    }
+}
+
+void TelemetryOverlay::timerCallback() {
+    refresh();
+}
+
+void TelemetryOverlay::refresh() {
+    auto snapshot = Telemetry::getSnapshot();
+    lines.clear();
+    lines.add(Telemetry::isEnabled() ? "Telemetry" : "Telemetry (paused)");
+
+    for (int i = 0; i < Telemetry::numCategories; ++i) {
+        const auto& totals = snapshot.totals[static_cast<size_t>(i)];
+        if (totals.count == 0) continue;
+
+        lines.add(juce::String(Telemetry::getCategoryName(static_cast<Telemetry::Category>(i)))
+            + ": " + juce::String(totals.count) + " x, avg "
+            + formatSeconds(totals.totalSeconds / static_cast<double>(totals.count))
+            + ", max " + formatSeconds(totals.maxSeconds));
+    }
+
+    auto slowest = std::move(snapshot.events);
+    const auto numShown = std::min(slowest.size(), static_cast<size_t>(slowestEventsShown));
+    std::partial_sort(slowest.begin(), slowest.begin() + static_cast<std::ptrdiff_t>(numShown), slowest.end(),
+        [](const Telemetry::Event& a, const Telemetry::Event& b) {
+            return a.endTicks - a.startTicks > b.endTicks - b.startTicks;
+        });
+    slowest.resize(numShown);
+
+    if (!slowest.empty()) {
+        lines.add("Slowest recent:");
+        for (const auto& event : slowest)
+            lines.add("  " + juce::String(event.name) + " "
+                + formatSeconds(snapshot.toSeconds(event.endTicks - event.startTicks)));
+    }
+
+    repaint();
+}
+
+void TelemetryOverlay::paint(juce::Graphics& g) {
+    g.setColour(juce::Colours::black.withAlpha(0.75f));
+    g.fillRoundedRectangle(getLocalBounds().toFloat(), 4.0f);
+
+    g.setFont(juce::FontOptions(12.0f));
+    auto area = getLocalBounds().reduced(padding);
+
+    for (int i = 0; i < lines.size(); ++i) {
+        g.setColour(i == 0 ? juce::Colours::white : juce::Colours::lightgrey);
+        g.drawText(lines[i], area.removeFromTop(lineHeight), juce::Justification::centredLeft, true);
+    }
+}
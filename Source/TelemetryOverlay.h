@@ -0,0 +1,33 @@
+// ============================================================================
+// TelemetryOverlay.h
+// A small readout of the telemetry totals over the editor
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "Telemetry.h"
+
+// Polls the telemetry a few times a second while it's visible and lists the
+// totals per category, then the slowest events the rings still hold. Clicks
+// pass through to whatever is underneath.
+class TelemetryOverlay : public juce::Component,
+    private juce::Timer {
+public:
+    TelemetryOverlay();
+
+    void paint(juce::Graphics& g) override;
+    void visibilityChanged() override;
+
+    // Fits the most lines the overlay can show, so it doesn't change size as they come and go
+    static int getIdealHeight();
+
+    static constexpr int slowestEventsShown = 3;
+    static constexpr int lineHeight = 15;
+
+private:
+    juce::StringArray lines;
+
+    void timerCallback() override;
+    void refresh();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TelemetryOverlay)
+};
@@ -0,0 +1,193 @@
+// ============================================================================
+// TimeStretcher.cpp
+// ============================================================================
+#include "TimeStretcher.h"
+#include "ParallelFor.h"
+#include "SIMDKernels.h"
+#include <cmath>
+#include <limits>
+
+TimeStretcher::TimeStretcher(double sampleRate) {
+    setSampleRate(sampleRate);
+}
+
+void TimeStretcher::setSampleRate(double sampleRate) {
+    frameSize = juce::jlimit(256, 8192, juce::nextPowerOfTwo(static_cast<int>(sampleRate * 0.02)));
+    hopSize = frameSize / 2;
+    searchRadius = frameSize / 4;
+
+    // Periodic Hann, which sums to exactly one at half-frame hops
+    window.resize(static_cast<size_t>(frameSize));
+    for (int i = 0; i < frameSize; ++i)
+        window[static_cast<size_t>(i)] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * i / frameSize);
+}
+
+bool TimeStretcher::stretch(const juce::AudioBuffer<float>& input, double stretchFactor,
+    juce::AudioBuffer<float>& output) {
+
+    if (stretchFactor <= 0.0) return false;
+
+    const double inputLength = input.getNumSamples();
+    return warp(input, { { 0.0, 0.0 }, { inputLength, inputLength * stretchFactor } }, output);
+}
+
+bool TimeStretcher::warp(const juce::AudioBuffer<float>& input, const std::vector<Anchor>& anchors,
+    juce::AudioBuffer<float>& output) {
+
+    if (anchors.size() < 2) return false;
+
+    for (size_t i = 1; i < anchors.size(); ++i) {
+        if (anchors[i].inputSample < anchors[i - 1].inputSample
+            || anchors[i].outputSample <= anchors[i - 1].outputSample)
+            return false;
+    }
+
+    const double outputEnd = std::floor(anchors.back().outputSample + 0.5);
+    if (outputEnd > std::numeric_limits<int>::max()) return false;
+
+    const int outputLength = juce::jmax(0, static_cast<int>(outputEnd));
+    output.setSize(input.getNumChannels(), outputLength);
+    output.clear();
+
+    if (outputLength == 0 || input.getNumSamples() == 0) return true;
+
+    // Frame k is centred on output sample k * hopSize; one extra frame covers the tail
+    const int numFrames = outputLength / hopSize + 2;
+
+    buildGuide(input);
+    findFramePositions(anchors, input.getNumSamples(), numFrames);
+    overlapAdd(input, output, numFrames);
+    return true;
+}
+
+void TimeStretcher::buildGuide(const juce::AudioBuffer<float>& input) {
+    const int numSamples = input.getNumSamples();
+    const int numChannels = input.getNumChannels();
+    const int padding = getGuidePadding();
+
+    guide.assign(static_cast<size_t>(numSamples + 2 * padding), 0.0f);
+    float* mix = guide.data() + padding;
+
+    // Aligning on the mix keeps every channel on the same frame positions,
+    // so stereo images don't drift apart
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::addWithMultiply(mix, input.getReadPointer(ch), 1.0f / numChannels, numSamples);
+}
+
+void TimeStretcher::findFramePositions(const std::vector<Anchor>& anchors, juce::int64 inputLength, int numFrames) {
+    framePositions.resize(static_cast<size_t>(numFrames));
+
+    auto nominalCentre = [&](int frame, size_t& segment) {
+        double position = mapToInput(anchors, static_cast<double>(frame) * hopSize, segment);
+        return juce::jlimit<juce::int64>(0, inputLength, static_cast<juce::int64>(std::floor(position + 0.5)));
+    };
+
+    const int framesPerChunk = juce::jmax(minFramesPerChunk,
+        ParallelFor::chooseChunkSize(numFrames, minFramesPerChunk));
+
+    ParallelFor::forEachChunk(numFrames, framesPerChunk, [&](int begin, int end) {
+        size_t segment = 0;
+
+        // The frame before the chunk is taken to sit at its nominal position
+        juce::int64 previous = begin > 0 ? nominalCentre(begin - 1, segment) : 0;
+
+        for (int frame = begin; frame < end; ++frame) {
+            juce::int64 nominal = nominalCentre(frame, segment);
+
+            // Each frame starts where the previous one's audio naturally carries on,
+            // as near its nominal position as the waveform allows
+            juce::int64 centre = frame == 0 ? nominal : nominal + findBestOffset(nominal, previous + hopSize);
+
+            framePositions[static_cast<size_t>(frame)] = centre;
+            previous = centre;
+        }
+    });
+}
+
+int TimeStretcher::findBestOffset(juce::int64 nominalCentre, juce::int64 templateCentre) const {
+    const int half = frameSize / 2;
+    const float* base = guide.data() + getGuidePadding();
+
+    // The template may run past the padded input near the end
+    const juce::int64 lastCentre = static_cast<juce::int64>(guide.size()) - getGuidePadding() - half;
+    templateCentre = juce::jmin(templateCentre, lastCentre);
+
+    const float* target = base + (templateCentre - half);
+
+    auto similarity = [&](int offset) {
+        return SIMDKernels::dotProduct(base + (nominalCentre + offset - half), target, frameSize);
+    };
+
+    // A coarse pass over the search range, then the best neighbourhood sample by sample.
+    // Ties keep the nominal position, so silence doesn't wander.
+    constexpr int coarseStep = 4;
+    int bestOffset = 0;
+    float bestScore = similarity(0);
+
+    for (int offset = -searchRadius; offset <= searchRadius; offset += coarseStep) {
+        float score = similarity(offset);
+        if (score > bestScore) {
+            bestScore = score;
+            bestOffset = offset;
+        }
+    }
+
+    const int coarseBest = bestOffset;
+    for (int offset = juce::jmax(-searchRadius, coarseBest - coarseStep + 1);
+        offset <= juce::jmin(searchRadius, coarseBest + coarseStep - 1); ++offset) {
+
+        float score = similarity(offset);
+        if (score > bestScore) {
+            bestScore = score;
+            bestOffset = offset;
+        }
+    }
+
+    return bestOffset;
+}
+
+void TimeStretcher::overlapAdd(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+    int numFrames) const {
+
+    const int half = frameSize / 2;
+    const int inputLength = input.getNumSamples();
+    const int outputLength = output.getNumSamples();
+
+    ParallelFor::forEachChunk(input.getNumChannels(), 1, [&](int begin, int end) {
+        for (int ch = begin; ch < end; ++ch) {
+            const float* source = input.getReadPointer(ch);
+            float* dest = output.getWritePointer(ch);
+
+            for (int frame = 0; frame < numFrames; ++frame) {
+                const juce::int64 outputStart = static_cast<juce::int64>(frame) * hopSize - half;
+                const juce::int64 inputStart = framePositions[static_cast<size_t>(frame)] - half;
+
+                // Clip the frame to the samples that exist on both sides
+                const juce::int64 first = juce::jmax<juce::int64>(0, -outputStart, -inputStart);
+                const juce::int64 last = juce::jmin<juce::int64>(frameSize,
+                    outputLength - outputStart, inputLength - inputStart);
+
+                if (first >= last) continue;
+
+                juce::FloatVectorOperations::addWithMultiply(dest + (outputStart + first),
+                    source + (inputStart + first), window.data() + first, static_cast<int>(last - first));
+            }
+        }
+    });
+}
+
+double TimeStretcher::mapToInput(const std::vector<Anchor>& anchors, double outputSample, size_t& segment) {
+    while (segment + 2 < anchors.size() && anchors[segment + 1].outputSample <= outputSample)
+        ++segment;
+
+    const auto& from = anchors[segment];
+    const auto& to = anchors[segment + 1];
+
+    if (outputSample <= from.outputSample) return from.inputSample;
+
+    // Only the last segment is left behind, and past it the input carries on at the original speed
+    if (outputSample >= to.outputSample) return to.inputSample + (outputSample - to.outputSample);
+
+    double ratio = (outputSample - from.outputSample) / (to.outputSample - from.outputSample);
+    return from.inputSample + ratio * (to.inputSample - from.inputSample);
+}
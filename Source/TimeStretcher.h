@@ -0,0 +1,58 @@
+// ============================================================================
+// TimeStretcher.h
+// WSOLA time-stretching that keeps pitch, with piecewise warp maps
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+class TimeStretcher {
+public:
+    // Pins an input position to an output position, both in samples
+    struct Anchor {
+        double inputSample = 0.0;
+        double outputSample = 0.0;
+    };
+
+    explicit TimeStretcher(double sampleRate = 44100.0);
+
+    // Frames are about 20ms long whatever the rate
+    void setSampleRate(double sampleRate);
+    int getFrameSize() const { return frameSize; }
+
+    // Output is stretchFactor times as long as the input, at the same pitch
+    bool stretch(const juce::AudioBuffer<float>& input, double stretchFactor,
+        juce::AudioBuffer<float>& output);
+
+    // Stretches each span between consecutive anchors by its own factor. Input
+    // and output positions must both increase; the output ends at the last
+    // anchor's output position.
+    bool warp(const juce::AudioBuffer<float>& input, const std::vector<Anchor>& anchors,
+        juce::AudioBuffer<float>& output);
+
+private:
+    // Frames overlap by half, so the Hann windows sum to one without normalising
+    int frameSize = 1024;
+    int hopSize = 512;
+    int searchRadius = 256;
+    std::vector<float> window;
+
+    // Scratch kept between calls; a stretcher is meant to be used from one thread at a time
+    std::vector<float> guide;              // Channel mix the alignment search runs on, zero padded
+    std::vector<juce::int64> framePositions;   // Input centre chosen for each output frame
+
+    // Each chunk of frames searches on its own, seeded at the nominal position,
+    // so long inputs spread across cores
+    static constexpr int minFramesPerChunk = 64;
+
+    int getGuidePadding() const { return frameSize + searchRadius; }
+
+    void buildGuide(const juce::AudioBuffer<float>& input);
+    void findFramePositions(const std::vector<Anchor>& anchors, juce::int64 inputLength, int numFrames);
+    int findBestOffset(juce::int64 nominalCentre, juce::int64 templateCentre) const;
+    void overlapAdd(const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output, int numFrames) const;
+
+    static double mapToInput(const std::vector<Anchor>& anchors, double outputSample, size_t& segment);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeStretcher)
+};
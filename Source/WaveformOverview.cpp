@@ -0,0 +1,256 @@
+// ============================================================================
+// WaveformOverview.cpp
+// ============================================================================
+#include "WaveformOverview.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+void WaveformOverview::build(const juce::AudioBuffer<float>& buffer) {
+    beginBuild(buffer.getNumSamples());
+    addBlock(buffer, 0, buffer.getNumSamples());
+    buildUpperLevels();
+}
+
+bool WaveformOverview::build(StreamingAudioFile& file) {
+    return buildFromBlocks(file.getLengthInSamples(),
+        [&file](juce::AudioBuffer<float>& block, juce::int64 start, int numSamples) {
+            return file.read(block, start, numSamples);
+        });
+}
+
+bool WaveformOverview::build(const EditList& edits) {
+    // Reading straight from the slices means edits never need materialising for display
+    return buildFromBlocks(edits.getLengthInSamples(),
+        [&edits](juce::AudioBuffer<float>& block, juce::int64 start, int numSamples) {
+            return edits.read(block, start, numSamples);
+        });
+}
+
+bool WaveformOverview::build(const EditList& edits, const SourceOverviews& getSourceOverview) {
+    std::vector<const WaveformOverview*> sourceOverviews;
+    sourceOverviews.reserve(edits.getNumSlices());
+
+    for (const auto& slice : edits.getSlices()) {
+        const auto* overview = slice.source != nullptr ? getSourceOverview(*slice.source) : nullptr;
+        if (overview == nullptr || overview->isEmpty()) return false;
+        sourceOverviews.push_back(overview);
+    }
+
+    beginBuild(edits.getLengthInSamples());
+    auto& base = levels[0];
+    const juce::int64 samplesPerPeak = base.samplesPerPeak;
+    const juce::int64 numPeaks = static_cast<juce::int64>(base.minValues.size());
+
+    // Peaks no slice reaches stay silent
+    std::vector<bool> covered(base.minValues.size(), false);
+
+    for (size_t i = 0; i < edits.getNumSlices(); ++i) {
+        const auto& slice = edits.getSlices()[i];
+        const juce::int64 firstPeak = juce::jmax<juce::int64>(0, slice.position / samplesPerPeak);
+        const juce::int64 endPeak = juce::jmin(numPeaks, (slice.getEnd() + samplesPerPeak - 1) / samplesPerPeak);
+
+        for (juce::int64 peak = firstPeak; peak < endPeak; ++peak) {
+            const juce::int64 from = juce::jmax(peak * samplesPerPeak, slice.position);
+            const juce::int64 to = juce::jmin((peak + 1) * samplesPerPeak, slice.getEnd());
+            if (from >= to) continue;
+
+            float low = 0.0f, high = 0.0f;
+            sourceOverviews[i]->getRange(from - slice.position + slice.sourceStart,
+                to - slice.position + slice.sourceStart, low, high);
+
+            low *= slice.gain;
+            high *= slice.gain;
+            if (slice.gain < 0.0f) std::swap(low, high);
+
+            const auto index = static_cast<size_t>(peak);
+            base.minValues[index] = covered[index] ? juce::jmin(base.minValues[index], low) : low;
+            base.maxValues[index] = covered[index] ? juce::jmax(base.maxValues[index], high) : high;
+            covered[index] = true;
+        }
+    }
+
+    buildUpperLevels();
+    return true;
+}
+
+bool WaveformOverview::buildFromBlocks(juce::int64 totalSamples, const BlockReader& readBlock) {
+    beginBuild(totalSamples);
+
+    // Blocks are whole peaks long so none straddles a read
+    const juce::int64 samplesPerPeak = levels[0].samplesPerPeak;
+    const int blockSamples = static_cast<int>(samplesPerPeak * juce::jmax<juce::int64>(1, (1 << 18) / samplesPerPeak));
+    juce::AudioBuffer<float> block;
+
+    for (juce::int64 start = 0; start < numSamples; start += blockSamples) {
+        int length = static_cast<int>(juce::jmin<juce::int64>(blockSamples, numSamples - start));
+
+        if (!readBlock(block, start, length)) {
+            clear();
+            return false;
+        }
+
+        addBlock(block, start, length);
+    }
+
+    buildUpperLevels();
+    return true;
+}
+
+void WaveformOverview::clear() {
+    levels.clear();
+    numSamples = 0;
+    version = getNextVersion();
+}
+
+int WaveformOverview::getNextVersion() {
+    static std::atomic<int> nextVersion{ 0 };
+    return ++nextVersion;
+}
+
+void WaveformOverview::beginBuild(juce::int64 totalSamples) {
+    levels.clear();
+    numSamples = totalSamples;
+    version = getNextVersion();
+
+    Level base;
+    base.samplesPerPeak = minSamplesPerPeak;
+    while ((numSamples + base.samplesPerPeak - 1) / base.samplesPerPeak > maxBasePeaks)
+        base.samplesPerPeak *= 2;
+
+    size_t numPeaks = static_cast<size_t>((numSamples + base.samplesPerPeak - 1) / base.samplesPerPeak);
+    base.minValues.assign(numPeaks, 0.0f);
+    base.maxValues.assign(numPeaks, 0.0f);
+    levels.push_back(std::move(base));
+}
+
+void WaveformOverview::addBlock(const juce::AudioBuffer<float>& block, juce::int64 blockStart, int blockSamples) {
+    auto& base = levels[0];
+    const int samplesPerPeak = static_cast<int>(base.samplesPerPeak);
+    const size_t firstPeak = static_cast<size_t>(blockStart / samplesPerPeak);
+
+    for (int start = 0; start < blockSamples; start += samplesPerPeak) {
+        int length = juce::jmin(samplesPerPeak, blockSamples - start);
+        size_t peak = firstPeak + static_cast<size_t>(start / samplesPerPeak);
+
+        float low = 0.0f;
+        float high = 0.0f;
+        for (int ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto range = juce::FloatVectorOperations::findMinAndMax(block.getReadPointer(ch, start), length);
+            low = ch == 0 ? range.getStart() : juce::jmin(low, range.getStart());
+            high = ch == 0 ? range.getEnd() : juce::jmax(high, range.getEnd());
+        }
+
+        base.minValues[peak] = low;
+        base.maxValues[peak] = high;
+    }
+}
+
+void WaveformOverview::buildUpperLevels() {
+    // Each level halves the one below until a single peak covers the file
+    while (levels.back().minValues.size() > 1) {
+        const Level& below = levels.back();
+        const size_t count = (below.minValues.size() + 1) / 2;
+
+        Level level;
+        level.samplesPerPeak = below.samplesPerPeak * 2;
+        level.minValues.resize(count);
+        level.maxValues.resize(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            size_t a = i * 2;
+            size_t b = juce::jmin(a + 1, below.minValues.size() - 1);
+            level.minValues[i] = juce::jmin(below.minValues[a], below.minValues[b]);
+            level.maxValues[i] = juce::jmax(below.maxValues[a], below.maxValues[b]);
+        }
+
+        levels.push_back(std::move(level));
+    }
+}
+
+void WaveformOverview::getPeaks(juce::int64 startSample, juce::int64 endSample, int numPixels,
+    float* minValues, float* maxValues) const {
+
+    std::fill(minValues, minValues + numPixels, 0.0f);
+    std::fill(maxValues, maxValues + numPixels, 0.0f);
+
+    if (levels.empty() || numPixels <= 0 || endSample <= startSample) return;
+
+    const double samplesPerPixel = static_cast<double>(endSample - startSample) / numPixels;
+
+    // Coarsest level whose peaks are no wider than a pixel, so each column reads one or two
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < levels.size() && levels[levelIndex + 1].samplesPerPeak <= samplesPerPixel)
+        ++levelIndex;
+
+    const Level& level = levels[levelIndex];
+    const juce::int64 numPeaks = static_cast<juce::int64>(level.minValues.size());
+
+    for (int pixel = 0; pixel < numPixels; ++pixel) {
+        juce::int64 from = startSample + static_cast<juce::int64>(pixel * samplesPerPixel);
+        juce::int64 to = startSample + static_cast<juce::int64>((pixel + 1) * samplesPerPixel);
+
+        if (from >= numSamples || from < 0) continue;
+
+        juce::int64 firstPeak = from / level.samplesPerPeak;
+        juce::int64 endPeak = juce::jlimit(firstPeak + 1, numPeaks, (to + level.samplesPerPeak - 1) / level.samplesPerPeak);
+
+        float low = level.minValues[static_cast<size_t>(firstPeak)];
+        float high = level.maxValues[static_cast<size_t>(firstPeak)];
+
+        for (juce::int64 peak = firstPeak + 1; peak < endPeak; ++peak) {
+            low = juce::jmin(low, level.minValues[static_cast<size_t>(peak)]);
+            high = juce::jmax(high, level.maxValues[static_cast<size_t>(peak)]);
+        }
+
+        minValues[pixel] = low;
+        maxValues[pixel] = high;
+    }
+}
+
+void WaveformOverview::getRange(juce::int64 start, juce::int64 end, float& low, float& high) const {
+    low = high = 0.0f;
+    start = juce::jmax<juce::int64>(0, start);
+    end = juce::jmin(numSamples, end);
+    if (levels.empty() || start >= end) return;
+
+    // Coarsest level with peaks no wider than the range, so it spans a few peaks at most
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < levels.size() && levels[levelIndex + 1].samplesPerPeak <= end - start)
+        ++levelIndex;
+
+    const Level& level = levels[levelIndex];
+    const juce::int64 firstPeak = start / level.samplesPerPeak;
+    const juce::int64 endPeak = juce::jlimit(firstPeak + 1, static_cast<juce::int64>(level.minValues.size()),
+        (end + level.samplesPerPeak - 1) / level.samplesPerPeak);
+
+    low = level.minValues[static_cast<size_t>(firstPeak)];
+    high = level.maxValues[static_cast<size_t>(firstPeak)];
+
+    for (juce::int64 peak = firstPeak + 1; peak < endPeak; ++peak) {
+        low = juce::jmin(low, level.minValues[static_cast<size_t>(peak)]);
+        high = juce::jmax(high, level.maxValues[static_cast<size_t>(peak)]);
+    }
+}
+
+void WaveformOverview::draw(juce::Graphics& g, const juce::Rectangle<int>& area,
+    juce::int64 startSample, juce::int64 endSample) const {
+
+    const int width = area.getWidth();
+    if (width <= 0 || isEmpty()) return;
+
+    std::vector<float> minValues(static_cast<size_t>(width));
+    std::vector<float> maxValues(static_cast<size_t>(width));
+    getPeaks(startSample, endSample, width, minValues.data(), maxValues.data());
+
+    const float centreY = static_cast<float>(area.getCentreY());
+    const float scale = area.getHeight() * 0.45f;
+
+    for (int x = 0; x < width; ++x) {
+        float top = centreY - maxValues[static_cast<size_t>(x)] * scale;
+        float bottom = centreY - minValues[static_cast<size_t>(x)] * scale;
+
+        // Silence still shows as a one-pixel centre line
+        g.fillRect(static_cast<float>(area.getX() + x), top, 1.0f, juce::jmax(1.0f, bottom - top));
+    }
+}
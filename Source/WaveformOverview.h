@@ -0,0 +1,73 @@
+// ============================================================================
+// WaveformOverview.h
+// Min/max peak pyramid for drawing waveforms at any zoom in O(width)
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "EditList.h"
+#include "StreamingAudioFile.h"
+#include <functional>
+#include <vector>
+
+class WaveformOverview {
+public:
+    // Peaks are taken across all channels, so the overview shows the loudest of them
+    void build(const juce::AudioBuffer<float>& buffer);
+    bool build(StreamingAudioFile& file);
+    bool build(const EditList& edits);
+
+    // Looks up the overview already built for one of a list's sources; nullptr if there isn't one
+    using SourceOverviews = std::function<const WaveformOverview*(const EditList::Source& source)>;
+
+    // Builds from the sources' overviews slice by slice, so no audio is read and
+    // the cost follows the overview's size, not the audio's. Peaks at slice edges
+    // take in up to a source peak of the neighbouring audio, and where merged
+    // slices overlap the louder one shows rather than their mix. False, leaving
+    // the overview as it was, if a source has no overview.
+    bool build(const EditList& edits, const SourceOverviews& getSourceOverview);
+    void clear();
+
+    bool isEmpty() const { return levels.empty(); }
+    juce::int64 getNumSamples() const { return numSamples; }
+
+    // Changes on every build or clear, and differs between overviews, so cached
+    // drawings know when they are stale even if they switch overview
+    int getVersion() const { return version; }
+
+    // Fills one min/max pair per pixel column spanning [startSample, endSample),
+    // reading from the coarsest level that still resolves a column
+    void getPeaks(juce::int64 startSample, juce::int64 endSample, int numPixels,
+        float* minValues, float* maxValues) const;
+
+    // Draws [startSample, endSample) into area as one vertical bar per pixel column
+    void draw(juce::Graphics& g, const juce::Rectangle<int>& area,
+        juce::int64 startSample, juce::int64 endSample) const;
+
+private:
+    struct Level {
+        juce::int64 samplesPerPeak = 1;
+        std::vector<float> minValues;
+        std::vector<float> maxValues;
+    };
+
+    // Level 0 is capped at maxBasePeaks so very long files stay cheap to hold
+    static constexpr juce::int64 minSamplesPerPeak = 32;
+    static constexpr juce::int64 maxBasePeaks = 1 << 20;
+
+    std::vector<Level> levels;
+    juce::int64 numSamples = 0;
+    int version = 0;
+
+    // Fills block with [start, start + numSamples) of whatever is being built from
+    using BlockReader = std::function<bool(juce::AudioBuffer<float>& block, juce::int64 start, int numSamples)>;
+
+    bool buildFromBlocks(juce::int64 totalSamples, const BlockReader& readBlock);
+    void beginBuild(juce::int64 totalSamples);
+    void addBlock(const juce::AudioBuffer<float>& block, juce::int64 blockStart, int blockSamples);
+    void buildUpperLevels();
+
+    // Lowest and highest peak over [start, end), read from the coarsest level that fits
+    void getRange(juce::int64 start, juce::int64 end, float& low, float& high) const;
+
+    static int getNextVersion();
+};
@@ -0,0 +1,136 @@
+// ============================================================================
+// BatchRunner.cpp
+// ============================================================================
+#include "BatchRunner.h"
+#include "HeapCounter.h"
+#include <atomic>
+#include <iostream>
+
+BatchRunner::BatchRunner(Options options)
+    : options(std::move(options)) {
+}
+
+juce::Array<juce::File> BatchRunner::findInputFiles() const {
+    juce::Array<juce::File> files;
+
+    if (options.input.existsAsFile()) {
+        files.add(options.input);
+        return files;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    for (const auto& entry : juce::RangedDirectoryIterator(options.input, options.recursive,
+        formatManager.getWildcardForAllFormats(), juce::File::findFiles | juce::File::ignoreHiddenFiles))
+        files.add(entry.getFile());
+
+    // Directory order varies between file systems; sorted keeps logs comparable across runs
+    files.sort();
+    return files;
+}
+
+std::vector<BatchRunner::FileResult> BatchRunner::run() {
+    const auto files = findInputFiles();
+    std::vector<FileResult> results(static_cast<size_t>(files.size()));
+    if (files.isEmpty()) return results;
+
+    // Each file gets its own processor, so files share nothing but the worker pools,
+    // which live as long as the process; the analysis workers keep their scratch
+    // from one file to the next
+    juce::ThreadPool pool(juce::jlimit(1, files.size(), options.concurrentFiles));
+    std::atomic<int> remaining{ files.size() };
+    juce::WaitableEvent finished;
+
+    for (int i = 0; i < files.size(); ++i) {
+        pool.addJob([this, &files, &results, &remaining, &finished, i] {
+            results[static_cast<size_t>(i)] = processFile(files[i]);
+            if (--remaining == 0) finished.signal();
+        });
+    }
+
+    finished.wait();
+    return results;
+}
+
+BatchRunner::FileResult BatchRunner::processFile(const juce::File& file) {
+    FileResult result;
+    result.file = file;
+
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+
+    auto finish = [&](bool succeeded, const juce::String& message) {
+        result.succeeded = succeeded;
+        result.message = message;
+        result.seconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+        log((succeeded ? "done   " : "FAILED ") + file.getFullPathName() + ": " + message
+            + " (" + juce::String(result.seconds, 1) + "s, "
+            + juce::String(result.frameLoopAllocations) + " allocations in frame loops)");
+        return result;
+    };
+
+    log("start  " + file.getFullPathName());
+
+    AudioWorkshopProcessor processor;
+    processor.setStreamingThreshold(options.streamingThreshold);
+
+    if (!processor.loadSourceAudio(file))
+        return finish(false, "couldn't read the file");
+
+    const auto allocationsBefore = HeapCounter::get().frameLoopAllocations;
+
+    if (options.features.isEmpty()) {
+        processor.extractAllFeatures();
+    }
+    else {
+        for (const auto& feature : options.features)
+            processor.extractFeatureAsync(feature);
+    }
+
+    processor.waitForAnalysis();
+    result.frameLoopAllocations = HeapCounter::get().frameLoopAllocations - allocationsBefore;
+
+    const auto extracted = processor.getExtractedFeatures();
+    if (extracted.isEmpty())
+        return finish(false, "no features extracted");
+
+    const auto outputDirectory = getOutputDirectory(file);
+    if (!outputDirectory.createDirectory())
+        return finish(false, "couldn't create " + outputDirectory.getFullPathName());
+
+    processor.saveAllBreakpoints(outputDirectory, options.binaryBreakpoints);
+
+    juce::String summary = juce::String(extracted.size()) + " features";
+
+    if (options.render) {
+        // Rendered straight to disk through the breakpoints, never held as a whole buffer
+        if (!processor.loadTargetAudio(file))
+            return finish(false, "couldn't reload the file as the target");
+
+        const auto destination = outputDirectory.getChildFile(file.getFileNameWithoutExtension()
+            + "_processed" + options.exportOptions.getFileExtension());
+
+        if (!processor.exportProcessedAudioAsync(destination, options.exportOptions))
+            return finish(false, "couldn't start rendering");
+
+        processor.waitForProcessing();
+        if (!processor.didProcessingComplete())
+            return finish(false, "rendering failed");
+
+        summary << ", rendered " << destination.getFileName();
+    }
+
+    return finish(true, summary);
+}
+
+juce::File BatchRunner::getOutputDirectory(const juce::File& file) const {
+    if (options.input.existsAsFile()) return options.output;
+
+    // Files from different subfolders may share names, so their outputs keep the layout
+    return options.output.getChildFile(file.getParentDirectory().getRelativePathFrom(options.input));
+}
+
+void BatchRunner::log(const juce::String& message) {
+    const juce::ScopedLock sl(logLock);
+    std::cout << message << std::endl;
+}
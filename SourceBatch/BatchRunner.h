@@ -0,0 +1,58 @@
+// ============================================================================
+// BatchRunner.h
+// Headless analysis and rendering of whole folders, several files at a time
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <vector>
+
+class BatchRunner {
+public:
+    struct Options {
+        juce::File input;                      // A file, or a folder of audio files
+        juce::File output;                     // Mirrors the input folder's layout
+        bool recursive = false;
+
+        int concurrentFiles = 2;
+        juce::StringArray features;            // Empty extracts every feature
+        bool binaryBreakpoints = false;
+
+        // Renders each file through its first extracted feature, as the editor's apply does
+        bool render = false;
+        RenderPipeline::ExportOptions exportOptions;
+
+        // Files with more samples per channel than this are streamed, so each
+        // file in flight holds a few chunks rather than all of its audio
+        juce::int64 streamingThreshold = juce::int64(1) << 22;
+    };
+
+    struct FileResult {
+        juce::File file;
+        bool succeeded = false;
+        juce::String message;
+        double seconds = 0.0;
+
+        // Heap allocations made in the per-frame analysis loops while the file
+        // was analysed, counted by HeapCounter; zero once the loops are right.
+        // Files analysed at the same time share the count.
+        juce::int64 frameLoopAllocations = 0;
+    };
+
+    explicit BatchRunner(Options options);
+
+    juce::Array<juce::File> findInputFiles() const;
+
+    // Blocks until every file is done; results are in input order
+    std::vector<FileResult> run();
+
+private:
+    Options options;
+    juce::CriticalSection logLock;
+
+    FileResult processFile(const juce::File& file);
+    juce::File getOutputDirectory(const juce::File& file) const;
+    void log(const juce::String& message);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BatchRunner)
+};
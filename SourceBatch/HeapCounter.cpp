@@ -0,0 +1,93 @@
+// ============================================================================
+// HeapCounter.cpp
+// ============================================================================
+#include "HeapCounter.h"
+#include "ScratchPool.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Plain atomics, constant initialised, so they're usable before main
+    std::atomic<juce::int64> allocations{ 0 };
+    std::atomic<juce::int64> bytes{ 0 };
+    std::atomic<juce::int64> frameLoopAllocations{ 0 };
+
+    void count(std::size_t size) noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(static_cast<juce::int64>(size), std::memory_order_relaxed);
+        if (ScratchPool::FrameLoopScope::isActive())
+            frameLoopAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* allocate(std::size_t size) noexcept {
+        count(size);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept {
+        count(size);
+
+        const auto align = juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment));
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+       #else
+        void* memory = nullptr;
+        return posix_memalign(&memory, align, size == 0 ? 1 : size) == 0 ? memory : nullptr;
+       #endif
+    }
+
+    void releaseAligned(void* memory) noexcept {
+       #if JUCE_WINDOWS
+        _aligned_free(memory);
+       #else
+        std::free(memory);
+       #endif
+    }
+
+    void* allocateOrThrow(std::size_t size) {
+        if (auto* memory = allocate(size)) return memory;
+        throw std::bad_alloc();
+    }
+
+    void* allocateAlignedOrThrow(std::size_t size, std::align_val_t alignment) {
+        if (auto* memory = allocateAligned(size, alignment)) return memory;
+        throw std::bad_alloc();
+    }
+}
+
+HeapCounter::Counts HeapCounter::get() {
+    Counts counts;
+    counts.allocations = allocations.load(std::memory_order_relaxed);
+    counts.bytes = bytes.load(std::memory_order_relaxed);
+    counts.frameLoopAllocations = frameLoopAllocations.load(std::memory_order_relaxed);
+    return counts;
+}
+
+// ============================================================================
+// Replacements
+// ============================================================================
+
+void* operator new(std::size_t size) { return allocateOrThrow(size); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { releaseAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { releaseAligned(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { releaseAligned(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { releaseAligned(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(memory); }
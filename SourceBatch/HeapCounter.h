@@ -0,0 +1,24 @@
+// ============================================================================
+// HeapCounter.h
+// Counts every operator new the batch process makes
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+
+// HeapCounter.cpp replaces the global operator new and delete, so anything
+// allocated through them on any thread is counted: vectors, strings, buffers
+// sized through std containers, jobs and threads alike. JUCE's HeapBlock, and
+// with it AudioBuffer's samples, goes through malloc and isn't counted.
+// Allocations made inside a ScratchPool::FrameLoopScope are also counted on
+// their own: the per-frame analysis loops, which should never make any.
+class HeapCounter {
+public:
+    struct Counts {
+        juce::int64 allocations = 0;
+        juce::int64 bytes = 0;
+        juce::int64 frameLoopAllocations = 0;
+    };
+
+    // Totals over every thread since the process started
+    static Counts get();
+};
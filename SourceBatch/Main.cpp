@@ -0,0 +1,140 @@
+// ============================================================================
+// Audio Workshop Batch - Main.cpp
+// Console front end: analyse and render folders of audio without the editor
+// ============================================================================
+#include <JuceHeader.h>
+#include "BatchRunner.h"
+#include "HeapCounter.h"
+#include "ScratchPool.h"
+#include "Telemetry.h"
+#include <iostream>
+
+namespace {
+    const char* const usage =
+        "AudioWorkshopBatch <input file or folder> <output folder> [options]\n"
+        "\n"
+        "  --jobs=N              Files processed at once (default 2)\n"
+        "  --recursive           Include subfolders\n"
+        "  --features=A,B        Features to extract (default all)\n"
+        "  --binary              Save breakpoints in the binary format\n"
+        "  --render              Also render each file through its breakpoints\n"
+        "  --format=F            wav16, wav24, wav32, aiff16, aiff24, flac16 or flac24 (default wav24)\n"
+        "  --stream-above=N      Stream files longer than N samples per channel (default 4194304)\n"
+        "  --trace=FILE          Write a Chrome trace of where the time went\n";
+
+    bool parseExportFormat(const juce::String& name, RenderPipeline::ExportOptions& options) {
+        using Format = RenderPipeline::ExportOptions::Format;
+
+        const auto lower = name.toLowerCase();
+        if (lower.startsWith("wav")) options.format = Format::Wav;
+        else if (lower.startsWith("aiff")) options.format = Format::Aiff;
+        else if (lower.startsWith("flac")) options.format = Format::Flac;
+        else return false;
+
+        const int bits = lower.retainCharacters("0123456789").getIntValue();
+        if (bits != 16 && bits != 24 && bits != 32) return false;
+        if (bits == 32 && options.format != Format::Wav) return false;
+
+        options.bitsPerSample = bits;
+        return true;
+    }
+
+    void runBatch(const juce::ArgumentList& args) {
+        // Options take their values with '=', so any other argument is positional
+        juce::Array<juce::File> positional;
+        for (const auto& argument : args.arguments) {
+            if (!argument.isOption())
+                positional.add(argument.resolveAsFile());
+        }
+
+        if (positional.size() != 2)
+            juce::ConsoleApplication::fail(usage);
+
+        BatchRunner::Options options;
+        options.input = positional[0];
+        options.output = positional[1];
+        options.recursive = args.containsOption("--recursive");
+        options.binaryBreakpoints = args.containsOption("--binary");
+        options.render = args.containsOption("--render");
+
+        if (!options.input.exists())
+            juce::ConsoleApplication::fail("No such file or folder: " + options.input.getFullPathName());
+
+        if (args.containsOption("--jobs")) {
+            options.concurrentFiles = args.getValueForOption("--jobs").getIntValue();
+            if (options.concurrentFiles < 1)
+                juce::ConsoleApplication::fail("--jobs needs a positive number");
+        }
+
+        if (args.containsOption("--stream-above")) {
+            options.streamingThreshold = args.getValueForOption("--stream-above").getLargeIntValue();
+            if (options.streamingThreshold < 1)
+                juce::ConsoleApplication::fail("--stream-above needs a positive number of samples");
+        }
+
+        if (args.containsOption("--format")
+            && !parseExportFormat(args.getValueForOption("--format"), options.exportOptions))
+            juce::ConsoleApplication::fail("Unknown format: " + args.getValueForOption("--format"));
+
+        if (args.containsOption("--features")) {
+            const auto available = FeatureExtractorFactory::getAvailableFeatures();
+            options.features.addTokens(args.getValueForOption("--features"), ",", "");
+            options.features.trim();
+            options.features.removeEmptyStrings();
+
+            for (const auto& feature : options.features) {
+                if (!available.contains(feature))
+                    juce::ConsoleApplication::fail("Unknown feature: " + feature
+                        + " (available: " + available.joinIntoString(", ") + ")");
+            }
+        }
+
+        BatchRunner runner(std::move(options));
+        const auto results = runner.run();
+
+        int failures = 0;
+        double totalSeconds = 0.0;
+        for (const auto& result : results) {
+            if (!result.succeeded) ++failures;
+            totalSeconds += result.seconds;
+        }
+
+        const auto scratch = ScratchPool::getStats();
+        const auto heap = HeapCounter::get();
+        std::cout << results.size() << " files, " << failures << " failed, "
+            << juce::String(totalSeconds, 1) << "s of processing, "
+            << heap.allocations << " heap allocations in all, "
+            << heap.frameLoopAllocations << " in frame loops, "
+            << scratch.heapAllocations << " of " << scratch.borrows << " scratch borrows allocated" << std::endl;
+
+        // The frame loops draw everything from scratch borrowed beforehand
+        if (heap.frameLoopAllocations != 0)
+            std::cout << "Warning: the frame loops allocated; they should never touch the heap" << std::endl;
+
+        if (args.containsOption("--trace")) {
+            const auto traceFile = juce::File::getCurrentWorkingDirectory()
+                .getChildFile(args.getValueForOption("--trace"));
+            if (!Telemetry::writeChromeTrace(traceFile))
+                std::cout << "Couldn't write the trace to " << traceFile.getFullPathName() << std::endl;
+        }
+
+        if (results.empty())
+            juce::ConsoleApplication::fail("No audio files found");
+
+        if (failures > 0)
+            juce::ConsoleApplication::fail(juce::String(failures) + " files failed");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // The processor's parameters expect a message manager even without an editor
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addVersionCommand("--version", "AudioWorkshopBatch 1.0");
+    app.addDefaultCommand({ "", "<input> <output> [options]", "Analyse and render audio files",
+        usage, runBatch });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,317 @@
+// ============================================================================
+// BenchmarkSuite.cpp
+// ============================================================================
+#include "BenchmarkSuite.h"
+#include "AudioTimeLattice.h"
+#include "BreakpointFile.h"
+#include "FeatureExtractors.h"
+#include "RenderPipeline.h"
+#include "ScratchPool.h"
+#include <algorithm>
+#include <iostream>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment(lib, "psapi.lib")
+#else
+ #include <sys/resource.h>
+#endif
+
+namespace {
+    // Keeps the optimiser from dropping work whose result is never read
+    volatile double benchmarkSink = 0.0;
+
+    void consume(const std::vector<std::pair<double, double>>& points) {
+        if (!points.empty()) benchmarkSink = benchmarkSink + points.back().first;
+    }
+
+    juce::String describe(const BenchmarkSuite::Configuration& configuration) {
+        return juce::String(configuration.sampleRate / 1000.0, 1) + "kHz "
+            + juce::String(configuration.numChannels) + "ch "
+            + juce::String(configuration.durationSeconds, 0) + "s";
+    }
+
+    juce::var makeArray(const std::vector<juce::var>& values) {
+        juce::Array<juce::var> array;
+        for (const auto& value : values)
+            array.add(value);
+        return array;
+    }
+}
+
+BenchmarkSuite::BenchmarkSuite(Options options)
+    : options(std::move(options)) {
+}
+
+std::vector<BenchmarkSuite::Result> BenchmarkSuite::run() {
+    results.clear();
+
+    for (const double duration : options.durations) {
+        for (const double sampleRate : options.sampleRates) {
+            for (size_t i = 0; i < options.channelCounts.size(); ++i) {
+                Configuration configuration{ sampleRate, options.channelCounts[i], duration };
+
+                // Curves and files only depend on the duration, so they're timed once per rate
+                runConfiguration(configuration, i == 0);
+            }
+        }
+    }
+
+    return results;
+}
+
+void BenchmarkSuite::runConfiguration(const Configuration& configuration, bool includeChannelIndependent) {
+    const auto audio = makeTestSignal(configuration);
+    const double duration = configuration.durationSeconds;
+
+    // ========================================================================
+    // Feature extraction
+    // ========================================================================
+
+    for (const auto& feature : FeatureExtractorFactory::getAvailableFeatures()) {
+        auto extractor = FeatureExtractorFactory::createExtractor(feature);
+        if (extractor == nullptr) continue;
+
+        // Without a shared frame cache each run computes its own spectra, as a first extraction does
+        extractor->settings.parallelExtraction = options.parallelExtraction;
+
+        measure("extract", feature, configuration, [&] {
+            const auto outputs = extractor->extract(audio, configuration.sampleRate, 0);
+            for (const auto& points : outputs)
+                consume(points);
+        });
+    }
+
+    // ========================================================================
+    // Time lattice
+    // ========================================================================
+
+    AudioTimeLattice lattice(960, configuration.sampleRate);
+    lattice.setTempo(120.0);
+
+    const auto curve = makeTestCurve(duration, false);
+
+    if (includeChannelIndependent) {
+        measure("lattice", "quantizeBreakpoints", configuration, [&] {
+            consume(lattice.quantizeBreakpoints(curve, ValueResolution::Bit14, true));
+        });
+
+        measure("lattice", "generatePPQNGrid", configuration, [&] {
+            const auto grid = lattice.generatePPQNGrid(0.0, duration);
+            if (!grid.empty()) benchmarkSink = benchmarkSink + grid.back();
+        });
+    }
+
+    measure("lattice", "timeStretch", configuration, [&] {
+        const auto stretched = lattice.timeStretch(audio, 1.25);
+        benchmarkSink = benchmarkSink + stretched.getNumSamples();
+    });
+
+    // ========================================================================
+    // Rendering, as applyBreakpointsToTarget does for a target held in memory
+    // ========================================================================
+
+    juce::AudioBuffer<float> rendered(audio.getNumChannels(), audio.getNumSamples());
+
+    RenderPipeline::Settings gain;
+    gain.mode = RenderPipeline::Mode::Gain;
+    gain.curve = curve;
+    gain.sampleRate = configuration.sampleRate;
+
+    measure("render", "gain", configuration, [&] {
+        RenderPipeline::render(audio, rendered, gain);
+    });
+
+    if (configuration.numChannels >= 2) {
+        RenderPipeline::Settings pan = gain;
+        pan.mode = RenderPipeline::Mode::Pan;
+        pan.curve = makeTestCurve(duration, true);
+
+        measure("render", "pan", configuration, [&] {
+            RenderPipeline::render(audio, rendered, pan);
+        });
+    }
+
+    // ========================================================================
+    // Breakpoint files
+    // ========================================================================
+
+    if (!includeChannelIndependent) return;
+
+    BreakpointFile::Contents contents;
+    contents.featureName = "Amplitude";
+    contents.sourceName = "benchmark";
+    contents.sampleRate = configuration.sampleRate;
+    contents.outputs.push_back({ "Amplitude", curve });
+
+    const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+        .getNonexistentChildFile("AudioWorkshopBenchmark", BreakpointFile::fileExtension, false);
+
+    const std::pair<const char*, BreakpointFile::Encoding> encodings[] = {
+        { "plain", BreakpointFile::Encoding::Plain },
+        { "delta", BreakpointFile::Encoding::DeltaTimes }
+    };
+
+    for (const auto& [encodingName, encoding] : encodings) {
+        measure("file", juce::String("save ") + encodingName, configuration, [&] {
+            BreakpointFile::write(file, contents, encoding);
+        });
+
+        measure("file", juce::String("load ") + encodingName, configuration, [&] {
+            BreakpointFile::Contents loaded;
+            if (BreakpointFile::read(file, loaded) && !loaded.outputs.empty())
+                consume(loaded.outputs.front().points);
+        });
+    }
+
+    file.deleteFile();
+}
+
+void BenchmarkSuite::measure(const juce::String& group, const juce::String& name,
+    const Configuration& configuration, const std::function<void()>& work) {
+
+    const auto fullName = group + "/" + name;
+    if (options.filter.isNotEmpty() && !fullName.containsIgnoreCase(options.filter)) return;
+
+    // The first run fills the scratch pools and FFT engines; only later runs are timed
+    work();
+
+    const auto allocationsBefore = ScratchPool::getStats().heapAllocations;
+    std::vector<double> seconds;
+
+    for (int i = 0; i < juce::jmax(1, options.repeats); ++i) {
+        const double start = juce::Time::getMillisecondCounterHiRes();
+        work();
+        seconds.push_back((juce::Time::getMillisecondCounterHiRes() - start) * 0.001);
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+
+    Result result;
+    result.group = group;
+    result.name = name;
+    result.configuration = configuration;
+    result.bestSeconds = seconds.front();
+    result.medianSeconds = seconds[seconds.size() / 2];
+    result.realTimeFactor = result.medianSeconds > 0.0 ? configuration.durationSeconds / result.medianSeconds : 0.0;
+    result.peakResidentBytes = getPeakResidentBytes();
+    result.scratchAllocations = ScratchPool::getStats().heapAllocations - allocationsBefore;
+
+    std::cerr << fullName << " [" << describe(configuration) << "]: "
+        << juce::String(result.medianSeconds * 1000.0, 2) << "ms, "
+        << juce::String(result.realTimeFactor, 1) << "x real time" << std::endl;
+
+    results.push_back(result);
+}
+
+juce::var BenchmarkSuite::toJson(const std::vector<Result>& results, const Options& options) {
+    std::vector<juce::var> entries;
+
+    for (const auto& result : results) {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("group", result.group);
+        entry->setProperty("name", result.name);
+        entry->setProperty("sampleRate", result.configuration.sampleRate);
+        entry->setProperty("channels", result.configuration.numChannels);
+        entry->setProperty("durationSeconds", result.configuration.durationSeconds);
+        entry->setProperty("bestSeconds", result.bestSeconds);
+        entry->setProperty("medianSeconds", result.medianSeconds);
+        entry->setProperty("realTimeFactor", result.realTimeFactor);
+        entry->setProperty("peakResidentBytes", result.peakResidentBytes);
+        entry->setProperty("scratchAllocations", result.scratchAllocations);
+        entries.push_back(juce::var(entry));
+    }
+
+    const auto scratch = ScratchPool::getStats();
+    auto* pool = new juce::DynamicObject();
+    pool->setProperty("borrows", scratch.borrows);
+    pool->setProperty("heapAllocations", scratch.heapAllocations);
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("suite", "AudioWorkshopBenchmark");
+    report->setProperty("formatVersion", 1);
+    report->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("cores", juce::SystemStats::getNumCpus());
+    report->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    report->setProperty("repeats", options.repeats);
+    report->setProperty("parallelExtraction", options.parallelExtraction);
+    report->setProperty("peakResidentBytes", getPeakResidentBytes());
+    report->setProperty("scratchPool", juce::var(pool));
+    report->setProperty("results", makeArray(entries));
+
+    return juce::var(report);
+}
+
+juce::int64 BenchmarkSuite::getPeakResidentBytes() {
+   #if JUCE_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<juce::int64>(counters.PeakWorkingSetSize);
+    return 0;
+   #else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    // Bytes on macOS, kilobytes elsewhere
+   #if JUCE_MAC
+    return static_cast<juce::int64>(usage.ru_maxrss);
+   #else
+    return static_cast<juce::int64>(usage.ru_maxrss) * 1024;
+   #endif
+   #endif
+}
+
+juce::AudioBuffer<float> BenchmarkSuite::makeTestSignal(const Configuration& configuration) {
+    const int numSamples = static_cast<int>(configuration.sampleRate * configuration.durationSeconds);
+    juce::AudioBuffer<float> buffer(configuration.numChannels, numSamples);
+
+    const double twoPi = juce::MathConstants<double>::twoPi;
+    const double frequencies[] = { 220.0, 277.18, 329.63 };
+    const int clickSpacing = static_cast<int>(configuration.sampleRate * 0.5);
+    const double clickDecay = std::exp(-1.0 / (0.01 * configuration.sampleRate));
+
+    // Seeded, so every run analyses the same audio
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < configuration.numChannels; ++ch) {
+        auto* samples = buffer.getWritePointer(ch);
+        const double pan = configuration.numChannels > 1 ? static_cast<double>(ch) / (configuration.numChannels - 1) : 0.5;
+        double click = 0.0;
+
+        for (int i = 0; i < numSamples; ++i) {
+            const double t = i / configuration.sampleRate;
+            const double vibrato = 1.0 + 0.01 * std::sin(twoPi * 5.0 * t);
+
+            double tone = 0.0;
+            for (const double frequency : frequencies)
+                tone += std::sin(twoPi * frequency * vibrato * t);
+
+            if (i % clickSpacing == 0) click = 1.0;
+            click *= clickDecay;
+
+            // The chord drifts across the channels so panning has something to follow
+            const double drift = 0.5 + 0.5 * std::sin(twoPi * 0.1 * t + pan * juce::MathConstants<double>::pi);
+            samples[i] = static_cast<float>(0.2 * tone * drift + 0.5 * click
+                + 0.01 * (random.nextFloat() * 2.0f - 1.0f));
+        }
+    }
+
+    return buffer;
+}
+
+std::vector<std::pair<double, double>> BenchmarkSuite::makeTestCurve(double durationSeconds, bool bipolar) {
+    const auto numPoints = static_cast<size_t>(durationSeconds * 1000.0) + 1;
+    std::vector<std::pair<double, double>> points;
+    points.reserve(numPoints);
+
+    for (size_t i = 0; i < numPoints; ++i) {
+        const double t = static_cast<double>(i) * 0.001;
+        const double shape = std::sin(juce::MathConstants<double>::twoPi * 0.5 * t)
+            * (0.75 + 0.25 * std::sin(juce::MathConstants<double>::twoPi * 3.0 * t));
+        points.emplace_back(t, bipolar ? shape : 0.5 + 0.5 * shape);
+    }
+
+    return points;
+}
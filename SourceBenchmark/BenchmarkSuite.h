@@ -0,0 +1,72 @@
+// ============================================================================
+// BenchmarkSuite.h
+// Timings of the analysis, lattice, render and breakpoint file paths
+// ============================================================================
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+
+// Every case runs over generated audio at each configuration: once to warm up
+// the scratch pools and caches, then the given number of times, timed. Speed
+// is reported as multiples of real time, measured against the audio's duration.
+class BenchmarkSuite {
+public:
+    struct Configuration {
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+        double durationSeconds = 10.0;
+    };
+
+    struct Options {
+        std::vector<double> sampleRates{ 44100.0, 48000.0, 96000.0 };
+        std::vector<int> channelCounts{ 1, 2 };
+        std::vector<double> durations{ 10.0, 60.0 };
+
+        int repeats = 3;
+        juce::String filter;               // Only cases whose name contains this, if given
+        bool parallelExtraction = true;    // As the processor extracts
+    };
+
+    struct Result {
+        juce::String group;                // extract, lattice, render or file
+        juce::String name;
+        Configuration configuration;
+
+        double bestSeconds = 0.0;
+        double medianSeconds = 0.0;
+        double realTimeFactor = 0.0;       // Audio seconds per second of work, from the median
+
+        // The process's high-water mark once the case has run. It never falls,
+        // so a case only shows its own peak if it is the largest so far.
+        juce::int64 peakResidentBytes = 0;
+        juce::int64 scratchAllocations = 0;   // Over the timed runs only
+    };
+
+    explicit BenchmarkSuite(Options options);
+
+    // Prints a line per case to stderr as it finishes, so stdout stays free for the report
+    std::vector<Result> run();
+
+    static juce::var toJson(const std::vector<Result>& results, const Options& options);
+
+    // Largest resident set the process has had, or 0 where the platform can't say
+    static juce::int64 getPeakResidentBytes();
+
+private:
+    Options options;
+    std::vector<Result> results;
+
+    void runConfiguration(const Configuration& configuration, bool includeChannelIndependent);
+    void measure(const juce::String& group, const juce::String& name,
+        const Configuration& configuration, const std::function<void()>& work);
+
+    // A chord with vibrato over decaying clicks and a little noise, so every
+    // extractor has pitch, onsets and movement to find
+    static juce::AudioBuffer<float> makeTestSignal(const Configuration& configuration);
+
+    // One point per millisecond, as an unsimplified extraction gives
+    static std::vector<std::pair<double, double>> makeTestCurve(double durationSeconds, bool bipolar);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BenchmarkSuite)
+};
@@ -0,0 +1,94 @@
+// ============================================================================
+// Audio Workshop Benchmark - Main.cpp
+// Console front end: times the hot paths and writes a JSON report
+// ============================================================================
+#include <JuceHeader.h>
+#include "BenchmarkSuite.h"
+#include <iostream>
+
+namespace {
+    const char* const usage =
+        "AudioWorkshopBenchmark [options]\n"
+        "\n"
+        "  --output=FILE         Write the JSON report here rather than to stdout\n"
+        "  --repeats=N           Timed runs per case, after one warm-up (default 3)\n"
+        "  --filter=TEXT         Only cases whose name contains TEXT, e.g. extract/Pitch\n"
+        "  --rates=A,B           Sample rates (default 44100,48000,96000)\n"
+        "  --channels=A,B        Channel counts (default 1,2)\n"
+        "  --durations=A,B       Durations in seconds (default 10,60)\n"
+        "  --quick               One configuration: 48000Hz, stereo, 10s\n"
+        "  --serial              Extract on one core instead of splitting across all of them\n";
+
+    template <typename T>
+    std::vector<T> parseList(const juce::ArgumentList& args, const juce::String& option) {
+        juce::StringArray tokens;
+        tokens.addTokens(args.getValueForOption(option), ",", "");
+        tokens.trim();
+        tokens.removeEmptyStrings();
+
+        std::vector<T> values;
+        for (const auto& token : tokens) {
+            const double value = token.getDoubleValue();
+            if (value <= 0.0)
+                juce::ConsoleApplication::fail(option + " needs positive numbers");
+            values.push_back(static_cast<T>(value));
+        }
+
+        if (values.empty())
+            juce::ConsoleApplication::fail(option + " needs at least one value");
+        return values;
+    }
+
+    void runBenchmarks(const juce::ArgumentList& args) {
+        BenchmarkSuite::Options options;
+        options.parallelExtraction = !args.containsOption("--serial");
+
+        if (args.containsOption("--quick")) {
+            options.sampleRates = { 48000.0 };
+            options.channelCounts = { 2 };
+            options.durations = { 10.0 };
+        }
+
+        if (args.containsOption("--rates")) options.sampleRates = parseList<double>(args, "--rates");
+        if (args.containsOption("--channels")) options.channelCounts = parseList<int>(args, "--channels");
+        if (args.containsOption("--durations")) options.durations = parseList<double>(args, "--durations");
+
+        if (args.containsOption("--repeats")) {
+            options.repeats = args.getValueForOption("--repeats").getIntValue();
+            if (options.repeats < 1)
+                juce::ConsoleApplication::fail("--repeats needs a positive number");
+        }
+
+        if (args.containsOption("--filter"))
+            options.filter = args.getValueForOption("--filter");
+
+        BenchmarkSuite suite(options);
+        const auto results = suite.run();
+
+        if (results.empty())
+            juce::ConsoleApplication::fail("No cases matched " + options.filter);
+
+        const auto report = juce::JSON::toString(BenchmarkSuite::toJson(results, options));
+
+        if (args.containsOption("--output")) {
+            const auto file = juce::File::getCurrentWorkingDirectory()
+                .getChildFile(args.getValueForOption("--output"));
+
+            if (!file.replaceWithText(report + "\n"))
+                juce::ConsoleApplication::fail("Couldn't write " + file.getFullPathName());
+        }
+        else {
+            std::cout << report << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", usage, false);
+    app.addVersionCommand("--version", "AudioWorkshopBenchmark 1.0");
+    app.addDefaultCommand({ "", "[options]", "Time the analysis, lattice, render and file paths",
+        usage, runBenchmarks });
+
+    return app.findAndRunCommand(argc, argv);
+}